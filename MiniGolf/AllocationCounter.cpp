@@ -0,0 +1,76 @@
+#include <new>
+#include <cstdlib>
+#include <atomic>
+
+#include "AllocationCounter.h"
+
+using namespace std;
+
+static atomic<long long> allocations(0);
+static atomic<long long> bytes(0);
+
+static void *counted_malloc(size_t size)
+{
+	allocations.fetch_add(1, memory_order_relaxed);
+	bytes.fetch_add(size, memory_order_relaxed);
+
+	return malloc(size ? size : 1);
+}
+
+long long AllocationCounter::get_allocations()
+{
+	return allocations.load(memory_order_relaxed);
+}
+
+long long AllocationCounter::get_bytes()
+{
+	return bytes.load(memory_order_relaxed);
+}
+
+void *operator new(size_t size)
+{
+	void *p = counted_malloc(size);
+	if (!p) {
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](size_t size)
+{
+	void *p = counted_malloc(size);
+	if (!p) {
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void *operator new(size_t size, const nothrow_t &)
+{
+	return counted_malloc(size);
+}
+
+void *operator new[](size_t size, const nothrow_t &)
+{
+	return counted_malloc(size);
+}
+
+void operator delete(void *p)
+{
+	free(p);
+}
+
+void operator delete[](void *p)
+{
+	free(p);
+}
+
+void operator delete(void *p, const nothrow_t &)
+{
+	free(p);
+}
+
+void operator delete[](void *p, const nothrow_t &)
+{
+	free(p);
+}
\ No newline at end of file
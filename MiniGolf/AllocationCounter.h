@@ -0,0 +1,13 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+// Counts every operator new in the process. The counters are cheap enough to stay on in release builds.
+class AllocationCounter
+{
+public:
+	static long long get_allocations(); // Number of allocations since startup.
+
+	static long long get_bytes(); // Bytes requested since startup.
+};
+
+#endif
\ No newline at end of file
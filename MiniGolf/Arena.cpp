@@ -0,0 +1,135 @@
+#include "Arena.h"
+
+Arena::Arena(size_t block_size)
+{
+	this->block_size = block_size;
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+	if (!blocks.empty()) {
+		Block &block = blocks.back();
+		size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+
+		if (offset + size <= block.size) {
+			block.used = offset + size;
+			return block.memory + offset;
+		}
+	}
+
+	// malloc'd memory is aligned for any fundamental type, so a fresh block starts at offset 0.
+	Block block;
+	block.size = size > block_size ? size : block_size;
+	block.memory = (char *)malloc(block.size);
+	block.used = size;
+
+	if (!block.memory) {
+		throw bad_alloc();
+	}
+
+	blocks.push_back(block);
+
+	return block.memory;
+}
+
+size_t Arena::header_size(size_t alignment)
+{
+	return (sizeof(size_t) + alignment - 1) & ~(alignment - 1);
+}
+
+size_t Arena::reserve_slot(size_t size, size_t alignment)
+{
+	void *object;
+	vector<void*> &reusable = free_memory[make_pair(size, alignment)];
+	if (!reusable.empty()) {
+		object = reusable.back();
+		reusable.pop_back();
+	}
+	else {
+		size_t header = header_size(alignment);
+		char *memory = (char *)allocate(header + size, alignment > __alignof(size_t) ? alignment : __alignof(size_t));
+		object = memory + header;
+	}
+
+	size_t index;
+	if (!free_slots.empty()) {
+		index = free_slots.back();
+		free_slots.pop_back();
+	}
+	else {
+		index = slots.size();
+		slots.push_back(Slot());
+	}
+
+	Slot &slot = slots[index];
+	slot.destroy = NULL;
+	slot.object = object;
+	slot.size = size;
+	slot.alignment = alignment;
+	((size_t *)object)[-1] = index;
+
+	return index;
+}
+
+void Arena::destroy(void *object)
+{
+	if (!object) {
+		return;
+	}
+
+	size_t index = ((size_t *)object)[-1];
+	if (index >= slots.size() || slots[index].object != object) {
+		return; // Already destroyed, or not from this arena.
+	}
+
+	// Free the slot first, so the destructor may create and destroy objects of its own.
+	Slot slot = slots[index];
+	slots[index].object = NULL;
+	slots[index].destroy = NULL;
+	free_slots.push_back(index);
+
+	if (slot.destroy) {
+		slot.destroy(object);
+	}
+	free_memory[make_pair(slot.size, slot.alignment)].push_back(object);
+}
+
+void Arena::release()
+{
+	for (vector<Slot>::size_type i = slots.size(); i-- > 0;) {
+		if (slots[i].object && slots[i].destroy) {
+			slots[i].destroy(slots[i].object);
+		}
+	}
+	slots.clear();
+	free_slots.clear();
+	free_memory.clear();
+
+	for (vector<Block>::size_type i = 0; i < blocks.size(); ++i) {
+		free(blocks[i].memory);
+	}
+	blocks.clear();
+}
+
+size_t Arena::get_bytes_used() const
+{
+	size_t used = 0;
+	for (vector<Block>::size_type i = 0; i < blocks.size(); ++i) {
+		used += blocks[i].used;
+	}
+	return used;
+}
+
+size_t Arena::get_bytes_reserved() const
+{
+	size_t reserved = 0;
+	for (vector<Block>::size_type i = 0; i < blocks.size(); ++i) {
+		reserved += blocks[i].size;
+	}
+	return reserved;
+}
\ No newline at end of file
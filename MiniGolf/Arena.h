@@ -0,0 +1,84 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <map>
+#include <utility>
+#include <type_traits>
+
+using namespace std;
+
+static const size_t ARENA_BLOCK_SIZE = 64 * 1024; // Bytes per block; larger requests get a block of their own.
+
+// Bump allocator that owns everything built in it and frees it all at once. Objects destroyed early leave
+// their memory for the next object of the same size, so a hole rebuilt again and again does not grow.
+class Arena
+{
+public:
+	Arena(size_t block_size = ARENA_BLOCK_SIZE);
+
+	~Arena();
+
+	void *allocate(size_t size, size_t alignment); // Raw bytes, only given back by release().
+
+	template <class T, class... Args>
+	T *create(Args&&... args)
+	{
+		size_t slot = reserve_slot(sizeof(T), __alignof(T));
+		T *object = new (slots[slot].object) T(std::forward<Args>(args)...); // May create children, growing slots.
+
+		if (!is_trivially_destructible<T>::value) {
+			slots[slot].destroy = &destroy_object<T>;
+		}
+
+		return object;
+	}
+
+	// Destroy a single object early, through the destructor of the type it was created as. Does nothing
+	// for NULL or an object that is not alive in this arena.
+	void destroy(void *object);
+
+	void release(); // Run every live destructor, newest slot first, and free all blocks.
+
+	size_t get_bytes_used() const;
+
+	size_t get_bytes_reserved() const;
+
+private:
+	struct Block {
+		char *memory;
+		size_t size;
+		size_t used;
+	};
+
+	// One created object. Its index is stored just before the object, so destroy() finds it directly.
+	struct Slot {
+		void (*destroy)(void *object); // NULL for trivially destructible types.
+		void *object; // NULL once destroyed; the index then waits in free_slots.
+		size_t size, alignment;
+	};
+
+	vector<Block> blocks;
+	vector<Slot> slots;
+	vector<size_t> free_slots;
+	map<pair<size_t, size_t>, vector<void*> > free_memory; // Memory of destroyed objects by size and alignment.
+	size_t block_size;
+
+	Arena(const Arena &);
+	Arena &operator=(const Arena &);
+
+	size_t reserve_slot(size_t size, size_t alignment);
+
+	static size_t header_size(size_t alignment); // Room for the slot index, keeping the object aligned.
+
+	template <class T>
+	static void destroy_object(void *object)
+	{
+		static_cast<T*>(object)->~T();
+	}
+};
+
+#endif
\ No newline at end of file
@@ -1,31 +1,35 @@
 #include "Ball.h"
+#include "FrameStats.h"
 
 Ball::Ball() {}
 
-Ball::Ball(int tile_id, vec3 pos) : Object3D(tile_id, pos)
+Ball::Ball(int tile_id, vec3 pos, Arena *arena) : Object3D(tile_id, pos, arena)
 {
 	radius = 0.05f;
 	slices = 40;
 	stacks = 40;
 
-	material = new Material(vec3(1.0f, 0.2f, 0.5f), vec3(1.0f, 0.2f, 0.5f), vec3(0.0f), 100.0f);
+	material = MaterialTable::add(Material(vec3(1.0f, 0.2f, 0.5f), vec3(1.0f, 0.2f, 0.5f), vec3(0.0f), 100.0f));
 
 	model_to_world = translate(vec3(position.x, position.y + 0.05, position.z));
 
-	this->init_gl();
+	t = NULL;
+	active = false;
+
+	if (!headless) {
+		this->init_gl();
+	}
 }
 
-void Ball::run_simulation()
+void Ball::step(double elapsed_time)
 {
-	double current_time = timer.get_elapsed_time_in_sec();
-	double elapsed_time = current_time - last_time;
-	last_time = current_time;
-
-	while (!forces.empty()) {
-		velocity += forces.front();
-		forces.pop();
+	if (!t) {
+		return; // Not on any tile yet.
 	}
 
+	velocity += force;
+	force = vec3(0.0f);
+
 	if (glm::sqrt(dot(velocity, velocity)) >= t->get_friction() || t->sloped()) {
 		active = true;
 		velocity += t->get_direction_gravity() * .1f;
@@ -48,7 +52,7 @@ void Ball::run_simulation()
 
 bool Ball::collide_with_edge(double time_elapsed)
 {
-	vector<Border*> borders = t->get_borders();
+	const vector<Border*> &borders = t->get_borders();
 
 	if (borders.size() > 0) {
 		bool collision_handled = false;
@@ -76,17 +80,10 @@ bool Ball::is_active() const
 	return active;
 }
 
-void Ball::draw(Camera *camera, Light *light)
+void Ball::draw_geometry() const
 {
-	shader->use();
-
-	glBindVertexArray(vao_handle);
-
-	shader->set_uniforms(camera, light, material, model_to_world);
-
-	glDrawElements(GL_TRIANGLES, elements, GL_UNSIGNED_INT, ((GLubyte *)NULL + (0)));
-
-	glBindVertexArray(0);
+	glDrawElements(GL_TRIANGLES, geometry.index_count, GL_UNSIGNED_INT, geometry.get_index_offset());
+	FrameStats::count_draw_call();
 }
 
 void Ball::init_gl()
@@ -106,46 +103,14 @@ void Ball::init_gl()
 	// Generate the vertex data
 	generate_verts(v, n, tex, el);
 
-	// Create and populate the buffer objects
-	unsigned int handle_ball[4];
-	glGenBuffers(4, handle_ball);
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle_ball[0]);
-	glBufferData(GL_ARRAY_BUFFER, (3 * nVerts) * sizeof(float), v, GL_STATIC_DRAW);
+	tex_coords.assign(tex, tex + 2 * nVerts);
 
-	glBindBuffer(GL_ARRAY_BUFFER, handle_ball[1]);
-	glBufferData(GL_ARRAY_BUFFER, (3 * nVerts) * sizeof(float), n, GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle_ball[2]);
-	glBufferData(GL_ARRAY_BUFFER, (2 * nVerts) * sizeof(float), tex, GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle_ball[3]);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements * sizeof(unsigned int), el, GL_STATIC_DRAW);
+	upload(VertexPool::interleave(v, n, tex, nVerts), vector<GLuint>(el, el + elements));
 
 	delete[] v;
 	delete[] n;
 	delete[] el;
 	delete[] tex;
-
-	// Create the VAO
-	glGenVertexArrays(1, &vao_handle);
-	glBindVertexArray(vao_handle);
-
-	glEnableVertexAttribArray(0);  // Vertex position
-	glBindBuffer(GL_ARRAY_BUFFER, handle_ball[0]);
-	glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	glEnableVertexAttribArray(1);  // Vertex normal
-	glBindBuffer(GL_ARRAY_BUFFER, handle_ball[1]);
-	glVertexAttribPointer((GLuint)1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle_ball[2]);
-	glEnableVertexAttribArray(2);  // Texture coords
-	glVertexAttribPointer((GLuint)2, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle_ball[3]);
-
-	glBindVertexArray(0);
 }
 
 void Ball::generate_verts(float * verts, float * norms, float * tex, unsigned int * el)
@@ -206,6 +171,13 @@ void Ball::generate_verts(float * verts, float * norms, float * tex, unsigned in
 	}
 }
 
+void Ball::get_bounds(vec3 &min, vec3 &max) const
+{
+	vec3 center = vec3(model_to_world[3]);
+	min = center - vec3(radius);
+	max = center + vec3(radius);
+}
+
 float Ball::get_radius() const
 {
 	return radius;
@@ -216,6 +188,15 @@ void Ball::set_radius(float r)
 	radius = r;
 }
 
+void Ball::reset(vec3 pos)
+{
+	position = pos;
+	velocity = vec3(0.0f);
+	force = vec3(0.0f);
+	active = false;
+	model_to_world = translate(vec3(position.x, position.y + 0.05, position.z));
+}
+
 void Ball::set_current_tile(Tile *tile)
 {
 	tile_id = tile->get_tile_id();
@@ -5,7 +5,7 @@
 #include "PhysicsObject.h"
 #include "Tile.h"
 
-#include <glm\glm.hpp>
+#include <glm/glm.hpp>
 
 #define PI 3.141592653589793
 
@@ -16,18 +16,22 @@ class Ball : public Object3D, public PhysicsObject
 public:
 	Ball();
 
-	Ball(int tile_id, vec3 pos);
+	Ball(int tile_id, vec3 pos, Arena *arena);
 
-	virtual void draw(Camera *camera, Light *light);
+	virtual void draw_geometry() const;
+
+	virtual void get_bounds(vec3 &min, vec3 &max) const;
 
 	float get_radius() const;
 
 	void set_radius(float r);
 
-	virtual void run_simulation(); // Run physics simulation;
+	void step(double elapsed_time); // Advance the simulation by a fixed amount of time.
 
 	void set_current_tile(Tile *tile);
 
+	void reset(vec3 pos); // Put the ball at rest at pos, dropping any pending force.
+
 	bool collide_with_edge(double time_elapsed);
 
 	bool is_active() const;
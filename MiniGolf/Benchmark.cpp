@@ -0,0 +1,160 @@
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <dirent.h>
+#include <sys/resource.h>
+#endif
+
+#include "Benchmark.h"
+#include "AllocationCounter.h"
+#include "Timer.h"
+
+static volatile float kept;
+
+BenchmarkState::BenchmarkState(long long iterations)
+{
+	this->iterations = iterations;
+	remaining = iterations;
+	items = -1;
+}
+
+bool BenchmarkState::keep_running()
+{
+	return remaining-- > 0;
+}
+
+long long BenchmarkState::get_iterations() const
+{
+	return iterations;
+}
+
+void BenchmarkState::set_items_processed(long long items)
+{
+	this->items = items;
+}
+
+long long BenchmarkState::get_items_processed() const
+{
+	return items < 0 ? iterations : items;
+}
+
+void Benchmark::print_header(string items)
+{
+	printf("%-52s %14s %12s %16s %14s\n", "Benchmark", "Time", "Iterations", (items + "/s").c_str(), ("Allocs/" + items).c_str());
+	printf("%s\n", string(112, '-').c_str());
+}
+
+// Grow the iteration count until a run lasts BENCHMARK_MIN_TIME, then report that run.
+void Benchmark::run(string name, BenchmarkFunction function, Level *level)
+{
+	long long iterations = 1;
+
+	while (true) {
+		BenchmarkState state(iterations);
+		Timer timer;
+
+		long long allocations = AllocationCounter::get_allocations();
+		timer.start();
+
+		function(state, level);
+
+		double seconds = timer.get_elapsed_time_in_sec();
+		allocations = AllocationCounter::get_allocations() - allocations;
+
+		if (seconds >= BENCHMARK_MIN_TIME || iterations >= BENCHMARK_MAX_ITERATIONS) {
+			double items = (double)state.get_items_processed();
+
+			printf("%-52s %11.1f ns %12lld %16.0f %14.3f\n", name.c_str(),
+				seconds * 1e9 / iterations, iterations, items / seconds, allocations / (items > 0 ? items : 1));
+			return;
+		}
+
+		double multiplier = seconds > 0 ? 1.4 * BENCHMARK_MIN_TIME / seconds : 10.0;
+		if (multiplier > 10.0) {
+			multiplier = 10.0;
+		}
+		else if (multiplier < 2.0) {
+			multiplier = 2.0;
+		}
+		iterations = (long long)(iterations * multiplier);
+	}
+}
+
+vector<string> Benchmark::list_courses(string directory)
+{
+	vector<string> courses;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((directory + "/*.db").c_str(), &data);
+	if (find != INVALID_HANDLE_VALUE) {
+		do {
+			courses.push_back(directory + "/" + data.cFileName);
+		} while (FindNextFileA(find, &data));
+		FindClose(find);
+	}
+#else
+	DIR *dir = opendir(directory.c_str());
+	if (dir) {
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != NULL) {
+			string file = entry->d_name;
+			if (file.size() > 3 && file.compare(file.size() - 3, 3, ".db") == 0) {
+				courses.push_back(directory + "/" + file);
+			}
+		}
+		closedir(dir);
+	}
+#endif
+
+	sort(courses.begin(), courses.end());
+
+	return courses;
+}
+
+size_t Benchmark::get_peak_memory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		return (size_t)usage.ru_maxrss * 1024; // Reported in kilobytes on Linux.
+	}
+	return 0;
+#endif
+}
+
+string Benchmark::get_temp_directory()
+{
+#ifdef _WIN32
+	char path[MAX_PATH + 1];
+	DWORD length = GetTempPathA(sizeof(path), path);
+	if (length > 0 && length < sizeof(path)) {
+		return path;
+	}
+	return ".\\";
+#else
+	const char *path = getenv("TMPDIR");
+	string directory = path && *path ? path : "/tmp";
+	if (directory[directory.size() - 1] != '/') {
+		directory += "/";
+	}
+	return directory;
+#endif
+}
+
+void Benchmark::keep(float value)
+{
+	kept = value;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+#include "Level.h"
+
+using namespace std;
+
+static const double BENCHMARK_MIN_TIME = 0.5; // Seconds each case must run before it is reported.
+static const long long BENCHMARK_MAX_ITERATIONS = 1000000000;
+
+// Passed to every benchmark case, in the style of Google Benchmark: loop while keep_running().
+class BenchmarkState
+{
+public:
+	BenchmarkState(long long iterations);
+
+	bool keep_running();
+
+	long long get_iterations() const;
+
+	void set_items_processed(long long items); // Defaults to one item per iteration.
+
+	long long get_items_processed() const;
+
+private:
+	long long iterations;
+	long long remaining;
+	long long items;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState &state, Level *level);
+
+class Benchmark
+{
+public:
+	static void print_header(string items);
+
+	static void run(string name, BenchmarkFunction function, Level *level);
+
+	static vector<string> list_courses(string directory); // Every *.db file in directory.
+
+	static size_t get_peak_memory(); // Peak resident set of the process, in bytes.
+
+	static string get_temp_directory(); // Where generated files go, ending in a separator.
+
+	static void keep(float value); // Stops the compiler dropping the computation that made value.
+};
+
+#endif
\ No newline at end of file
@@ -1,8 +1,9 @@
 #include "Border.h"
+#include "FrameStats.h"
 
-Border::Border(int id, vector<vec3> e) : Plane(id, e[0])
+Border::Border(int id, vector<vec3> e, Arena *arena) : Plane(id, e[0], arena)
 {
-	material = new Material(vec3(1.0f, 0.1f, 0.1f), vec3(0.9f, 0.1f, 0.1f), vec3(0.0f), 100.0f);
+	material = MaterialTable::add(Material(vec3(1.0f, 0.1f, 0.1f), vec3(0.9f, 0.1f, 0.1f), vec3(0.0f), 100.0f));
 
 	vector<vec3> new_edges;
 	for (vector<vec3>::size_type i = 0; i < e.size(); i += 2) {
@@ -19,43 +20,24 @@ Border::Border(int id, vector<vec3> e) : Plane(id, e[0])
 
 	normal = calculate_normal();
 
-	dist_from_origin = -dot(normal, vertices[0]);
-
-	init_gl();
-}
-
-void Border::draw(Camera *camera, Light *light)
-{
-	shader->use();
-
-	glBindVertexArray(vao_handle);
-
-	shader->set_uniforms(camera, light, material, mat4(1.0f));
+	calc_min_max();
 
-	glDrawArrays(GL_QUADS, 0, vertices.size());
+	dist_from_origin = -dot(normal, vertices[0]);
 
-	glBindVertexArray(0);
+	if (!headless) {
+		// Each quad faces its own way around the tile, so each gets its own normal; a zero length edge keeps the first's.
+		vector<vec3> vertex_normals;
+		for (vector<vec3>::size_type i = 0; i < vertices.size(); i += 4) {
+			vec3 n = cross(vertices[i + 1] - vertices[i], vertices[i + 2] - vertices[i]);
+			n = dot(n, n) > 0.0f ? normalize(n) : normal;
+			vertex_normals.insert(vertex_normals.end(), 4, n);
+		}
+		init_gl(vertex_normals);
+	}
 }
 
-void Border::init_gl()
+void Border::draw_geometry() const
 {
-	vector<float> edge_indices;
-	for (vector<vec3>::size_type i = 0; i < vertices.size(); ++i) {
-		edge_indices.push_back(vertices[i].x);
-		edge_indices.push_back(vertices[i].y);
-		edge_indices.push_back(vertices[i].z);
-	}
-
-	glGenVertexArrays(1, &vao_handle);
-	glBindVertexArray(vao_handle);
-
-	unsigned int handle[1];
-	glGenBuffers(1, handle);
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle[0]);
-	glBufferData(GL_ARRAY_BUFFER, edge_indices.size() * sizeof(float), &edge_indices[0], GL_STATIC_DRAW);
-	glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
-	glEnableVertexAttribArray(0);
-
-	glBindVertexArray(0);
+	glDrawArrays(GL_QUADS, geometry.first_vertex, geometry.vertex_count);
+	FrameStats::count_draw_call();
 }
\ No newline at end of file
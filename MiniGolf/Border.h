@@ -7,12 +7,9 @@
 class Border : public Plane
 {
 public:
-	Border(int id, vector<vec3> e);
+	Border(int id, vector<vec3> e, Arena *arena);
 
-	virtual void draw(Camera *camera, Light *light);
-
-private:
-	void init_gl();
+	virtual void draw_geometry() const;
 };
 
 #endif
\ No newline at end of file
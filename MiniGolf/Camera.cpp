@@ -27,4 +27,11 @@ mat4 Camera::get_projection() const
 void Camera::change_view(mat4 transform)
 {
 	view *= transform;
+}
+
+void Camera::look_at(vec3 eye, vec3 center)
+{
+	this->eye = eye;
+	this->center = center;
+	view = lookAt(eye, center, up);
 }
\ No newline at end of file
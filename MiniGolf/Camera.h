@@ -2,14 +2,14 @@
 #define CAMERA_H
 
 #include <vector>
-#include <glm\glm.hpp>
+#include <glm/glm.hpp>
 #include <iostream>
 
 #define GLM_FORCE_RADIANS
 
-#include <glm\gtx\transform.hpp>
-#include <gl/freeglut.h>
-#include <gl/GLU.h>
+#include <glm/gtx/transform.hpp>
+#include <GL/freeglut.h>
+#include <GL/glu.h>
 #include <math.h>
 
 using namespace std;
@@ -28,6 +28,8 @@ public:
 
 	void change_view(mat4 transform); //transform the view.
 
+	void look_at(vec3 eye, vec3 center); // Replaces the view, keeping the up direction.
+
 private:
 	mat4 view;
 	mat4 projection;
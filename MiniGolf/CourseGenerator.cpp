@@ -0,0 +1,141 @@
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+
+#include "CourseGenerator.h"
+
+CourseGenerator::CourseGenerator(int holes, int tiles_per_hole, float slope_fraction, float max_rise, unsigned int seed)
+{
+	this->holes = holes;
+	this->tiles_per_hole = tiles_per_hole;
+	this->slope_fraction = slope_fraction;
+	this->max_rise = max_rise;
+	this->seed = seed;
+}
+
+float CourseGenerator::random()
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (seed >> 8) / 16777216.0f;
+}
+
+void CourseGenerator::write(ostream &out)
+{
+	out << "course \"Generated-" << tiles_per_hole << "\" " << holes << "\n";
+
+	for (int i = 0; i < holes; ++i) {
+		write_hole(out, i);
+	}
+}
+
+string CourseGenerator::to_string()
+{
+	ostringstream out;
+	write(out);
+	return out.str();
+}
+
+bool CourseGenerator::write_file(string fname)
+{
+	ofstream out_file(fname);
+	if (!out_file.is_open()) {
+		cout << "error - unable to open " << fname << " for writing." << endl;
+		return false;
+	}
+
+	write(out_file);
+
+	return out_file.good();
+}
+
+// Tiles are numbered row by row from 1. Edges run north, east, south, west, matching the hand-made courses.
+void CourseGenerator::write_hole(ostream &out, int hole)
+{
+	int columns = (int)ceil(sqrt((double)tiles_per_hole));
+	int rows = (tiles_per_hole + columns - 1) / columns;
+	int count = tiles_per_hole;
+
+	float width = columns * GENERATED_TILE_SIZE;
+	float depth = rows * GENERATED_TILE_SIZE;
+
+	// Height of every row boundary, so neighboring tiles always share their edges exactly.
+	vector<float> heights(rows + 1, 0.0f);
+	for (int r = rows - 1; r >= 0; --r) {
+		heights[r] = heights[r + 1];
+		if (random() < slope_fraction) {
+			heights[r] += (2.0f * random() - 1.0f) * max_rise;
+		}
+	}
+
+	out << "begin_hole\n";
+	out << "par 3\n";
+	out << "name \"Generated " << hole + 1 << "\"\n";
+
+	for (int r = 0; r < rows; ++r) {
+		for (int c = 0; c < columns; ++c) {
+			int id = r * columns + c + 1;
+			if (id > count) {
+				break;
+			}
+
+			float x0 = c * GENERATED_TILE_SIZE - width / 2;
+			float x1 = x0 + GENERATED_TILE_SIZE;
+			float z1 = depth / 2 - r * GENERATED_TILE_SIZE;
+			float z0 = z1 - GENERATED_TILE_SIZE;
+
+			int north = r > 0 ? id - columns : 0;
+			int east = (c < columns - 1 && id + 1 <= count) ? id + 1 : 0;
+			int south = id + columns <= count ? id + columns : 0;
+			int west = c > 0 ? id - 1 : 0;
+
+			out << "tile " << id << " 4 "
+				<< x0 << " " << heights[r] << " " << z1 << " "
+				<< x1 << " " << heights[r] << " " << z1 << " "
+				<< x1 << " " << heights[r + 1] << " " << z0 << " "
+				<< x0 << " " << heights[r + 1] << " " << z0 << " "
+				<< north << " " << east << " " << south << " " << west << "\n";
+		}
+	}
+
+	// Tee in the middle of the last full row, cup in the middle of the first.
+	int tee_row = rows > 1 ? rows - 2 : 0;
+	int tee_tile = tee_row * columns + columns / 2 + 1;
+	int cup_tile = columns / 2 + 1;
+
+	float x = (columns / 2 + 0.5f) * GENERATED_TILE_SIZE - width / 2;
+	float tee_z = depth / 2 - (tee_row + 0.5f) * GENERATED_TILE_SIZE;
+	float cup_z = depth / 2 - 0.5f * GENERATED_TILE_SIZE;
+
+	out << "tee " << tee_tile << " " << x << " " << (heights[tee_row] + heights[tee_row + 1]) / 2 << " " << tee_z << "\n";
+	out << "cup " << cup_tile << " " << x << " " << (heights[0] + heights[1]) / 2 << " " << cup_z << "\n";
+	out << "end_hole\n";
+}
+
+int run_course_generator(int argc, char **argv)
+{
+	if (argc < 1) {
+		cout << "usage: MiniGolf --generate out.db [holes] [tiles per hole] [slope fraction] [max rise] [seed]" << endl;
+		return 1;
+	}
+
+	int holes = argc > 1 ? atoi(argv[1]) : 18;
+	int tiles = argc > 2 ? atoi(argv[2]) : 1000;
+	float slope_fraction = argc > 3 ? (float)atof(argv[3]) : 0.2f;
+	float max_rise = argc > 4 ? (float)atof(argv[4]) : 0.1f;
+	unsigned int seed = argc > 5 ? (unsigned int)atoi(argv[5]) : 1;
+
+	if (holes < 1 || tiles < 1) {
+		cout << "error - a course needs at least one hole of one tile." << endl;
+		return 1;
+	}
+
+	CourseGenerator generator(holes, tiles, slope_fraction, max_rise, seed);
+	if (!generator.write_file(argv[0])) {
+		return 1;
+	}
+
+	cout << "Wrote " << argv[0] << ": " << holes << " holes of " << tiles << " tiles." << endl;
+
+	return 0;
+}
\ No newline at end of file
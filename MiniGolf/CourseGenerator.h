@@ -0,0 +1,40 @@
+#ifndef COURSE_GENERATOR_H
+#define COURSE_GENERATOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const float GENERATED_TILE_SIZE = 0.25f;
+
+// Writes valid course files made of square tiles laid out on a grid, with consistent neighbor IDs.
+// Slopes run north-south: each row of tiles either stays level or rises by up to max_rise.
+class CourseGenerator
+{
+public:
+	CourseGenerator(int holes, int tiles_per_hole, float slope_fraction = 0.0f, float max_rise = 0.0f, unsigned int seed = 1);
+
+	void write(ostream &out);
+
+	string to_string();
+
+	bool write_file(string fname);
+
+private:
+	int holes;
+	int tiles_per_hole;
+	float slope_fraction; // Chance that a row of tiles is sloped.
+	float max_rise; // Largest height change across one sloped row.
+	unsigned int seed;
+
+	float random(); // Uniform in [0, 1), reproducible from the seed on every platform.
+
+	void write_hole(ostream &out, int hole);
+};
+
+// MiniGolf --generate out.db [holes] [tiles per hole] [slope fraction] [max rise] [seed]
+int run_course_generator(int argc, char **argv);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "CourseWatcher.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+bool FileStamp::operator==(const FileStamp &other) const
+{
+	return modified == other.modified && size == other.size;
+}
+
+bool FileStamp::operator!=(const FileStamp &other) const
+{
+	return !(*this == other);
+}
+
+CourseWatcher::CourseWatcher(string fname)
+{
+	file_name = fname;
+	accepted = seen = get_stamp();
+
+	timer.start();
+	last_poll = timer.get_elapsed_time_in_sec();
+}
+
+// Polled between frames, so only stat the file every COURSE_POLL_PERIOD seconds.
+bool CourseWatcher::changed()
+{
+	double now = timer.get_elapsed_time_in_sec();
+	if (now - last_poll < COURSE_POLL_PERIOD) {
+		return false;
+	}
+	last_poll = now;
+
+	seen = get_stamp();
+	if (seen.modified == 0 || seen == accepted) {
+		return false; // Missing (mid-save) or untouched.
+	}
+
+	return true;
+}
+
+void CourseWatcher::accept()
+{
+	accepted = seen;
+}
+
+string CourseWatcher::get_file_name() const
+{
+	return file_name;
+}
+
+FileStamp CourseWatcher::get_stamp() const
+{
+	FileStamp stamp;
+	stamp.modified = 0;
+	stamp.size = 0;
+
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(file_name.c_str(), GetFileExInfoStandard, &data)) {
+		return stamp;
+	}
+	stamp.modified = ((long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime; // 100 ns ticks.
+	stamp.size = ((long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+#else
+	struct stat info;
+	if (stat(file_name.c_str(), &info) != 0) {
+		return stamp;
+	}
+#ifdef __APPLE__
+	stamp.modified = (long long)info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+	stamp.modified = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+	stamp.size = (long long)info.st_size;
+#endif
+
+	return stamp;
+}
\ No newline at end of file
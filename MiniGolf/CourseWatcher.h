@@ -0,0 +1,47 @@
+#ifndef COURSE_WATCHER_H
+#define COURSE_WATCHER_H
+
+#include <string>
+
+#include "Timer.h"
+
+using namespace std;
+
+static const double COURSE_POLL_PERIOD = 0.5; // Seconds between checks of the course file.
+
+// What the watcher compares between polls. Modification times are as fine as the file system keeps them,
+// and the size catches rewrites that land within one tick of the clock.
+struct FileStamp {
+	long long modified; // 0 if the file is missing.
+	long long size;
+
+	bool operator==(const FileStamp &other) const;
+
+	bool operator!=(const FileStamp &other) const;
+};
+
+class CourseWatcher
+{
+public:
+	CourseWatcher(string fname);
+
+	// True while the file differs from the version last accepted. Call accept() once that version has
+	// loaded; until then every poll reports it again, so a file rejected mid-save is retried.
+	bool changed();
+
+	void accept(); // The version changed() last saw has been loaded.
+
+	string get_file_name() const;
+
+private:
+	string file_name;
+	FileStamp accepted;
+	FileStamp seen; // As of the last poll.
+
+	Timer timer;
+	double last_poll;
+
+	FileStamp get_stamp() const;
+};
+
+#endif
\ No newline at end of file
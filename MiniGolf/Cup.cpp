@@ -1,22 +1,29 @@
 #include "Cup.h"
+#include "FrameStats.h"
 
 Cup::Cup() {}
 
-Cup::Cup(int tile_id, vec3 position) : Object3D(tile_id, position)
+Cup::Cup(int tile_id, vec3 position, Arena *arena) : Object3D(tile_id, position, arena)
 {
 	model_to_world = translate(vec3(position.x, position.y - 0.09, position.z)) * scale(vec3(0.2f));
 
-	material = new Material(vec3(0.1f, 0.1f, 0.1f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f), 100.0f);
+	material = MaterialTable::add(Material(vec3(0.1f, 0.1f, 0.1f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f), 100.0f));
 
-	isect_sphere = new Ball(tile_id, position);
+	isect_sphere = arena->create<Ball>(tile_id, position, arena);
 	isect_sphere->set_radius(0.1f);
 
-	this->init_gl();
+	if (!headless) {
+		this->init_gl();
+	}
 }
 
-Cup::~Cup()
+// The unit cube of init_gl, through the model transform.
+void Cup::get_bounds(vec3 &min, vec3 &max) const
 {
-	delete isect_sphere;
+	vec3 center = vec3(model_to_world[3]);
+	vec3 half = abs(vec3(model_to_world * vec4(0.5f, 0.5f, 0.5f, 0.0f)));
+	min = center - half;
+	max = center + half;
 }
 
 Ball *Cup::get_sphere() const
@@ -137,42 +144,13 @@ void Cup::init_gl()
 		20, 21, 22, 20, 22, 23
 	};
 
-	glGenVertexArrays(1, &vao_handle);
-	glBindVertexArray(vao_handle);
+	tex_coords.assign(tex, tex + 24 * 2);
 
-	unsigned int handle_cup[4];
-	glGenBuffers(4, handle_cup);
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle_cup[0]);
-	glBufferData(GL_ARRAY_BUFFER, 24 * 3 * sizeof(float), v, GL_STATIC_DRAW);
-	glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
-	glEnableVertexAttribArray(0);  // Vertex position
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle_cup[1]);
-	glBufferData(GL_ARRAY_BUFFER, 24 * 3 * sizeof(float), n, GL_STATIC_DRAW);
-	glVertexAttribPointer((GLuint)1, 3, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
-	glEnableVertexAttribArray(1);  // Vertex normal
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle_cup[2]);
-	glBufferData(GL_ARRAY_BUFFER, 24 * 2 * sizeof(float), tex, GL_STATIC_DRAW);
-	glVertexAttribPointer((GLuint)2, 2, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
-	glEnableVertexAttribArray(2);  // texture coords
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle_cup[3]);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 36 * sizeof(GLuint), el, GL_STATIC_DRAW);
-
-	glBindVertexArray(0);
+	upload(VertexPool::interleave(v, n, tex, 24), vector<GLuint>(el, el + 36));
 }
 
-void Cup::draw(Camera *camera, Light *light)
+void Cup::draw_geometry() const
 {
-	shader->use();
-
-	glBindVertexArray(vao_handle);
-
-	shader->set_uniforms(camera, light, material, model_to_world);
-
-	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, ((GLubyte *)NULL + (0)));
-
-	glBindVertexArray(0);
+	glDrawElements(GL_TRIANGLES, geometry.index_count, GL_UNSIGNED_INT, geometry.get_index_offset());
+	FrameStats::count_draw_call();
 }
\ No newline at end of file
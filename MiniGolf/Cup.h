@@ -9,11 +9,11 @@ class Cup : public Object3D
 public:
 	Cup();
 
-	~Cup();
+	Cup(int tile_id, vec3 position, Arena *arena);
 
-	Cup(int tile_id, vec3 position);
+	virtual void draw_geometry() const;
 
-	virtual void draw(Camera *camera, Light *light);
+	virtual void get_bounds(vec3 &min, vec3 &max) const;
 
 	Ball *get_sphere() const;
 
@@ -0,0 +1,80 @@
+#include "FrameStats.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+
+int FrameStats::draw_calls = 0;
+int FrameStats::state_changes = 0;
+int FrameStats::physics_steps = 0;
+int FrameStats::last_draw_calls = 0;
+int FrameStats::last_state_changes = 0;
+int FrameStats::last_physics_steps = 0;
+long long FrameStats::last_allocations = 0;
+long long FrameStats::allocations_at_frame_start = 0;
+long long FrameStats::frame_start = 0;
+double FrameStats::frame_times[FRAME_HISTORY] = { 0 };
+int FrameStats::frame_index = 0;
+
+void FrameStats::count_draw_call()
+{
+	draw_calls++;
+}
+
+void FrameStats::count_state_changes(int n)
+{
+	state_changes += n;
+}
+
+void FrameStats::count_physics_step()
+{
+	physics_steps++;
+}
+
+void FrameStats::end_frame()
+{
+	long long now = Profiler::now();
+	long long allocations = AllocationCounter::get_allocations();
+
+	if (frame_start) {
+		frame_times[frame_index] = (now - frame_start) / 1e6;
+		frame_index = (frame_index + 1) % FRAME_HISTORY;
+	}
+	frame_start = now;
+
+	last_draw_calls = draw_calls;
+	last_state_changes = state_changes;
+	last_physics_steps = physics_steps;
+	last_allocations = allocations - allocations_at_frame_start;
+	allocations_at_frame_start = allocations;
+
+	draw_calls = state_changes = physics_steps = 0;
+}
+
+double FrameStats::get_frame_time()
+{
+	return get_frame_time(0);
+}
+
+double FrameStats::get_frame_time(int frames_ago)
+{
+	return frame_times[(frame_index - 1 - frames_ago + 2 * FRAME_HISTORY) % FRAME_HISTORY];
+}
+
+int FrameStats::get_draw_calls()
+{
+	return last_draw_calls;
+}
+
+int FrameStats::get_state_changes()
+{
+	return last_state_changes;
+}
+
+int FrameStats::get_physics_steps()
+{
+	return last_physics_steps;
+}
+
+long long FrameStats::get_allocations()
+{
+	return last_allocations;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+static const int FRAME_HISTORY = 120; // Frames kept for the HUD histogram.
+
+// Per-frame counters fed by the renderer and the game loop. GL thread only.
+class FrameStats
+{
+public:
+	static void count_draw_call();
+
+	static void count_state_changes(int n);
+
+	static void count_physics_step();
+
+	static void end_frame(); // Closes the current frame; call once per frame after the swap.
+
+	static double get_frame_time(); // Milliseconds, last finished frame.
+
+	static double get_frame_time(int frames_ago); // 0 is the last finished frame.
+
+	static int get_draw_calls();
+
+	static int get_state_changes();
+
+	static int get_physics_steps();
+
+	static long long get_allocations();
+
+private:
+	static int draw_calls, state_changes, physics_steps; // Current frame.
+	static int last_draw_calls, last_state_changes, last_physics_steps;
+	static long long last_allocations;
+	static long long allocations_at_frame_start;
+
+	static long long frame_start;
+	static double frame_times[FRAME_HISTORY];
+	static int frame_index; // Slot the next finished frame goes into.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "Frustum.h"
+
+// Gribb and Hartmann: each plane is the last row of the combined matrix plus or minus one of the others.
+Frustum::Frustum(const Camera *camera, float max_distance)
+{
+	mat4 view = camera->get_view();
+	mat4 m = camera->get_projection() * view;
+
+	vec4 rows[4];
+	for (int i = 0; i < 4; ++i) {
+		rows[i] = vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+	}
+
+	for (int i = 0; i < 3; ++i) {
+		planes[i * 2] = rows[3] + rows[i];
+		planes[i * 2 + 1] = rows[3] - rows[i];
+	}
+
+	eye = vec3(inverse(view)[3]);
+	this->max_distance = max_distance;
+}
+
+bool Frustum::contains(vec3 min, vec3 max) const
+{
+	// The corner furthest along a plane's normal is outside only when the whole box is.
+	for (int i = 0; i < 6; ++i) {
+		vec3 n = vec3(planes[i]);
+		vec3 corner(n.x >= 0.0f ? max.x : min.x, n.y >= 0.0f ? max.y : min.y, n.z >= 0.0f ? max.z : min.z);
+		if (dot(n, corner) + planes[i].w < 0.0f) {
+			return false;
+		}
+	}
+
+	if (max_distance > 0.0f) {
+		vec3 nearest = clamp(eye, min, max);
+		if (dot(nearest - eye, nearest - eye) > max_distance * max_distance) {
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
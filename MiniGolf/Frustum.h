@@ -0,0 +1,26 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+
+using namespace glm;
+
+// The volume a camera sees, as six inward facing planes pulled from its view and projection matrices,
+// optionally cut short at a distance from the eye.
+class Frustum
+{
+public:
+	Frustum(const Camera *camera, float max_distance = 0.0f); // 0 keeps everything up to the far plane.
+
+	// Conservative: a box that only grazes a corner may be kept, but nothing on screen is ever dropped.
+	bool contains(vec3 min, vec3 max) const;
+
+private:
+	vec4 planes[6]; // xyz is the normal, w the offset; inside is dot(normal, p) + w >= 0.
+	vec3 eye;
+	float max_distance;
+};
+
+#endif
\ No newline at end of file
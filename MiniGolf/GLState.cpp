@@ -0,0 +1,80 @@
+#include "GLState.h"
+#include "FrameStats.h"
+
+void GLState::use_program(GLuint program)
+{
+	glUseProgram(program);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::bind_vertex_array(GLuint vao)
+{
+	glBindVertexArray(vao);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::bind_buffer_base(GLenum target, GLuint index, GLuint buffer)
+{
+	glBindBufferBase(target, index, buffer);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::enable(GLenum cap)
+{
+	glEnable(cap);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::disable(GLenum cap)
+{
+	glDisable(cap);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::cull_face(GLenum mode)
+{
+	glCullFace(mode);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::uniform(GLint location, int v)
+{
+	glUniform1i(location, v);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::uniform(GLint location, float v)
+{
+	glUniform1f(location, v);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::uniform(GLint location, float x, float y)
+{
+	glUniform2f(location, x, y);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::uniform(GLint location, float x, float y, float z)
+{
+	glUniform3f(location, x, y, z);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::uniform(GLint location, float x, float y, float z, float w)
+{
+	glUniform4f(location, x, y, z, w);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::uniform_matrix3(GLint location, const GLfloat *m)
+{
+	glUniformMatrix3fv(location, 1, GL_FALSE, m);
+	FrameStats::count_state_changes(1);
+}
+
+void GLState::uniform_matrix4(GLint location, const GLfloat *m)
+{
+	glUniformMatrix4fv(location, 1, GL_FALSE, m);
+	FrameStats::count_state_changes(1);
+}
\ No newline at end of file
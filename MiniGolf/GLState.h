@@ -0,0 +1,38 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <GL/glew.h>
+
+// Thin wrappers over the GL calls that change pipeline state. Each one makes the call and counts it in
+// FrameStats, so the state change counter is exactly the number of those calls issued. GL thread only.
+class GLState
+{
+public:
+	static void use_program(GLuint program);
+
+	static void bind_vertex_array(GLuint vao);
+
+	static void bind_buffer_base(GLenum target, GLuint index, GLuint buffer);
+
+	static void enable(GLenum cap);
+
+	static void disable(GLenum cap);
+
+	static void cull_face(GLenum mode);
+
+	static void uniform(GLint location, int v);
+
+	static void uniform(GLint location, float v);
+
+	static void uniform(GLint location, float x, float y);
+
+	static void uniform(GLint location, float x, float y, float z);
+
+	static void uniform(GLint location, float x, float y, float z, float w);
+
+	static void uniform_matrix3(GLint location, const GLfloat *m);
+
+	static void uniform_matrix4(GLint location, const GLfloat *m);
+};
+
+#endif
\ No newline at end of file
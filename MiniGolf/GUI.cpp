@@ -1,20 +1,58 @@
 #include "GUI.h"
+#include "Profiler.h"
+#include "GLState.h"
+#include <cmath>
 
 GUI::GUI(string path){
+	show_stats = false;
+	streamer = new TextureStreamer();
 	loadTexture(path);
-}
 
-// Routine to draw a stroke character string.
-void writeStrokeString(void *font, const char *string)
-{
-	const char *c;
-	for (c = string; *c != '\0'; c++) glutStrokeCharacter(font, *c);
+	text = new TextRenderer();
+	course_label = text->create_label(20.0f, 950.0f, 0.2f);
+	level_label = text->create_label(20.0f, 900.0f, 0.2f);
+	par_label = text->create_label(20.0f, 850.0f, 0.2f);
+	power_label = text->create_label(1200.0f, 50.0f, 0.2f);
+	angle_label = text->create_label(1200.0f, 80.0f, 0.2f);
+
+	for (int i = 0; i < 5; ++i) {
+		stats_labels[i] = text->create_label(20.0f, 300.0f - i * 30.0f, 0.12f);
+		last_stats[i] = NAN;
+	}
+	last_angle = last_power = NAN; // Never equal, so the first frame sets them.
 }
 
-void GUI::draw(string course, string level, string par, string angle, string power){
-	glUseProgram(0);
+// Values are compared before any label string is built: the overlay's allocation figure would otherwise
+// count the HUD's own strings every frame.
+void GUI::draw(const string &course, const string &level, const string &par, float angle, float power){
+	PROFILE_GPU_ZONE("GUI::draw");
+
+	streamer->update();
+
+	if (course != last_course) {
+		last_course = course;
+		text->set_text(course_label, "Course: " + course);
+	}
+	if (level != last_level) {
+		last_level = level;
+		text->set_text(level_label, "Level: " + level);
+	}
+	if (par != last_par) {
+		last_par = par;
+		text->set_text(par_label, "Par: " + par);
+	}
+	if (power != last_power) {
+		last_power = power;
+		text->set_text(power_label, "Power: " + to_string(power));
+	}
+	if (angle != last_angle) {
+		last_angle = angle;
+		text->set_text(angle_label, "Angle: " + to_string(angle));
+	}
 
-	glEnable(GL_BLEND);
+	GLState::use_program(0);
+
+	GLState::enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	glMatrixMode(GL_PROJECTION);
@@ -26,71 +64,92 @@ void GUI::draw(string course, string level, string par, string angle, string pow
 	glPushMatrix();
 	glLoadIdentity();
 
-	glDisable(GL_LIGHTING);
+	GLState::disable(GL_LIGHTING);
 
 	glColor4f(1, 1, 1, 1);
 
-	glPushMatrix();
-	glTranslatef(20.0, 950.0, 0.0);
-	glScalef(0.2, 0.2, 1.0);
-	string course_name = "Course: " + course;
-	writeStrokeString(GLUT_STROKE_MONO_ROMAN, course_name.c_str());
-	glPopMatrix();
+	if (show_stats) {
+		draw_stats();
+	}
 
-	glPushMatrix();
-	glTranslatef(20.0, 900.0, 0.0);
-	glScalef(0.2, 0.2, 1.0);
-	string level_name = "Level: " + level;
-	writeStrokeString(GLUT_STROKE_MONO_ROMAN, level_name.c_str());
-	glPopMatrix();
+	text->draw();
 
-	glPushMatrix();
-	glTranslatef(20.0, 850.0, 0.0);
-	glScalef(0.2, 0.2, 1.0);
-	string p = "Par: " + par;
-	writeStrokeString(GLUT_STROKE_MONO_ROMAN, p.c_str());
+	GLState::disable(GL_BLEND);
 	glPopMatrix();
-
-	glPushMatrix();
-	glTranslatef(1200.0, 50.0, 0.0);
-	glScalef(0.2, 0.2, 1.0);
-	string pr = "Power: " + power;
-	writeStrokeString(GLUT_STROKE_MONO_ROMAN, pr.c_str());
+	glMatrixMode(GL_PROJECTION);
 	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+}
 
-	glPushMatrix();
-	glTranslatef(1200.0, 80.0, 0.0);
-	glScalef(0.2, 0.2, 1.0);
-	string a = "Angle: " + angle;
-	writeStrokeString(GLUT_STROKE_MONO_ROMAN, a.c_str());
-	glPopMatrix();
+void GUI::toggle_stats(){
+	show_stats = !show_stats;
 
-	/*glTranslatef(20.0f, 20.0f, 0.0f);
+	if (!show_stats) {
+		for (int i = 0; i < 5; ++i) {
+			text->set_text(stats_labels[i], "");
+			last_stats[i] = NAN;
+		}
+	}
+}
+
+// Performance overlay: counter labels for the last frame and a bar per recent frame, 1 pixel per 0.2 ms.
+// A changed counter is formatted on the stack; the label reuses its string, so the overlay adds nothing
+// to the allocation count it shows.
+void GUI::draw_stats(){
+	static const char *formats[5] = { "Frame: %.2f ms", "Physics steps: %.0f", "Draw calls: %.0f", "State changes: %.0f", "Allocations: %.0f" };
+	double values[5] = {
+		FrameStats::get_frame_time(),
+		(double)FrameStats::get_physics_steps(),
+		(double)FrameStats::get_draw_calls(),
+		(double)FrameStats::get_state_changes(),
+		(double)FrameStats::get_allocations()
+	};
+	char line[128];
+
+	for (int i = 0; i < 5; ++i) {
+		if (values[i] != last_stats[i]) {
+			last_stats[i] = values[i];
+			sprintf(line, formats[i], values[i]);
+			text->set_text(stats_labels[i], line);
+		}
+	}
 
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	float x = 20.0f, y = 40.0f, bar = 3.0f;
 
 	glBegin(GL_QUADS);
-	glTexCoord2f(0, 0); glVertex3f(0, 0, 0);
-	glTexCoord2f(0, 1); glVertex3f(0, 100, 0);
-	glTexCoord2f(1, 1); glVertex3f(100, 100, 0);
-	glTexCoord2f(1, 0); glVertex3f(100, 0, 0);
+	for (int i = FRAME_HISTORY - 1; i >= 0; --i) {
+		float ms = (float)FrameStats::get_frame_time(i);
+		float h = ms * 5.0f;
+
+		if (ms > 33.4f) {
+			glColor4f(1.0f, 0.2f, 0.2f, 0.8f);
+		}
+		else if (ms > 16.7f) {
+			glColor4f(1.0f, 0.8f, 0.2f, 0.8f);
+		}
+		else {
+			glColor4f(0.2f, 1.0f, 0.2f, 0.8f);
+		}
+
+		glVertex2f(x, y);
+		glVertex2f(x + bar - 1.0f, y);
+		glVertex2f(x + bar - 1.0f, y + h);
+		glVertex2f(x, y + h);
+		x += bar;
+	}
 	glEnd();
 
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_BLEND);
-	glPopMatrix();
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
-	glMatrixMode(GL_MODELVIEW);*/
+	// 60 FPS budget line.
+	glColor4f(1.0f, 1.0f, 1.0f, 0.6f);
+	glBegin(GL_LINES);
+	glVertex2f(20.0f, y + 16.7f * 5.0f);
+	glVertex2f(20.0f + FRAME_HISTORY * bar, y + 16.7f * 5.0f);
+	glEnd();
+
+	glColor4f(1, 1, 1, 1);
 }
 
+// Streams in the background; the texture is a transparent placeholder until draw() has uploaded it.
 void GUI::loadTexture(string path){
-	texture = SOIL_load_OGL_texture(path.c_str(), SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, SOIL_FLAG_MULTIPLY_ALPHA | SOIL_FLAG_MIPMAPS | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT);
-	if (!texture){
-		cout << "Invalid path " << path << endl;
-	}
-	else{
-		cout << path << " loaded" << endl;
-	}
+	texture = streamer->request(path, SOIL_FLAG_MULTIPLY_ALPHA | SOIL_FLAG_MIPMAPS | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT);
 }
\ No newline at end of file
@@ -1,19 +1,35 @@
 #include <iostream>
 #include <vector>
-#include <gl\glew.h>
-#include <gl\freeglut.h>
-#include <glm\glm.hpp>
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <glm/glm.hpp>
 #include <string>
 
-#include "SOIL\SOIL.h"
+#include "SOIL/SOIL.h"
+#include "TextureStreamer.h"
+#include "FrameStats.h"
+#include "TextRenderer.h"
 
 using namespace std;
 
 class GUI{
 public:
 	GLuint texture;
+	bool show_stats;
 
-	void draw(string course, string level, string par, string angle, string power);
+	TextureStreamer *streamer;
+	TextRenderer *text;
+	int course_label, level_label, par_label, power_label, angle_label;
+	int stats_labels[5];
+
+	// What the labels show, so a frame where nothing changed builds no strings.
+	string last_course, last_level, last_par;
+	float last_angle, last_power;
+	double last_stats[5];
+
+	void draw(const string &course, const string &level, const string &par, float angle, float power);
+	void draw_stats();
+	void toggle_stats();
 	void loadTexture(string path);
 	GUI(string path);
 };
\ No newline at end of file
@@ -1,42 +1,144 @@
 #include "Game.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+
+#include <ctime>
+#include <sstream>
 
 Game::Game(int argc, char **argv)
 {
 	levels = Level::load_levels(argv[1]);
 	current_level = 0;
+	watcher = new CourseWatcher(argv[1]);
+	reload_rejected = false;
+	predictor = new TrajectoryPredictor();
+
+	replay_file_name = new_replay_file_name();
+	replay_file.open(replay_file_name.c_str(), ios::binary);
+	if (!replay_file.is_open()) {
+		cout << "error - unable to open " << replay_file_name << ", shots will not be recorded." << endl;
+	}
+	else if (!levels.empty()) {
+		ShotLog(levels[0]->get_course_name()).write_header(replay_file);
+	}
 	
 	timer.start();
 	current_time = 0;
+	last_update = 0;
+	accumulator = 0;
 }
 
 Game::~Game()
 {
+	delete predictor; // Stops its thread before the levels it reads go away.
 	for (vector<Level*>::size_type i = 0; i < levels.size(); ++i) {
 		delete levels[i];
 	}
+	delete watcher;
+}
+
+string Game::new_replay_file_name()
+{
+	time_t now = time(NULL);
+	tm local;
+#ifdef _MSC_VER
+	localtime_s(&local, &now);
+#else
+	localtime_r(&now, &local);
+#endif
+	char stamp[32];
+	strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+
+	// Two sessions started in the same second get a counter rather than sharing a log.
+	string name = REPLAY_FILE_PREFIX + stamp + REPLAY_FILE_EXTENSION;
+	for (int n = 2; ifstream(name.c_str()).is_open(); ++n) {
+		stringstream ss;
+		ss << REPLAY_FILE_PREFIX << stamp << "-" << n << REPLAY_FILE_EXTENSION;
+		name = ss.str();
+	}
+	return name;
 }
 
 void Game::update()
 {
-	get_current_level()->update();
+	PROFILE_ZONE("Game::update");
+
+	// Swapped in before this frame's simulation and draw. A rejected file leaves the course, and any shot
+	// being recorded on it, as they were.
+	if (watcher->changed() && reload_levels()) {
+		recorder.cancel(); // The hole may have changed under the shot.
+	}
+
+	double now = timer.get_elapsed_time_in_sec();
+	accumulator += now - last_update;
+	last_update = now;
+
+	// Fixed steps keep the simulation independent of frame rate, so a recorded shot replays exactly.
+	int steps = 0;
+	while (accumulator >= PHYSICS_TIME_STEP) {
+		if (steps == MAX_STEPS_PER_UPDATE) {
+			accumulator = 0;
+			break;
+		}
+		accumulator -= PHYSICS_TIME_STEP;
+		steps++;
+
+		Level *level = get_current_level();
+		level->step(PHYSICS_TIME_STEP);
+		FrameStats::count_physics_step();
+
+		if (recorder.is_recording()) {
+			recorder.step();
 
+			if (level->ball_in_cup() || !level->get_ball()->is_active()) {
+				end_shot();
+			}
+		}
+
+		if (level->ball_in_cup()) {
+			next_level();
+			break;
+		}
+	}
+}
+
+void Game::add_force(vec3 f)
+{
+	if (!recorder.is_recording()) {
+		recorder.begin(current_level, get_current_level());
+	}
+	recorder.add_force(f);
+
+	get_current_level()->get_ball()->add_force(f);
+}
+
+void Game::aim(float angle, float power)
+{
 	Ball *ball = get_current_level()->get_ball();
-	Ball *isect = get_current_level()->get_cup()->get_sphere();
 
-	vec3 ball_pos = ball->get_position();
-	vec3 sphere_pos = isect->get_position();
+	if (ball->is_active() || recorder.is_recording()) {
+		predictor->clear();
+	}
+	else {
+		predictor->predict(get_current_level(), ball->get_position(), vec3(sin(angle) * power, 0.0f, cos(angle) * power));
+	}
+}
 
-	float ball_rad = ball->get_radius();
-	float sphere_rad = isect->get_radius();
+void Game::end_shot()
+{
+	Shot shot = recorder.end(get_current_level());
 
-	if (PhysicsObject::isect_sphere_sphere(ball_pos, ball_rad, sphere_pos, sphere_rad)) {
-		next_level();
+	if (replay_file.is_open()) {
+		ShotLog::write_shot(replay_file, shot);
+		replay_file.flush(); // The game usually ends with exit(), which skips destructors.
 	}
 }
 
 void Game::draw()
 {
 	get_current_level()->draw();
+
+	predictor->draw(get_current_level()->get_camera());
 }
 
 void Game::resize(int w, int h){
@@ -50,6 +152,7 @@ Level *Game::get_current_level() const
 
 void Game::next_level()
 {
+	recorder.cancel();
 	if (current_level == levels.size() - 1) {
 		current_level = 0;
 	}
@@ -60,6 +163,7 @@ void Game::next_level()
 
 void Game::previous_level()
 {
+	recorder.cancel();
 	if (current_level == 0) {
 		current_level = levels.size() - 1;
 	}
@@ -68,6 +172,28 @@ void Game::previous_level()
 	}
 }
 
+bool Game::reload_levels()
+{
+	predictor->wait_idle();
+	int rebuilt = Level::reload_levels(watcher->get_file_name(), levels);
+	if (rebuilt < 0) {
+		if (!reload_rejected) {
+			cout << "error - " << watcher->get_file_name() << " is incomplete or invalid, keeping the loaded course until it is fixed." << endl;
+			reload_rejected = true;
+		}
+		return false;
+	}
+	watcher->accept();
+	reload_rejected = false;
+
+	if (current_level >= (int)levels.size()) {
+		current_level = levels.size() - 1;
+	}
+
+	cout << "Reloaded " << watcher->get_file_name() << ": " << rebuilt << " hole(s) rebuilt." << endl;
+	return true;
+}
+
 Timer Game::get_timer() const
 {
 	return timer;
@@ -6,8 +6,8 @@
 #include <string>
 #include <cstdlib>
 
-#include <glm\glm.hpp>
-#include <glm\gtx\transform.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
 
 #include "Shader.h"
 #include "Level.h"
@@ -15,10 +15,18 @@
 #include "Tile.h"
 #include "Camera.h"
 #include "Timer.h"
+#include "CourseWatcher.h"
+#include "Replay.h"
+#include "TrajectoryPredictor.h"
 
 using namespace std;
 using namespace glm;
 
+static const double PHYSICS_TIME_STEP = 1.0 / 60.0; // Seconds simulated per physics step.
+static const int MAX_STEPS_PER_UPDATE = 8; // After a long stall, drop time rather than try to catch up.
+static const string REPLAY_FILE_PREFIX = "replay-"; // Each session logs to its own replay-<date>-<time>.mgr.
+static const string REPLAY_FILE_EXTENSION = ".mgr";
+
 class Game
 {
 public:
@@ -26,7 +34,11 @@ public:
 
 	~Game();
 
-	void update();
+	void update(); // Run as many fixed physics steps as real time calls for.
+
+	void add_force(vec3 f); // Hit the ball, recording the hit in the replay log.
+
+	void aim(float angle, float power); // Show the path of the shot being lined up while the ball is at rest.
 
 	void draw();
 
@@ -38,6 +50,8 @@ public:
 
 	void previous_level();
 
+	bool reload_levels(); // False, keeping the loaded course, if the file is rejected.
+
 	Timer get_timer() const;
 
 	double get_current_time() const;
@@ -48,10 +62,24 @@ private:
 	vector<Level*> levels;
 	int current_level;
 	Player *player;
+	CourseWatcher *watcher;
+	bool reload_rejected; // The watched file's current version failed to load; it is retried every poll.
+	TrajectoryPredictor *predictor;
+
+	// Replay members.
+	ShotRecorder recorder;
+	ofstream replay_file;
+	string replay_file_name;
+
+	static string new_replay_file_name(); // A name no earlier session has used.
+
+	void end_shot();
 
 	// Timer members.
 	Timer timer;
 	double current_time;
+	double last_update;
+	double accumulator; // Real time not yet simulated.
 };
 
 #endif
\ No newline at end of file
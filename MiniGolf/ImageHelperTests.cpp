@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "ImageHelperTests.h"
+#include "SOIL/image_helper.h"
+
+using namespace std;
+
+static const char *SIMD_LEVEL_NAMES[] = { "C", "SSE2", "AVX2" };
+static const int SIMD_LEVELS = sizeof(SIMD_LEVEL_NAMES) / sizeof(SIMD_LEVEL_NAMES[0]);
+
+// Odd sizes leave tails after every SIMD chunk; 2x2 is the smallest image up_scale_image accepts.
+static const int TEST_SIZES[][2] = { { 2, 2 }, { 3, 5 }, { 7, 3 }, { 17, 9 }, { 33, 31 }, { 67, 45 }, { 129, 3 }, { 256, 255 } };
+static const int TEST_SIZE_COUNT = sizeof(TEST_SIZES) / sizeof(TEST_SIZES[0]);
+static const int TEST_BLOCKS[][2] = { { 2, 2 }, { 2, 1 }, { 1, 2 }, { 3, 3 }, { 4, 4 }, { 16, 8 } };
+static const int TEST_BLOCK_COUNT = sizeof(TEST_BLOCKS) / sizeof(TEST_BLOCKS[0]);
+
+// One output of one helper, run at every level and compared with the plain C run.
+struct HelperCase {
+	string name;
+	vector<unsigned char> output;
+};
+
+static unsigned int seed;
+
+static vector<unsigned char> random_image(int width, int height, int channels)
+{
+	vector<unsigned char> image(width * height * channels);
+	for (vector<unsigned char>::size_type i = 0; i < image.size(); ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		image[i] = (unsigned char)(seed >> 24);
+	}
+	return image;
+}
+
+// Every case, run at the current level, in a fixed order so the outputs line up between levels.
+static void run_helpers(const vector<vector<unsigned char> > &images, vector<HelperCase> &outputs)
+{
+	outputs.clear();
+	int image = 0;
+	for (int s = 0; s < TEST_SIZE_COUNT; ++s) {
+		int width = TEST_SIZES[s][0], height = TEST_SIZES[s][1];
+		for (int channels = 1; channels <= 4; ++channels, ++image) {
+			const vector<unsigned char> &original = images[image];
+			char name[64];
+
+			// Up to the next size in the list, and to a size that is not a whole multiple.
+			int up_width = TEST_SIZES[(s + 1) % TEST_SIZE_COUNT][0] + width;
+			int up_height = TEST_SIZES[(s + 1) % TEST_SIZE_COUNT][1] + height + 1;
+			HelperCase up;
+			up.output.resize(up_width * up_height * channels);
+			up_scale_image(&original[0], width, height, channels, &up.output[0], up_width, up_height);
+			sprintf(name, "up_scale_image %dx%dx%d to %dx%d", width, height, channels, up_width, up_height);
+			up.name = name;
+			outputs.push_back(up);
+
+			for (int b = 0; b < TEST_BLOCK_COUNT; ++b) {
+				int block_x = TEST_BLOCKS[b][0], block_y = TEST_BLOCKS[b][1];
+				int mip_width = max(width / block_x, 1), mip_height = max(height / block_y, 1);
+				HelperCase mip;
+				mip.output.resize(mip_width * mip_height * channels);
+				mipmap_image(&original[0], width, height, channels, &mip.output[0], block_x, block_y);
+				sprintf(name, "mipmap_image %dx%dx%d by %dx%d", width, height, channels, block_x, block_y);
+				mip.name = name;
+				outputs.push_back(mip);
+			}
+
+			HelperCase ntsc;
+			ntsc.output = original;
+			scale_image_RGB_to_NTSC_safe(&ntsc.output[0], width, height, channels);
+			sprintf(name, "scale_image_RGB_to_NTSC_safe %dx%dx%d", width, height, channels);
+			ntsc.name = name;
+			outputs.push_back(ntsc);
+
+			if (channels >= 3) {
+				HelperCase ycocg;
+				ycocg.output = original;
+				convert_RGB_to_YCoCg(&ycocg.output[0], width, height, channels);
+				sprintf(name, "convert_RGB_to_YCoCg %dx%dx%d", width, height, channels);
+				ycocg.name = name;
+				outputs.push_back(ycocg);
+			}
+		}
+	}
+}
+
+int run_image_helper_tests(int argc, char **argv)
+{
+	seed = argc > 0 ? (unsigned int)atoi(argv[0]) : 1;
+
+	vector<vector<unsigned char> > images;
+	for (int s = 0; s < TEST_SIZE_COUNT; ++s) {
+		for (int channels = 1; channels <= 4; ++channels) {
+			images.push_back(random_image(TEST_SIZES[s][0], TEST_SIZES[s][1], channels));
+		}
+	}
+
+	image_helper_limit_SIMD(0);
+	vector<HelperCase> expected;
+	run_helpers(images, expected);
+
+	int failures = 0;
+	for (int level = 1; level < SIMD_LEVELS; ++level) {
+		int used = image_helper_limit_SIMD(level);
+		if (used < level) {
+			printf("%-5s skipped, not supported by this CPU or build\n", SIMD_LEVEL_NAMES[level]);
+			continue;
+		}
+
+		vector<HelperCase> actual;
+		run_helpers(images, actual);
+
+		int level_failures = 0;
+		for (vector<HelperCase>::size_type i = 0; i < expected.size(); ++i) {
+			if (memcmp(&actual[i].output[0], &expected[i].output[0], expected[i].output.size()) != 0) {
+				printf("%-5s FAILED %s\n", SIMD_LEVEL_NAMES[level], expected[i].name.c_str());
+				++level_failures;
+			}
+		}
+		printf("%-5s %d of %u outputs match plain C\n", SIMD_LEVEL_NAMES[level], (int)expected.size() - level_failures, (unsigned)expected.size());
+		failures += level_failures;
+	}
+	image_helper_limit_SIMD(SIMD_LEVELS - 1);
+
+	return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#ifndef IMAGE_HELPER_TESTS_H
+#define IMAGE_HELPER_TESTS_H
+
+// MiniGolf --test-simd [seed]
+// Runs SOIL's image helpers on random images of odd sizes with plain C, then again with each SIMD path the
+// CPU has, and checks that every output matches the plain C one byte for byte.
+int run_image_helper_tests(int argc, char **argv);
+
+#endif
\ No newline at end of file
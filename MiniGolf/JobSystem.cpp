@@ -0,0 +1,223 @@
+#include "JobSystem.h"
+
+#ifdef _WIN32
+#define JOB_THREAD_LOCAL __declspec(thread)
+#else
+#define JOB_THREAD_LOCAL __thread
+#endif
+
+static JOB_THREAD_LOCAL int thread_index = 0;
+static JOB_THREAD_LOCAL JobSystem *thread_owner = NULL;
+
+static mutex instance_lock;
+static JobSystem *instance = NULL;
+
+JobSystem::JobSystem(int workers) : pending(0), sleeping(0), stopping(false)
+{
+	if (workers < 0) {
+		workers = (int)thread::hardware_concurrency() - 1;
+	}
+	if (workers < 0) {
+		workers = 0;
+	}
+
+	for (int i = 0; i <= workers; ++i) {
+		queues.push_back(new WorkerQueue());
+	}
+	for (int i = 1; i <= workers; ++i) {
+		this->workers.push_back(thread(&JobSystem::worker_main, this, i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		lock_guard<mutex> guard(sleep_lock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (vector<thread>::size_type i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+	for (vector<WorkerQueue*>::size_type i = 0; i < queues.size(); ++i) {
+		delete queues[i];
+	}
+}
+
+JobSystem *JobSystem::get_instance()
+{
+	lock_guard<mutex> guard(instance_lock);
+	if (!instance) {
+		instance = new JobSystem();
+	}
+	return instance;
+}
+
+int JobSystem::get_thread_count() const
+{
+	return queues.size();
+}
+
+int JobSystem::get_thread_index()
+{
+	return thread_index;
+}
+
+void JobSystem::submit(const function<void()> &work, TaskGroup *group)
+{
+	Job job;
+	job.work = work;
+	job.group = group;
+	group->outstanding++;
+
+	int slot = thread_owner == this ? thread_index : 0;
+	{
+		lock_guard<mutex> guard(queues[slot]->lock);
+		queues[slot]->jobs.push_back(job);
+	}
+
+	// A worker counts itself as sleeping before it checks pending, so one of the two sees the other.
+	pending++;
+	if (sleeping > 0) {
+		lock_guard<mutex> guard(sleep_lock);
+		wake.notify_one();
+	}
+}
+
+bool JobSystem::pop(int slot, Job &job)
+{
+	WorkerQueue *queue = queues[slot];
+	lock_guard<mutex> guard(queue->lock);
+
+	if (queue->jobs.empty()) {
+		return false;
+	}
+	job = queue->jobs.back();
+	queue->jobs.pop_back();
+	return true;
+}
+
+bool JobSystem::steal(int slot, Job &job, unsigned int &seed)
+{
+	int count = queues.size();
+
+	seed = seed * 1664525u + 1013904223u;
+	int start = (seed >> 8) % count;
+
+	for (int i = 0; i < count; ++i) {
+		int victim = (start + i) % count;
+		if (victim == slot) {
+			continue;
+		}
+
+		WorkerQueue *queue = queues[victim];
+		lock_guard<mutex> guard(queue->lock);
+		if (!queue->jobs.empty()) {
+			job = queue->jobs.front();
+			queue->jobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::execute(Job &job)
+{
+	pending--;
+	job.work();
+	job.group->outstanding--;
+}
+
+bool JobSystem::run_one()
+{
+	int slot = thread_owner == this ? thread_index : 0;
+	unsigned int seed = (unsigned int)(size_t)&slot;
+	Job job;
+
+	if (pending > 0 && (pop(slot, job) || steal(slot, job, seed))) {
+		execute(job);
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::worker_main(int slot)
+{
+	thread_index = slot;
+	thread_owner = this;
+
+	unsigned int seed = slot * 2654435761u;
+	int idle = 0;
+	Job job;
+
+	while (!stopping) {
+		if (pop(slot, job) || steal(slot, job, seed)) {
+			execute(job);
+			job.work = NULL;
+			idle = 0;
+			continue;
+		}
+
+		if (++idle < JOB_STEAL_ATTEMPTS) {
+			this_thread::yield();
+			continue;
+		}
+
+		unique_lock<mutex> guard(sleep_lock);
+		sleeping++;
+		wake.wait(guard, [this]() { return pending > 0 || stopping; });
+		sleeping--;
+		idle = 0;
+	}
+}
+
+void JobSystem::split(int begin, int end, int grain, const function<void(int begin, int end)> &body, TaskGroup *group)
+{
+	// Keep the first half and hand the second to whoever wants it, until the piece is small enough.
+	while (end - begin > grain) {
+		int middle = begin + (end - begin) / 2;
+		int high = end;
+		submit([this, middle, high, grain, &body, group]() { split(middle, high, grain, body, group); }, group);
+		end = middle;
+	}
+	body(begin, end);
+}
+
+void JobSystem::parallel_for(int count, int grain, const function<void(int begin, int end)> &body)
+{
+	if (count <= 0) {
+		return;
+	}
+	if (grain < 1) {
+		grain = 1;
+	}
+
+	TaskGroup group(this);
+	split(0, count, grain, body, &group);
+	group.wait();
+}
+
+TaskGroup::TaskGroup(JobSystem *jobs) : outstanding(0)
+{
+	this->jobs = jobs;
+}
+
+TaskGroup::~TaskGroup()
+{
+	wait();
+}
+
+void TaskGroup::run(const function<void()> &work)
+{
+	jobs->submit(work, this);
+}
+
+void TaskGroup::wait()
+{
+	while (outstanding > 0) {
+		if (!jobs->run_one()) {
+			this_thread::yield();
+		}
+	}
+}
\ No newline at end of file
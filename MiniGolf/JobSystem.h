@@ -0,0 +1,101 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+static const int JOB_STEAL_ATTEMPTS = 64; // Failed steals before an idle worker goes to sleep.
+
+class TaskGroup;
+
+struct Job {
+	function<void()> work;
+	TaskGroup *group;
+};
+
+// Thread pool with one deque per worker. A worker pushes and pops its own jobs at the back
+// (most recent first, while the data is still in cache) and idle workers steal from the front
+// of a random victim, taking the oldest and usually largest piece of work.
+// Threads that wait on a TaskGroup run jobs meanwhile, so groups can nest without deadlock.
+class JobSystem
+{
+public:
+	JobSystem(int workers = -1); // -1 starts one per core but the calling thread's.
+
+	~JobSystem();
+
+	static JobSystem *get_instance(); // Shared pool, created on first use.
+
+	int get_thread_count() const; // Workers plus the calling thread; the range of get_thread_index().
+
+	static int get_thread_index(); // This thread's slot: 0 for threads outside the pool, 1.. for workers.
+
+	void submit(const function<void()> &work, TaskGroup *group);
+
+	// Run body(begin, end) over [0, count) in chunks of at most grain, splitting the range in
+	// halves so that thieves take large pieces. Returns once every chunk has run.
+	void parallel_for(int count, int grain, const function<void(int begin, int end)> &body);
+
+	bool run_one(); // Run a single pending job if there is one. Used while waiting.
+
+private:
+	struct WorkerQueue {
+		mutex lock;
+		deque<Job> jobs;
+	};
+
+	vector<WorkerQueue*> queues; // One per thread slot; slot 0 is shared by outside threads.
+	vector<thread> workers;
+
+	atomic<int> pending; // Jobs queued but not yet taken.
+	atomic<int> sleeping; // Workers waiting on wake.
+	atomic<bool> stopping;
+	mutex sleep_lock;
+	condition_variable wake;
+
+	JobSystem(const JobSystem &);
+
+	JobSystem &operator=(const JobSystem &);
+
+	bool pop(int slot, Job &job);
+
+	bool steal(int slot, Job &job, unsigned int &seed);
+
+	void execute(Job &job);
+
+	void worker_main(int slot);
+
+	void split(int begin, int end, int grain, const function<void(int begin, int end)> &body, TaskGroup *group);
+};
+
+// Counts outstanding jobs. wait() returns when all jobs run through this group have finished.
+class TaskGroup
+{
+public:
+	TaskGroup(JobSystem *jobs = JobSystem::get_instance());
+
+	~TaskGroup(); // Waits.
+
+	void run(const function<void()> &work);
+
+	void wait();
+
+private:
+	friend class JobSystem;
+
+	JobSystem *jobs;
+	atomic<int> outstanding;
+
+	TaskGroup(const TaskGroup &);
+
+	TaskGroup &operator=(const TaskGroup &);
+};
+
+#endif
\ No newline at end of file
@@ -1,33 +1,55 @@
 #include "Level.h"
+#include "Profiler.h"
+#include "JobSystem.h"
 
-Level::Level(vector<Tile*> tiles, Ball *b, Cup *c, Tee *tee, string course_name, string level_name, string par)
+Level::Level(string course_name)
 {
-	this->tiles = tiles;
-	camera = new Camera();
-	light = new Light(vec4(0.0f, 5.0f, 0.0f, 1.0f), vec3(0.5f), vec3(1.0f), vec3(1.0f));
-	this->ball = b;
-	this->cup = c;
-	this->tee = tee;
-	this->par = par;
+	camera = arena.create<Camera>();
+	light = arena.create<Light>(vec4(0.0f, 5.0f, 0.0f, 1.0f), vec3(0.5f), vec3(1.0f), vec3(1.0f));
+	ball = NULL;
+	cup = NULL;
+	tee = NULL;
 	this->course_name = course_name;
-	this->level_name = level_name;
 }
 
 Level::~Level()
 {
-	for (vector<Tile*>::size_type i = 0; i < tiles.size(); ++i) {
-		delete tiles[i];
+	arena.release(); // Tiles, borders, ball, cup, tee, camera and light. Shaders and materials are shared and outlive it.
+}
+
+void Level::step(double time_step)
+{
+	PROFILE_ZONE("Level::step");
+
+	step_ball(ball, time_step);
+}
+
+// Only reads the hole, so any number of threads may step their own balls on it at once.
+void Level::step_ball(Ball *b, double time_step) const
+{
+	Tile *t = find_tile(b->get_position());
+	if (t) {
+		b->set_current_tile(t);
 	}
-	delete camera;
-	delete light;
-	delete ball;
-	delete cup;
+	b->step(time_step);
+}
+
+void Level::reset_ball()
+{
+	ball->reset(tee_position);
+	set_ball_tile(tee_position);
 }
 
-void Level::update()
+bool Level::ball_in_cup() const
 {
-	set_ball_tile(ball->get_position());
-	ball->run_simulation(); // Run physics on the ball.
+	return ball_in_cup(ball);
+}
+
+bool Level::ball_in_cup(const Ball *b) const
+{
+	Ball *isect = cup->get_sphere();
+
+	return PhysicsObject::isect_sphere_sphere(b->get_position(), b->get_radius(), isect->get_position(), isect->get_radius());
 }
 
 void Level::set_ball_tile(vec3 point) {
@@ -39,17 +61,62 @@ void Level::set_ball_tile(vec3 point) {
 	}
 }
 
+Tile *Level::find_tile(vec3 point) const
+{
+	Tile *found = NULL;
+	for (vector<Tile*>::size_type i = 0; i < tiles.size(); ++i) {
+		if (tiles[i]->point_in_plane(point)) {
+			found = tiles[i];
+		}
+	}
+	return found;
+}
+
 void Level::draw()
 {
+	PROFILE_GPU_ZONE("Level::draw");
+
+	cull(Frustum(camera, DRAW_DISTANCE));
+
+	for (vector<Object3D*>::size_type i = 0; i < visible.size(); ++i) {
+		queue.submit(visible[i]);
+	}
+	queue.flush(camera, light);
+}
+
+const vector<Object3D*> &Level::get_visible() const
+{
+	return visible;
+}
+
+void Level::cull(const Frustum &frustum)
+{
+	PROFILE_ZONE("Level::cull");
+
+	visible.clear();
 	for (vector<Tile*>::size_type i = 0; i < tiles.size(); ++i) {
-		tiles[i]->draw(camera, light);
+		cull(frustum, tiles[i]);
+
+		const vector<Border*> &borders = tiles[i]->get_borders();
+		for (vector<Border*>::size_type j = 0; j < borders.size(); ++j) {
+			cull(frustum, borders[j]);
+		}
 	}
 
-	ball->draw(camera, light);
+	cull(frustum, ball);
 
-	cup->draw(camera, light);
+	cull(frustum, cup);
 
-	tee->draw(camera, light);
+	cull(frustum, tee);
+}
+
+void Level::cull(const Frustum &frustum, Object3D *object)
+{
+	vec3 min, max;
+	object->get_bounds(min, max);
+	if (frustum.contains(min, max)) {
+		visible.push_back(object);
+	}
 }
 
 Camera *Level::get_camera() const
@@ -67,26 +134,44 @@ Cup *Level::get_cup() const
 	return cup;
 }
 
-string Level::get_course_name() const
+const string &Level::get_course_name() const
 {
 	return course_name;
 }
 
-string Level::get_level_name() const
+const string &Level::get_level_name() const
 {
 	return level_name;
 }
 
-string Level::get_par() const
+const string &Level::get_par() const
 {
 	return par;
 }
 
-vector<Tile*> Level::get_tiles() const
+vec3 Level::get_tee_position() const
+{
+	return tee_position;
+}
+
+const vector<Tile*> &Level::get_tiles() const
 {
 	return tiles;
 }
 
+unsigned int Level::get_source_hash() const
+{
+	unsigned int hash = 2166136261u;
+
+	for (vector<string>::size_type i = 0; i < source.size(); ++i) {
+		for (string::size_type j = 0; j < source[i].size(); ++j) {
+			hash = (hash ^ (unsigned char)source[i][j]) * 16777619u;
+		}
+		hash = (hash ^ '\n') * 16777619u;
+	}
+	return hash;
+}
+
 void Level::print() const
 {
 	cout << "Course this Level belongs to: " << course_name << endl;
@@ -119,117 +204,340 @@ vector<string> string_split(const string &source, const char *delim, bool keep_e
 	return tokens;
 }
 
+static Tile *parse_tile(const vector<string> &tokens, Arena *arena)
+{
+	int tile_id = atoi(tokens[1].c_str());
+	int edge_count = atoi(tokens[2].c_str());
+
+	vector<int> neighbors;
+	for (vector<int>::size_type i = tokens.size() - edge_count; i < tokens.size(); ++i) {
+		neighbors.push_back(atoi(tokens[i].c_str()));
+	}
+
+	vector<vec3> vertices;
+	vec3 v;
+	for (vector<float>::size_type i = 3; i < tokens.size() - edge_count; i += 3) {
+		v.x = (float) atof(tokens[i].c_str());
+		v.y = (float) atof(tokens[i + 1].c_str());
+		v.z = (float) atof(tokens[i + 2].c_str());
+		vertices.push_back(v);
+	}
+
+	return arena->create<Tile>(tile_id, edge_count, vertices, neighbors, arena);
+}
+
+static bool is_number(const string &token)
+{
+	const char *start = token.c_str();
+	char *end;
+	strtod(start, &end);
+	return end != start && *end == '\0';
+}
+
+// Whether reload() can build from this line without reading past its tokens. A course file caught
+// mid-save can end part way through a line.
+static bool is_complete_line(const vector<string> &tokens)
+{
+	vector<string>::size_type numbers;
+	if (!tokens[0].compare(NAME)) {
+		return tokens.size() > 1;
+	}
+	else if (!tokens[0].compare(PAR)) {
+		return tokens.size() == 2;
+	}
+	else if (!tokens[0].compare(TILE)) {
+		// tile <id> <edges> <x y z per edge> <neighbour per edge>
+		if (tokens.size() < 3 || !is_number(tokens[2]) || atoi(tokens[2].c_str()) < 3) {
+			return false;
+		}
+		numbers = 3 + 4 * atoi(tokens[2].c_str());
+	}
+	else if (!tokens[0].compare(TEE) || !tokens[0].compare(CUP)) {
+		numbers = 5; // tee|cup <tile id> <x y z>
+	}
+	else {
+		return false;
+	}
+
+	if (tokens.size() != numbers) {
+		return false;
+	}
+	for (vector<string>::size_type i = 1; i < tokens.size(); ++i) {
+		if (!is_number(tokens[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static vec3 parse_position(const vector<string> &tokens)
+{
+	float positions[3];
+
+	for (int i = 2; i < 5; ++i) {
+		positions[i - 2] = (float)atof(tokens[i].c_str());
+	}
+
+	return vec3(positions[0], positions[1], positions[2]);
+}
+
 vector<Level*> Level::load_levels(string fname)
 {
 	vector<Level*> levels;
+
+	reload_levels(fname, levels);
+
+	return levels;
+}
+
+vector<Level*> Level::load_levels(istream &in, JobSystem *jobs)
+{
+	vector<Level*> levels;
+	string course_name;
+	vector<vector<string> > holes;
+
+	if (read_course(in, course_name, holes)) {
+		rebuild_levels(course_name, holes, levels, jobs);
+	}
+
+	return levels;
+}
+
+int Level::reload_levels(string fname, vector<Level*> &levels)
+{
 	string course_name;
-	int number_of_holes;
+	vector<vector<string> > holes;
 
 	ifstream in_file(fname);
-	if (in_file.is_open()) {
-
-		string line;
-			getline(in_file, line);
-			vector<string> tokens = string_split(line, " ", false); // Split up tokens by spaces.
-
-			if (!tokens[0].compare(COURSE)) {
-				course_name = "";
-				for (vector<string>::size_type i = 1; i < tokens.size() - 1; ++i) {
-					course_name += tokens[i] + " ";
-				}
-				number_of_holes = atoi(tokens[tokens.size() - 1].c_str());
-				
-				for (int i = 0; i < number_of_holes; ++i) {
-					vector<Tile*> tiles;
-					Ball *ball;
-					Cup *cup;
-					Tee *tee;
-					string level_name;
-					string par;
-					float positions[3];
-
-					getline(in_file, line);
-					vector<string> tokens = string_split(line, " ", false); // Split up tokens by spaces.
-
-					if (!tokens[0].compare(BEGIN_HOLE)) {
-						while (true) {
-							getline(in_file, line);
-							vector<string> tokens = string_split(line, " ", false); // Split up tokens by spaces.
-
-							if (!tokens[0].compare(NAME)) {
-								level_name = "";
-								for (vector<string>::size_type i = 1; i < tokens.size(); ++i) {
-									level_name += tokens[i] + " ";
-								}
-							}
-							else if (!tokens[0].compare(PAR)) {
-								par = tokens[1];
-							}
-							else if (!tokens[0].compare(TILE)) {
-								int tile_id = atoi(tokens[1].c_str());
-								int edge_count = atoi(tokens[2].c_str());
-
-								vector<int> neighbors;
-								for (vector<int>::size_type i = tokens.size() - edge_count; i < tokens.size(); ++i) {
-									neighbors.push_back(atoi(tokens[i].c_str()));
-								}
-
-								vector<vec3> vertices;
-								vec3 v;
-								for (vector<float>::size_type i = 3; i < tokens.size() - edge_count; i += 3) {
-									v.x = (float) atof(tokens[i].c_str());
-									v.y = (float) atof(tokens[i + 1].c_str());
-									v.z = (float) atof(tokens[i + 2].c_str());
-									vertices.push_back(v);
-								}
-
-								tiles.push_back(new Tile(tile_id, edge_count, vertices, neighbors));
-							}
-							else if (!tokens[0].compare(TEE)) {
-								int tile_id = atoi(tokens[1].c_str());
-
-								for (int i = 2; i < 5; ++i) {
-									positions[i - 2] = (float)atof(tokens[i].c_str());
-								}
-
-								vec3 pos = vec3(positions[0], positions[1], positions[2]);
-			
-								ball = new Ball(tile_id, pos);
-
-								vector<vec3> verts;
-								verts.push_back(vec3(pos.x - 0.09, pos.y + 0.01, pos.z - 0.09));
-								verts.push_back(vec3(pos.x + 0.09, pos.y + 0.01, pos.z - 0.09));
-								verts.push_back(vec3(pos.x + 0.09, pos.y + 0.01, pos.z + 0.09));
-								verts.push_back(vec3(pos.x - 0.09, pos.y + 0.01, pos.z + 0.09));
-
-								tee = new Tee(tile_id, pos, verts);
-							}
-							else if (!tokens[0].compare(CUP)) {
-								int tile_id = atoi(tokens[1].c_str());
-
-								for (int i = 2; i < 5; ++i) {
-									positions[i - 2] = (float)atof(tokens[i].c_str());
-								}
-
-								cup = new Cup(tile_id, vec3(positions[0], positions[1], positions[2]));
-							}
-							else if (!tokens[0].compare(END_HOLE)) {
-								break;
-							}
-							else {
-								cout << "error - unable to identify first token." << endl;
-							}
-						}
-						levels.push_back(new Level(tiles, ball, cup, tee, course_name, level_name, par));
-					}
-				}
+	if (!in_file.is_open()) {
+		cout << "error - unable to open in_file." << endl;
+		return -1;
+	}
+
+	if (!read_course(in_file, course_name, holes) || holes.empty()) {
+		return -1; // Keep whatever is loaded; the file may be mid-save.
+	}
+
+	in_file.close();
+
+	return rebuild_levels(course_name, holes, levels);
+}
+
+int Level::rebuild_levels(const string &course_name, const vector<vector<string> > &holes, vector<Level*> &levels, JobSystem *jobs)
+{
+	vector<int> changed;
+	for (vector<vector<string> >::size_type i = 0; i < holes.size(); ++i) {
+		if (i == levels.size()) {
+			levels.push_back(new Level(course_name));
+		}
+
+		levels[i]->course_name = course_name;
+		if (levels[i]->source != holes[i]) {
+			changed.push_back(i);
+		}
+	}
+
+	// Holes share nothing, so they build in parallel unless their constructors need the GL context.
+	if (Object3D::is_headless() && changed.size() > 1) {
+		if (jobs == NULL) {
+			jobs = JobSystem::get_instance();
+		}
+		jobs->parallel_for(changed.size(), 1, [&](int begin, int end) {
+			for (int i = begin; i < end; ++i) {
+				levels[changed[i]]->reload(holes[changed[i]]);
 			}
+		});
 	}
 	else {
-		cout << "error - unable to open in_file." << endl;
+		for (vector<int>::size_type i = 0; i < changed.size(); ++i) {
+			levels[changed[i]]->reload(holes[changed[i]]);
+		}
 	}
+	int rebuilt = changed.size();
 
-	in_file.close();
+	while (levels.size() > holes.size()) {
+		delete levels.back();
+		levels.pop_back();
+	}
 
-	return levels;
+	return rebuilt;
+}
+
+bool Level::read_course(istream &in_file, string &course_name, vector<vector<string> > &holes)
+{
+	string line;
+	getline(in_file, line);
+	vector<string> tokens = string_split(line, " \r", false); // Split up tokens by spaces.
+
+	if (tokens.size() < 2 || tokens[0].compare(COURSE)) {
+		cout << "error - the course file does not begin with a course." << endl;
+		return false;
+	}
+
+	course_name = "";
+	for (vector<string>::size_type i = 1; i < tokens.size() - 1; ++i) {
+		course_name += tokens[i] + " ";
+	}
+	int number_of_holes = atoi(tokens[tokens.size() - 1].c_str());
+
+	for (int i = 0; i < number_of_holes; ++i) {
+		vector<string> hole;
+		int tees = 0, cups = 0;
+
+		if (!getline(in_file, line)) {
+			cout << "error - the course file ends before hole " << i + 1 << "." << endl;
+			return false;
+		}
+
+		tokens = string_split(line, " \r", false);
+		if (tokens.empty() || tokens[0].compare(BEGIN_HOLE)) {
+			cout << "error - expected " << BEGIN_HOLE << " for hole " << i + 1 << "." << endl;
+			return false;
+		}
+
+		while (true) {
+			if (!getline(in_file, line)) {
+				cout << "error - hole " << i + 1 << " is missing " << END_HOLE << "." << endl;
+				return false;
+			}
+
+			if (!line.empty() && line[line.size() - 1] == '\r') {
+				line.erase(line.size() - 1);
+			}
+
+			tokens = string_split(line, " ", false);
+			if (tokens.empty()) {
+				continue;
+			}
+			if (!tokens[0].compare(END_HOLE)) {
+				break;
+			}
+			if (!is_complete_line(tokens)) {
+				cout << "error - hole " << i + 1 << " has an unknown or incomplete line: " << line << endl;
+				return false;
+			}
+			if (!tokens[0].compare(TEE)) {
+				tees++;
+			}
+			else if (!tokens[0].compare(CUP)) {
+				cups++;
+			}
+			hole.push_back(line);
+		}
+
+		// Level dereferences its ball and cup without checking.
+		if (tees == 0 || cups == 0) {
+			cout << "error - hole " << i + 1 << " has no " << (tees == 0 ? TEE : CUP) << "." << endl;
+			return false;
+		}
+
+		holes.push_back(hole);
+	}
+
+	return true;
+}
+
+void Level::reload(const vector<string> &hole)
+{
+	// Build the new hole beside the current one and only then swap it in, so the level is never half rebuilt.
+	// Tiles whose line is unchanged are carried over and keep their GPU buffers.
+	multimap<string, Tile*> previous_tiles;
+	for (vector<Tile*>::size_type i = 0; i < tiles.size(); ++i) {
+		previous_tiles.insert(make_pair(tile_sources[i], tiles[i]));
+	}
+
+	vector<Tile*> new_tiles;
+	vector<string> new_tile_sources;
+	string new_level_name = level_name, new_par = par;
+	string tee_line, cup_line;
+
+	for (vector<string>::size_type i = 0; i < hole.size(); ++i) {
+		vector<string> tokens = string_split(hole[i], " ", false); // Split up tokens by spaces.
+
+		if (!tokens[0].compare(NAME)) {
+			new_level_name = "";
+			for (vector<string>::size_type j = 1; j < tokens.size(); ++j) {
+				new_level_name += tokens[j] + " ";
+			}
+		}
+		else if (!tokens[0].compare(PAR)) {
+			new_par = tokens[1];
+		}
+		else if (!tokens[0].compare(TILE)) {
+			multimap<string, Tile*>::iterator it = previous_tiles.find(hole[i]);
+			if (it != previous_tiles.end()) {
+				new_tiles.push_back(it->second);
+				previous_tiles.erase(it);
+			}
+			else {
+				new_tiles.push_back(parse_tile(tokens, &arena));
+			}
+			new_tile_sources.push_back(hole[i]);
+		}
+		else if (!tokens[0].compare(TEE)) {
+			tee_line = hole[i];
+		}
+		else if (!tokens[0].compare(CUP)) {
+			cup_line = hole[i];
+		}
+	}
+
+	// read_course has checked there is a tee and a cup. The ball may reference a tile that no longer exists,
+	// so it always goes back to the tee.
+	vector<string> tokens = string_split(tee_line, " ", false);
+	int tee_tile = atoi(tokens[1].c_str());
+	vec3 new_tee_position = parse_position(tokens);
+	Ball *new_ball = arena.create<Ball>(tee_tile, new_tee_position, &arena);
+
+	Tee *new_tee = tee;
+	if (tee_line != tee_source) {
+		vector<vec3> verts;
+		verts.push_back(vec3(new_tee_position.x - 0.09, new_tee_position.y + 0.01, new_tee_position.z - 0.09));
+		verts.push_back(vec3(new_tee_position.x + 0.09, new_tee_position.y + 0.01, new_tee_position.z - 0.09));
+		verts.push_back(vec3(new_tee_position.x + 0.09, new_tee_position.y + 0.01, new_tee_position.z + 0.09));
+		verts.push_back(vec3(new_tee_position.x - 0.09, new_tee_position.y + 0.01, new_tee_position.z + 0.09));
+
+		new_tee = arena.create<Tee>(tee_tile, new_tee_position, verts, &arena);
+	}
+
+	Cup *new_cup = cup;
+	if (cup_line != cup_source) {
+		tokens = string_split(cup_line, " ", false);
+		new_cup = arena.create<Cup>(atoi(tokens[1].c_str()), parse_position(tokens), &arena);
+	}
+
+	// Everything is built; swap it in and destroy what the new hole no longer uses.
+	for (multimap<string, Tile*>::iterator it = previous_tiles.begin(); it != previous_tiles.end(); ++it) {
+		const vector<Border*> &borders = it->second->get_borders();
+		for (vector<Border*>::size_type i = 0; i < borders.size(); ++i) {
+			arena.destroy(borders[i]); // Gives their vertices back to the pool now rather than when the level goes.
+		}
+		arena.destroy(it->second);
+	}
+	tiles.swap(new_tiles);
+	tile_sources.swap(new_tile_sources);
+	visible.clear(); // May point at destroyed objects until the next draw.
+
+	arena.destroy(ball);
+	ball = new_ball;
+	tee_position = new_tee_position;
+
+	if (new_tee != tee) {
+		arena.destroy(tee);
+		tee = new_tee;
+		tee_source = tee_line;
+	}
+
+	if (new_cup != cup) {
+		if (cup) {
+			arena.destroy(cup->get_sphere());
+		}
+		arena.destroy(cup);
+		cup = new_cup;
+		cup_source = cup_line;
+	}
+
+	level_name = new_level_name;
+	par = new_par;
+	source = hole;
 }
\ No newline at end of file
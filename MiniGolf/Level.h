@@ -2,8 +2,9 @@
 #define LEVEL_H
 
 #include <vector>
-#include <gl\glew.h>
-#include <gl\freeglut.h>
+#include <map>
+#include <GL/glew.h>
+#include <GL/freeglut.h>
 
 #include "Shader.h"
 #include "Tile.h"
@@ -12,9 +13,14 @@
 #include "Ball.h"
 #include "Cup.h"
 #include "Tee.h"
+#include "Arena.h"
+#include "Frustum.h"
+#include "RenderQueue.h"
 
 using namespace std;
 
+class JobSystem;
+
 static const string TILE = "tile";
 static const string TEE = "tee";
 static const string CUP = "cup";
@@ -24,16 +30,26 @@ static const string END_HOLE = "end_hole";
 static const string NAME = "name";
 static const string PAR = "par";
 
+static const float DRAW_DISTANCE = 60.0f; // Objects with no point this close to the eye are not drawn.
+
 class Level
 {
 public:
-	Level(vector<Tile*> tiles, Ball *b, Cup *c, Tee *tee, string course_name, string level_name, string par);
-
 	~Level();
 
-	void update();
+	void step(double time_step); // Advance this hole's ball by one fixed physics step.
+
+	void step_ball(Ball *b, double time_step) const; // Step a ball that is not this hole's own.
+
+	void reset_ball(); // Put the ball back on the tee.
+
+	bool ball_in_cup() const;
 
-	void draw();
+	bool ball_in_cup(const Ball *b) const;
+
+	void draw(); // Only what the camera can see, sorted to change as little GL state as possible.
+
+	const vector<Object3D*> &get_visible() const; // What the last draw() kept.
 
 	Camera *get_camera() const;
 
@@ -41,27 +57,62 @@ public:
 
 	Cup *get_cup() const;
 
-	string get_course_name() const;
+	const string &get_course_name() const;
+
+	const string &get_level_name() const;
 
-	string get_level_name() const;
+	const string &get_par() const;
 
-	string get_par() const;
+	vec3 get_tee_position() const;
 
-	vector<Tile*> get_tiles() const;
+	const vector<Tile*> &get_tiles() const;
+
+	unsigned int get_source_hash() const; // FNV-1a of the hole's course file lines; identifies the layout a replay was recorded on.
 
 	void print() const;
 
 	static vector<Level*> load_levels(string fname);
 
-	void Level::set_ball_tile(vec3 point);
+	// Parse a course that is already in memory. Headless holes build on jobs, or on the shared pool when it is NULL.
+	static vector<Level*> load_levels(istream &in, JobSystem *jobs = NULL);
+
+	static int reload_levels(string fname, vector<Level*> &levels); // Rebuild only the holes that changed on disk; -1, changing nothing, if the file is rejected.
+
+	void set_ball_tile(vec3 point);
+
+	Tile *find_tile(vec3 point) const; // The tile set_ball_tile would pick, or NULL when point is off the course.
 
 private:
+	Level(string course_name);
+
+	Level(const Level &);
+
+	Level &operator=(const Level &);
+
+	static bool read_course(istream &in_file, string &course_name, vector<vector<string> > &holes); // False if a hole is cut short, has an unknown or incomplete line, or lacks a tee or cup.
+
+	static int rebuild_levels(const string &course_name, const vector<vector<string> > &holes, vector<Level*> &levels, JobSystem *jobs = NULL);
+
+	void reload(const vector<string> &hole); // Rebuild this hole from lines read_course checked, reusing tiles whose definition is unchanged.
+
+	void cull(const Frustum &frustum);
+
+	void cull(const Frustum &frustum, Object3D *object);
+
+	Arena arena; // Every object of this hole lives here and is freed with it.
 	vector<Tile*> tiles;
+	vector<string> tile_sources; // The course file line each tile was built from.
+	vector<string> source; // The course file lines of this hole.
+	vec3 tee_position;
+	string tee_source;
+	string cup_source;
 	Camera *camera;
 	Light *light;
 	Ball *ball;
 	Cup *cup;
 	Tee *tee;
+	vector<Object3D*> visible; // Rebuilt every draw; keeps its capacity so culling does not allocate.
+	RenderQueue queue;
 	string course_name;
 	string level_name;
 	string par;
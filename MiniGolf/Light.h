@@ -2,7 +2,7 @@
 #define LIGHT_H
 
 #include <iostream>
-#include <glm\glm.hpp>
+#include <glm/glm.hpp>
 
 using namespace std;
 using namespace glm;
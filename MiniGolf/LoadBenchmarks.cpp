@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <sstream>
+
+#include "LoadBenchmarks.h"
+#include "Benchmark.h"
+#include "CourseGenerator.h"
+#include "AllocationCounter.h"
+#include "Timer.h"
+
+static const int LOAD_REPEATS = 3; // Report the fastest of this many loads.
+static const int GENERATED_HOLES = 18;
+static const int GENERATED_TILES[] = { 100, 1000, 10000, 50000 }; // The largest still fits a 32-bit process.
+
+static void bench_load(string fname)
+{
+	double best = -1.0;
+	long long allocations = 0, bytes = 0;
+	size_t levels = 0, tiles = 0;
+
+	for (int i = 0; i < LOAD_REPEATS; ++i) {
+		Timer timer;
+		long long allocations_before = AllocationCounter::get_allocations();
+		long long bytes_before = AllocationCounter::get_bytes();
+
+		timer.start();
+		vector<Level*> loaded = Level::load_levels(fname);
+		double seconds = timer.get_elapsed_time_in_sec();
+
+		allocations = AllocationCounter::get_allocations() - allocations_before;
+		bytes = AllocationCounter::get_bytes() - bytes_before;
+		if (best < 0 || seconds < best) {
+			best = seconds;
+		}
+
+		levels = loaded.size();
+		tiles = 0;
+		for (vector<Level*>::size_type j = 0; j < loaded.size(); ++j) {
+			tiles += loaded[j]->get_tiles().size();
+			delete loaded[j];
+		}
+	}
+
+	// Peak memory only ever grows, so courses should be given from smallest to largest.
+	printf("%-40s %6u %9u %12.2f ms %14.0f %12lld %12.1f MB %12.1f MB\n", fname.c_str(), (unsigned)levels, (unsigned)tiles,
+		best * 1e3, tiles / best, allocations, bytes / 1048576.0, Benchmark::get_peak_memory() / 1048576.0);
+}
+
+int run_load_benchmarks(int argc, char **argv)
+{
+	Object3D::set_headless(true); // Measures parsing and geometry, not GPU uploads.
+
+	vector<string> courses;
+	for (int i = 0; i < argc; ++i) {
+		courses.push_back(argv[i]);
+	}
+
+	vector<string> generated;
+	if (courses.empty()) {
+		for (size_t i = 0; i < sizeof(GENERATED_TILES) / sizeof(GENERATED_TILES[0]); ++i) {
+			ostringstream fname;
+			fname << Benchmark::get_temp_directory() << "minigolf." << GENERATED_HOLES << "x" << GENERATED_TILES[i] << ".db";
+
+			if (CourseGenerator(GENERATED_HOLES, GENERATED_TILES[i], 0.2f, 0.1f).write_file(fname.str())) {
+				generated.push_back(fname.str());
+			}
+		}
+		courses = generated;
+	}
+
+	printf("%-40s %6s %9s %15s %14s %12s %15s %15s\n", "Course", "Holes", "Tiles", "Parse", "Tiles/s", "Allocs", "Allocated", "Peak RSS");
+	printf("%s\n", string(136, '-').c_str());
+
+	for (vector<string>::size_type i = 0; i < courses.size(); ++i) {
+		bench_load(courses[i]);
+	}
+
+	for (vector<string>::size_type i = 0; i < generated.size(); ++i) {
+		remove(generated[i].c_str());
+	}
+
+	return 0;
+}
\ No newline at end of file
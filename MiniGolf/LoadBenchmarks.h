@@ -0,0 +1,9 @@
+#ifndef LOAD_BENCHMARKS_H
+#define LOAD_BENCHMARKS_H
+
+// MiniGolf --bench-load [course files...]
+// Times Level::load_levels on the given courses, or, when none are given, on generated courses of growing size
+// written to the temp directory and removed afterwards.
+int run_load_benchmarks(int argc, char **argv);
+
+#endif
\ No newline at end of file
@@ -28,4 +28,9 @@ vec3 Material::get_specular() const
 float Material::get_shininess() const
 {
 	return shininess;
+}
+
+bool Material::operator==(const Material &other) const
+{
+	return ambient == other.ambient && diffuse == other.diffuse && specular == other.specular && shininess == other.shininess;
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef MATERIAL_H
 #define MATERIAL_H
 
-#include <glm\glm.hpp>
+#include <glm/glm.hpp>
 
 using namespace glm;
 
@@ -20,6 +20,8 @@ public:
 
 	float get_shininess() const;
 
+	bool operator==(const Material &other) const;
+
 private:
 	vec3 ambient;
 	vec3 diffuse;
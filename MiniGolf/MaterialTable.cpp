@@ -0,0 +1,73 @@
+#include "MaterialTable.h"
+#include "GLState.h"
+
+mutex MaterialTable::lock;
+vector<Material> MaterialTable::materials;
+GLuint MaterialTable::buffer = 0;
+int MaterialTable::uploaded = 0;
+
+int MaterialTable::add(const Material &material)
+{
+	lock_guard<mutex> guard(lock);
+
+	for (vector<Material>::size_type i = 0; i < materials.size(); ++i) {
+		if (materials[i] == material) {
+			return (int)i;
+		}
+	}
+
+	if ((int)materials.size() == MAX_MATERIALS) {
+		cout << "error - more than " << MAX_MATERIALS << " materials; using the first instead" << endl;
+		return 0;
+	}
+
+	materials.push_back(material);
+	return (int)materials.size() - 1;
+}
+
+Material MaterialTable::get(int index)
+{
+	lock_guard<mutex> guard(lock);
+
+	return materials.at(index);
+}
+
+int MaterialTable::get_count()
+{
+	lock_guard<mutex> guard(lock);
+
+	return (int)materials.size();
+}
+
+// std140 MaterialInfo: three vec4s, the shininess riding in the specular's w.
+void MaterialTable::bind()
+{
+	lock_guard<mutex> guard(lock);
+
+	if (!buffer) {
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferData(GL_UNIFORM_BUFFER, MAX_MATERIALS * 12 * sizeof(float), NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	if (uploaded < (int)materials.size()) {
+		vector<float> data;
+		for (vector<Material>::size_type i = uploaded; i < materials.size(); ++i) {
+			const Material &m = materials[i];
+			float packed[12] = {
+				m.get_ambient().x, m.get_ambient().y, m.get_ambient().z, 0.0f,
+				m.get_diffuse().x, m.get_diffuse().y, m.get_diffuse().z, 0.0f,
+				m.get_specular().x, m.get_specular().y, m.get_specular().z, m.get_shininess()
+			};
+			data.insert(data.end(), packed, packed + 12);
+		}
+
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, uploaded * 12 * sizeof(float), data.size() * sizeof(float), &data[0]);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		uploaded = (int)materials.size();
+	}
+
+	GLState::bind_buffer_base(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, buffer);
+}
\ No newline at end of file
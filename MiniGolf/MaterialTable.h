@@ -0,0 +1,36 @@
+#ifndef MATERIAL_TABLE_H
+#define MATERIAL_TABLE_H
+
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <GL/glew.h>
+
+#include "Material.h"
+
+using namespace std;
+
+static const int MAX_MATERIALS = 256; // Length of the Materials array in shaders/ads.vert.
+static const GLuint MATERIAL_BLOCK_BINDING = 0; // Uniform buffer binding point of MaterialBlock.
+
+// Every distinct material in the game, stored once. Objects hold an index into the table and the shaders
+// read the whole of it from one uniform buffer, so changing material between draws sets a single int.
+class MaterialTable
+{
+public:
+	static int add(const Material &material); // The index of an equal material if there already is one. Any thread.
+
+	static Material get(int index);
+
+	static int get_count();
+
+	static void bind(); // Uploads what was added since the last call and binds the buffer. GL thread only.
+
+private:
+	static mutex lock;
+	static vector<Material> materials;
+	static GLuint buffer;
+	static int uploaded; // Leading materials already in the buffer.
+};
+
+#endif
\ No newline at end of file
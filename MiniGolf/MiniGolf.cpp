@@ -1,7 +1,24 @@
 #include "Game.h"
 #include "Shader.h"
 #include "Camera.h"
-#include "Gui.h"
+#include "GUI.h"
+#include "PhysicsBenchmarks.h"
+#include "LoadBenchmarks.h"
+#include "CourseGenerator.h"
+#include "Replay.h"
+#include "ParSolver.h"
+#include "Server.h"
+#include "TextureAtlas.h"
+#include "OffscreenRenderer.h"
+#include "ImageHelperTests.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "SOIL/stb_image_aug.h"
+
+extern "C" {
+#include "SOIL/image_DXT.h"
+}
+
 #include <string>
 
 using namespace glm;
@@ -48,25 +65,25 @@ void keyboard() //perform action based on keystates
 			case 'i':
 				if (true) {
 					vec3 f = vec3(sin(angle) * power, 0.0f, cos(angle) * power);
-					game->get_current_level()->get_ball()->add_force(f);
+					game->add_force(f);
 				}
 				break;
 			case 'j':
 				if (true) {
 					vec3 f = vec3(sin(1.5 * angle) * power, 0.0f, cos(1.5 * angle) * power);
-					game->get_current_level()->get_ball()->add_force(f);
+					game->add_force(f);
 				}
 				break;
 			case 'k':
 				if (true) {
 					vec3 f = vec3(0.0f, 0.0f, power);
-					game->get_current_level()->get_ball()->add_force(f);
+					game->add_force(f);
 				}
 				break;
 			case 'l':
 				if (true) {
 					vec3 f = vec3(sin(0.5 * angle) * power, 0.0f, cos(0.5 * angle) * power);
-					game->get_current_level()->get_ball()->add_force(f);
+					game->add_force(f);
 				}
 				break;
 			default:
@@ -98,17 +115,19 @@ void display()
 
 	keyboard();
 
+	game->aim(angle, power);
+
 	game->update();
 
 	game->draw();
 
-	string course = game->get_current_level()->get_course_name();
-	string level = game->get_current_level()->get_level_name();
-	string par = game->get_current_level()->get_par();
-
-	gui->draw(course, level, par, to_string(angle), to_string(power));
+	const Level *current = game->get_current_level();
+	gui->draw(current->get_course_name(), current->get_level_name(), current->get_par(), angle, power);
 
 	glutSwapBuffers();
+
+	Profiler::end_frame();
+	FrameStats::end_frame();
 }
 
 void reshape(int w, int h) 
@@ -180,11 +199,53 @@ void keyboard_down(unsigned char c, int x, int y) {
 			}
 			cout << "Angle: " << angle << endl;
 			break;
+		case 'h': // Toggle the performance overlay
+			gui->toggle_stats();
+			break;
+		case 'p': // Dump the profiler's recent history
+			Profiler::write_chrome_trace("profile.json");
+			break;
 	}
 	glutPostRedisplay();
 }
 
 int main(int argc, char **argv) {
+	if (argc > 1 && string(argv[1]) == "--bench") {
+		return run_physics_benchmarks(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--test-simd") {
+		return run_image_helper_tests(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--bench-load") {
+		return run_load_benchmarks(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--generate") {
+		return run_course_generator(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--replay") {
+		return run_replay(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--solve-par") {
+		return run_par_solver(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--server") {
+		return run_server(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--build-atlas") {
+		return run_atlas_builder(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--render") {
+		return run_offscreen_renderer(argc - 2, argv + 2);
+	}
+	if (argc > 1 && string(argv[1]) == "--image-test") {
+		return run_image_test(argc - 2, argv + 2);
+	}
+
+	// The game's textures decode and compress on the job pool, one per worker, so SOIL starting threads of
+	// its own would only oversubscribe the cores. Set before the GUI's streamer starts any work.
+	stbi_set_thread_count(1);
+	set_DXT_thread_count(1);
+
 	glutInit(&argc, argv);
 
 	glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
@@ -192,6 +253,7 @@ int main(int argc, char **argv) {
 	glutCreateWindow("Mini Golf");
 
 	glewInit();
+	Profiler::set_gpu_enabled(GLEW_ARB_timer_query != 0);
 
 	glutDisplayFunc(display);
 	glutReshapeFunc(reshape);
@@ -1,19 +1,56 @@
 #include "Object3D.h"
 
-Object3D::Object3D() {}
+bool Object3D::headless = false;
 
-Object3D::Object3D(int id, vec3 pos) : Object(pos)
+Object3D::Object3D()
 {
-	shader = new Shader("shaders/ads.vert", "shaders/ads.frag");
-	shader->readAndCompileShader();
+	shader = NULL;
+	material = 0;
+	vao_handle = 0;
+}
+
+Object3D::Object3D(int id, vec3 pos, Arena *arena) : Object(pos)
+{
+	this->arena = arena;
+
+	shader = NULL;
+	material = 0;
+	vao_handle = 0;
+	if (!headless) {
+		shader = Shader::get_shared("shaders/ads.vert", "shaders/ads.frag");
+	}
 
 	tile_id = id;
 }
 
 Object3D::~Object3D()
 {
-	delete shader;
-	delete material;
+	if (geometry.vertex_count > 0) {
+		VertexPool::get_shared()->release(geometry);
+	}
+}
+
+void Object3D::upload(const vector<Vertex> &vertices, const vector<GLuint> &indices)
+{
+	VertexPool *pool = VertexPool::get_shared();
+	pool->release(geometry);
+	geometry = pool->allocate(vertices, indices);
+	vao_handle = pool->get_vao();
+}
+
+bool Object3D::culls_back_faces() const
+{
+	return false;
+}
+
+Shader *Object3D::get_shader() const
+{
+	return shader;
+}
+
+GLuint Object3D::get_vao() const
+{
+	return vao_handle;
 }
 
 int Object3D::get_tile_id() const
@@ -26,12 +63,34 @@ void Object3D::set_tile_id(int id)
 	tile_id = id;
 }
 
-Material *Object3D::get_material() const
+int Object3D::get_material() const
 {
 	return material;
 }
 
-void Object3D::set_material(Material *mat)
+void Object3D::set_material(int mat)
 {
 	material = mat;
+}
+
+void Object3D::set_texture_region(const AtlasRegion &region)
+{
+	if (geometry.vertex_count == 0 || tex_coords.empty()) {
+		return;
+	}
+
+	vector<float> remapped = tex_coords;
+	region.remap(&remapped[0], (int)remapped.size() / 2);
+
+	VertexPool::get_shared()->write_uvs(geometry, &remapped[0]);
+}
+
+bool Object3D::is_headless()
+{
+	return headless;
+}
+
+void Object3D::set_headless(bool h)
+{
+	headless = h;
 }
\ No newline at end of file
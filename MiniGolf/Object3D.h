@@ -3,17 +3,21 @@
 
 #include <iostream>
 #include <vector>
-#include <gl\glew.h>
-#include <gl\freeglut.h>
+#include <GL/glew.h>
+#include <GL/freeglut.h>
 
-#include <glm\glm.hpp>
-#include <glm\gtx\transform.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
 
 #include "Object.h"
 #include "Light.h"
 #include "Camera.h"
 #include "Shader.h"
 #include "Material.h"
+#include "MaterialTable.h"
+#include "VertexPool.h"
+#include "Arena.h"
+#include "TextureAtlas.h"
 
 using namespace std;
 using namespace glm;
@@ -23,25 +27,46 @@ class Object3D : public Object
 public:
 	Object3D();
 
-	Object3D(int id, vec3 position);
+	Object3D(int id, vec3 position, Arena *arena);
 
-	~Object3D();
+	virtual ~Object3D(); // Gives its geometry back to the vertex pool.
 
-	virtual void draw(Camera *camera, Light *light) = 0;
+	virtual void draw_geometry() const = 0; // The draw call alone, once the program, VAO and uniforms are in place.
+
+	virtual bool culls_back_faces() const;
+
+	Shader *get_shader() const; // Shared with every object drawn the same way; NULL when headless.
+
+	GLuint get_vao() const;
+
+	virtual void get_bounds(vec3 &min, vec3 &max) const = 0; // World space box around everything draw_geometry() puts on screen.
 
 	int get_tile_id() const;
 
 	void set_tile_id(int id);
 
-	Material *get_material() const;
+	int get_material() const; // Index into the MaterialTable.
+
+	void set_material(int mat);
 
-	void set_material(Material *mat);
+	void set_texture_region(const AtlasRegion &region); // Points the uploaded tex coords at one image of an atlas.
+
+	static bool is_headless();
+
+	static void set_headless(bool h); // Build geometry and physics only, without touching GL.
 
 protected:
+	Arena *arena; // Owns any child objects.
 	Shader *shader;
-	Material *material;
-	GLuint vao_handle;
+	int material;
+	GLuint vao_handle; // The shared vertex pool's.
+	VertexAllocation geometry; // Empty when headless.
+	vector<float> tex_coords; // As built, over the whole [0, 1] image; empty for objects without them.
 	int tile_id;
+
+	static bool headless;
+
+	void upload(const vector<Vertex> &vertices, const vector<GLuint> &indices); // Replaces the geometry. No indices for glDrawArrays.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,370 @@
+#include "OffscreenRenderer.h"
+#include "FrameStats.h"
+#include "Timer.h"
+#include "SOIL/SOIL.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <GL/freeglut.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+OffscreenRenderer::OffscreenRenderer(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+	framebuffer = 0;
+	renderbuffers[0] = renderbuffers[1] = 0;
+	display = NULL;
+	context = NULL;
+	window = 0;
+
+	ready = create_context();
+	if (!ready) {
+		return;
+	}
+
+	// Same state the game window starts with.
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_LINE_SMOOTH);
+	glFrontFace(GL_CCW);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glGenRenderbuffers(2, renderbuffers);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		cout << "error - the offscreen framebuffer is incomplete" << endl;
+		ready = false;
+	}
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+	if (framebuffer) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(2, renderbuffers);
+	}
+	destroy_context();
+}
+
+bool OffscreenRenderer::is_ready() const
+{
+	return ready;
+}
+
+#ifdef _WIN32
+
+bool OffscreenRenderer::create_context()
+{
+	int argc = 1;
+	char *argv[] = { (char *)"MiniGolf", NULL };
+	glutInit(&argc, argv);
+	glutInitDisplayMode(GLUT_RGBA | GLUT_DEPTH);
+	glutInitWindowSize(1, 1);
+	window = glutCreateWindow("Mini Golf");
+	glutHideWindow();
+
+	if (glewInit() != GLEW_OK) {
+		cout << "error - could not load OpenGL functions" << endl;
+		return false;
+	}
+	return true;
+}
+
+void OffscreenRenderer::destroy_context()
+{
+	if (window) {
+		glutDestroyWindow(window);
+	}
+}
+
+#else
+
+// Mesa's surfaceless platform needs no display server; other EGL drivers get their default display.
+bool OffscreenRenderer::create_context()
+{
+	EGLDisplay egl_display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (get_platform_display) {
+		egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (egl_display == EGL_NO_DISPLAY) {
+		egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor)) {
+		cout << "error - could not initialise EGL" << endl;
+		return false;
+	}
+	display = egl_display;
+
+	// Desktop GL with the compatibility profile: the course still draws GL_POLYGON and GL_QUADS.
+	EGLint config_attributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = NULL;
+	EGLint configs = 0;
+	eglChooseConfig(egl_display, config_attributes, &config, 1, &configs);
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		cout << "error - EGL has no desktop OpenGL" << endl;
+		return false;
+	}
+
+	EGLint context_attributes[] = { EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 0, EGL_NONE };
+	EGLContext egl_context = eglCreateContext(egl_display, configs > 0 ? config : NULL, EGL_NO_CONTEXT, context_attributes);
+	if (egl_context == EGL_NO_CONTEXT || !eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context)) {
+		cout << "error - could not make a surfaceless OpenGL context (EGL error 0x" << hex << eglGetError() << dec << ")" << endl;
+		return false;
+	}
+	context = egl_context;
+
+	// A GLEW built for GLX still loads every GL function before it notices there is no X display.
+	glewExperimental = GL_TRUE;
+	GLenum loaded = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	if (loaded == GLEW_ERROR_NO_GLX_DISPLAY) {
+		loaded = GLEW_OK;
+	}
+#endif
+	if (loaded != GLEW_OK || !glGenFramebuffers) {
+		cout << "error - could not load OpenGL functions: " << glewGetErrorString(loaded) << endl;
+		return false;
+	}
+	return true;
+}
+
+void OffscreenRenderer::destroy_context()
+{
+	if (context) {
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(display, context);
+	}
+	if (display) {
+		eglTerminate(display);
+	}
+}
+
+#endif
+
+double OffscreenRenderer::render(Level *level)
+{
+	Timer timer;
+	timer.start();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	level->get_camera()->resize(width, height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	level->draw();
+
+	glFinish();
+	double elapsed = timer.get_elapsed_time_in_milli_sec();
+
+	FrameStats::end_frame();
+	return elapsed;
+}
+
+void OffscreenRenderer::read_pixels(vector<unsigned char> &rgba) const
+{
+	rgba.resize(width * height * 4);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &rgba[0]);
+
+	// GL reads bottom row first.
+	vector<unsigned char> row(width * 4);
+	for (int y = 0; y < height / 2; ++y) {
+		unsigned char *top = &rgba[y * width * 4];
+		unsigned char *bottom = &rgba[(height - 1 - y) * width * 4];
+		memcpy(&row[0], top, width * 4);
+		memcpy(top, bottom, width * 4);
+		memcpy(bottom, &row[0], width * 4);
+	}
+}
+
+bool OffscreenRenderer::write_image(string path) const
+{
+	vector<unsigned char> rgba;
+	read_pixels(rgba);
+
+	string extension = path.size() > 4 ? path.substr(path.size() - 4) : "";
+	bool written;
+	if (extension == ".tga" || extension == ".TGA") {
+		written = SOIL_save_image(path.c_str(), SOIL_SAVE_TYPE_TGA, width, height, 4, &rgba[0]) != 0;
+	}
+	else {
+		ofstream file(path.c_str(), ios::binary);
+		file.write((const char *)&rgba[0], rgba.size());
+		written = file.good();
+	}
+
+	if (!written) {
+		cout << "error - could not write " << path << endl;
+	}
+	return written;
+}
+
+// Hole 3 of out.tga goes to out.3.tga.
+static string hole_image_path(string path, int hole)
+{
+	string::size_type dot = path.find_last_of('.');
+	string::size_type slash = path.find_last_of("/\\");
+	if (dot == string::npos || (slash != string::npos && dot < slash)) {
+		dot = path.size();
+	}
+
+	stringstream name;
+	name << path.substr(0, dot) << "." << hole << path.substr(dot);
+	return name.str();
+}
+
+int run_offscreen_renderer(int argc, char **argv)
+{
+	if (argc < 1) {
+		cout << "usage: MiniGolf --render <course> [hole, 0 for all] [image.tga|image.raw|-] [frames] [width] [height] [eye x y z] [center x y z]" << endl;
+		return 1;
+	}
+
+	int hole = argc > 1 ? atoi(argv[1]) : 1;
+	string image = argc > 2 ? argv[2] : "-";
+	int frames = argc > 3 ? atoi(argv[3]) : OFFSCREEN_FRAMES;
+	int width = argc > 4 ? atoi(argv[4]) : OFFSCREEN_WIDTH;
+	int height = argc > 5 ? atoi(argv[5]) : OFFSCREEN_HEIGHT;
+	bool place_camera = argc > 11;
+
+	if (frames < 1 || width < 1 || height < 1) {
+		cout << "error - need at least one frame of at least one pixel." << endl;
+		return 1;
+	}
+
+	OffscreenRenderer renderer(width, height);
+	if (!renderer.is_ready()) {
+		return 1;
+	}
+	cout << "OpenGL Version: " << glGetString(GL_VERSION) << endl;
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl << endl;
+
+	vector<Level*> levels = Level::load_levels(argv[0]);
+	if (hole < 0 || hole > (int)levels.size() || levels.empty()) {
+		cout << "error - " << argv[0] << " has no hole " << hole << endl;
+		return 1;
+	}
+
+	int first = hole == 0 ? 0 : hole - 1;
+	int last = hole == 0 ? (int)levels.size() - 1 : hole - 1;
+
+	printf("%-4s %-32s %6s %6s %9s %9s %9s %9s %9s %7s\n", "hole", "name", "draws", "state", "min", "median", "mean", "p95", "max", "fps");
+	for (int i = first; i <= last; ++i) {
+		Level *level = levels[i];
+		if (place_camera) {
+			level->get_camera()->look_at(vec3((float)atof(argv[6]), (float)atof(argv[7]), (float)atof(argv[8])),
+				vec3((float)atof(argv[9]), (float)atof(argv[10]), (float)atof(argv[11])));
+		}
+
+		for (int f = 0; f < OFFSCREEN_WARMUP_FRAMES; ++f) {
+			renderer.render(level);
+		}
+
+		vector<double> times;
+		double total = 0.0;
+		for (int f = 0; f < frames; ++f) {
+			times.push_back(renderer.render(level));
+			total += times.back();
+		}
+		sort(times.begin(), times.end());
+
+		double mean = total / frames;
+		printf("%-4d %-32s %6d %6d %6.3f ms %6.3f ms %6.3f ms %6.3f ms %6.3f ms %7.1f\n", i + 1, level->get_level_name().substr(0, 32).c_str(),
+			FrameStats::get_draw_calls(), FrameStats::get_state_changes(), times.front(), times[frames / 2], mean,
+			times[(frames * 95) / 100], times.back(), 1000.0 / mean);
+
+		if (image != "-" && !renderer.write_image(hole == 0 ? hole_image_path(image, i + 1) : image)) {
+			return 1;
+		}
+	}
+
+	for (vector<Level*>::size_type i = 0; i < levels.size(); ++i) {
+		delete levels[i];
+	}
+	return 0;
+}
+
+int run_image_test(int argc, char **argv)
+{
+	if (argc < 3) {
+		cout << "usage: MiniGolf --image-test <course> <hole> <golden.tga> [failed.tga]" << endl;
+		return 1;
+	}
+
+	int hole = atoi(argv[1]);
+	int width, height, channels;
+	unsigned char *golden = SOIL_load_image(argv[2], &width, &height, &channels, SOIL_LOAD_RGBA);
+	if (!golden) {
+		cout << "error - could not read " << argv[2] << endl;
+		return 1;
+	}
+
+	OffscreenRenderer renderer(width, height);
+	if (!renderer.is_ready()) {
+		SOIL_free_image_data(golden);
+		return 1;
+	}
+
+	vector<Level*> levels = Level::load_levels(argv[0]);
+	if (hole < 1 || hole > (int)levels.size()) {
+		cout << "error - " << argv[0] << " has no hole " << hole << endl;
+		SOIL_free_image_data(golden);
+		return 1;
+	}
+
+	renderer.render(levels[hole - 1]);
+	vector<unsigned char> rgba;
+	renderer.read_pixels(rgba);
+
+	int differing = 0;
+	int largest = 0;
+	for (int i = 0; i < width * height; ++i) {
+		int pixel = 0;
+		for (int c = 0; c < 4; ++c) {
+			pixel = max(pixel, abs((int)rgba[i * 4 + c] - (int)golden[i * 4 + c]));
+		}
+		if (pixel > IMAGE_TEST_CHANNEL_TOLERANCE) {
+			++differing;
+		}
+		largest = max(largest, pixel);
+	}
+	SOIL_free_image_data(golden);
+
+	bool passed = differing <= (int)(IMAGE_TEST_PIXEL_TOLERANCE * width * height);
+	cout << (passed ? "passed" : "FAILED") << " - " << argv[0] << " hole " << hole << ": " << differing << " of " << width * height
+		<< " pixels differ by more than " << IMAGE_TEST_CHANNEL_TOLERANCE << " (largest difference " << largest << ")" << endl;
+
+	if (!passed && argc > 3) {
+		renderer.write_image(argv[3]);
+	}
+
+	for (vector<Level*>::size_type i = 0; i < levels.size(); ++i) {
+		delete levels[i];
+	}
+	return passed ? 0 : 1;
+}
\ No newline at end of file
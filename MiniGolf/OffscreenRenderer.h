@@ -0,0 +1,66 @@
+#ifndef OFFSCREEN_RENDERER_H
+#define OFFSCREEN_RENDERER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Level.h"
+
+using namespace std;
+
+static const int OFFSCREEN_WIDTH = 512; // Same as the game window.
+static const int OFFSCREEN_HEIGHT = 512;
+static const int OFFSCREEN_FRAMES = 100;
+static const int OFFSCREEN_WARMUP_FRAMES = 5; // Rendered but not timed, so shader compiles and first uploads stay out of the numbers.
+static const int IMAGE_TEST_CHANNEL_TOLERANCE = 8; // Drivers may shade or antialias an edge a few steps differently.
+static const double IMAGE_TEST_PIXEL_TOLERANCE = 0.005; // Share of pixels allowed past the channel tolerance.
+
+// Draws levels into a framebuffer object without a window, for golden image tests and render benchmarks
+// on machines without a display. Linux uses a surfaceless EGL context, which Mesa's llvmpipe provides
+// without a GPU; Windows uses a hidden freeglut window. GLEW must load through that context, so on
+// Linux link a GLEW built for EGL, or any GLEW whose GLX check runs after the core functions are loaded.
+class OffscreenRenderer
+{
+public:
+	OffscreenRenderer(int width = OFFSCREEN_WIDTH, int height = OFFSCREEN_HEIGHT);
+
+	~OffscreenRenderer();
+
+	bool is_ready() const; // False when no context or framebuffer could be made; the reason has been printed.
+
+	double render(Level *level); // Draws one frame and waits for it to finish. Milliseconds.
+
+	void read_pixels(vector<unsigned char> &rgba) const; // RGBA rows, top row first.
+
+	bool write_image(string path) const; // TGA for a .tga path, otherwise raw RGBA rows, top row first.
+
+private:
+	int width, height;
+	bool ready;
+	GLuint framebuffer;
+	GLuint renderbuffers[2]; // Colour, depth.
+	void *display; // EGLDisplay and EGLContext, kept opaque so only the .cpp needs the EGL headers.
+	void *context;
+	int window;
+
+	OffscreenRenderer(const OffscreenRenderer &);
+
+	OffscreenRenderer &operator=(const OffscreenRenderer &);
+
+	bool create_context();
+
+	void destroy_context();
+};
+
+// MiniGolf --render <course> [hole, 0 for all] [image.tga|image.raw|-] [frames] [width] [height] [eye x y z] [center x y z]
+// Renders a hole offscreen, writes the last frame and prints frame time statistics.
+int run_offscreen_renderer(int argc, char **argv);
+
+// MiniGolf --image-test <course> <hole> <golden.tga> [failed.tga]
+// Renders a hole at the golden image's size and compares the two; on a mismatch the render is written
+// to failed.tga when given. Make a golden image with --render <course> <hole> <golden.tga> 1 <width> <height>.
+int run_image_test(int argc, char **argv);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ParSolver.h"
+#include "Game.h"
+#include "Timer.h"
+
+// xorshift32, seeded from the hole and round so results do not depend on the number of threads.
+class SolverRandom
+{
+public:
+	SolverRandom(unsigned int hole, unsigned int round)
+	{
+		state = (hole + 1) * 0x9e3779b9u ^ (round + 1) * 0x85ebca6bu;
+		if (state == 0) {
+			state = 1;
+		}
+	}
+
+	float uniform() // [0, 1)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return (state >> 8) / 16777216.0f;
+	}
+
+	float gaussian()
+	{
+		float u = 1.0f - uniform();
+		float v = uniform();
+		return (float)(std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * PI * v));
+	}
+
+private:
+	unsigned int state;
+};
+
+ParSolver::ParSolver(string fname, JobSystem *jobs)
+{
+	this->jobs = jobs;
+	hole_count = 0;
+
+	ifstream in_file(fname);
+	if (!in_file.is_open()) {
+		cout << "error - unable to open " << fname << endl;
+		return;
+	}
+	stringstream text;
+	text << in_file.rdbuf();
+	source = text.str();
+
+	for (int i = 0; i < jobs->get_thread_count(); ++i) {
+		istringstream in(source);
+		vector<Level*> levels = Level::load_levels(in, jobs);
+		if (levels.empty()) {
+			return;
+		}
+		hole_count = levels.size();
+		idle.push_back(levels);
+	}
+}
+
+ParSolver::~ParSolver()
+{
+	for (vector<vector<Level*> >::size_type i = 0; i < idle.size(); ++i) {
+		for (vector<Level*>::size_type j = 0; j < idle[i].size(); ++j) {
+			delete idle[i][j];
+		}
+	}
+}
+
+int ParSolver::get_hole_count() const
+{
+	return hole_count;
+}
+
+vector<Level*> ParSolver::acquire_copy()
+{
+	{
+		lock_guard<mutex> lock(idle_lock);
+		if (!idle.empty()) {
+			vector<Level*> copy;
+			copy.swap(idle.back());
+			idle.pop_back();
+			return copy;
+		}
+	}
+
+	// More jobs at once than copies, as when threads outside the pool solve together. The course
+	// loaded in the constructor, so this one will too.
+	istringstream in(source);
+	return Level::load_levels(in, jobs);
+}
+
+void ParSolver::release_copy(vector<Level*> &copy)
+{
+	lock_guard<mutex> lock(idle_lock);
+	idle.push_back(vector<Level*>());
+	idle.back().swap(copy);
+}
+
+// The same steps Game::update takes for a shot from rest.
+ShotOutcome ParSolver::simulate_shot(Level *level, vec3 start, float angle, float power)
+{
+	Ball *ball = level->get_ball();
+	ball->reset(start);
+	level->set_ball_tile(start);
+	ball->add_force(vec3(sin(angle) * power, 0.0f, cos(angle) * power));
+
+	ShotOutcome outcome;
+	outcome.holed = false;
+
+	for (unsigned int step = 0; step < SOLVER_MAX_STEPS; ++step) {
+		level->step(PHYSICS_TIME_STEP);
+
+		if (level->ball_in_cup()) {
+			outcome.holed = true;
+			break;
+		}
+		if (!ball->is_active()) {
+			break;
+		}
+	}
+
+	outcome.end_position = ball->get_position();
+	outcome.in_bounds = outcome.holed || level->find_tile(outcome.end_position) != NULL;
+
+	return outcome;
+}
+
+// Strokes taken to hole out, or SOLVER_MAX_STROKES + 1 if the round is picked up.
+int ParSolver::play_round(Level *level, int hole, int round)
+{
+	SolverRandom random(hole, round);
+
+	level->reset_ball();
+	vec3 position = level->get_ball()->get_position();
+	vec3 cup = level->get_cup()->get_position();
+
+	for (int stroke = 1; stroke <= SOLVER_MAX_STROKES; ++stroke) {
+		float best_angle = 0.0f, best_power = 0.0f, best_distance = -1.0f;
+
+		for (int i = 0; i < SOLVER_CANDIDATES; ++i) {
+			float angle = (float)(random.uniform() * 2.0 * PI);
+			float power = (0.05f + 0.95f * random.uniform()) * SOLVER_MAX_POWER;
+
+			ShotOutcome outcome = simulate_shot(level, position, angle, power);
+			if (!outcome.in_bounds) {
+				continue;
+			}
+
+			float distance = outcome.holed ? 0.0f : length(outcome.end_position - cup);
+			if (best_distance < 0.0f || distance < best_distance) {
+				best_angle = angle;
+				best_power = power;
+				best_distance = distance;
+			}
+			if (outcome.holed) {
+				break;
+			}
+		}
+
+		if (best_distance < 0.0f) {
+			continue; // Nothing stayed on the course; the stroke is lost.
+		}
+
+		float angle = best_angle + SOLVER_ANGLE_NOISE * random.gaussian();
+		float power = best_power * (1.0f + SOLVER_POWER_NOISE * random.gaussian());
+
+		ShotOutcome outcome = simulate_shot(level, position, angle, power);
+		if (outcome.holed) {
+			return stroke;
+		}
+		if (outcome.in_bounds) {
+			position = outcome.end_position; // Otherwise replay from the same spot, a stroke down.
+		}
+	}
+
+	return SOLVER_MAX_STROKES + 1;
+}
+
+HoleEstimate ParSolver::solve(int hole, int rounds)
+{
+	HoleEstimate estimate;
+	estimate.heat_map.assign(SOLVER_ANGLES * SOLVER_POWERS, 0.0f);
+
+	vector<Level*> copy = acquire_copy();
+	Level *first = copy[hole];
+	estimate.name = first->get_level_name();
+	estimate.par = first->get_par();
+	first->reset_ball();
+	vec3 tee = first->get_ball()->get_position();
+	float tee_distance = length(first->get_cup()->get_position() - tee);
+	release_copy(copy);
+
+	// Heat map: a single shot from the tee for every cell.
+
+	vector<float> &heat_map = estimate.heat_map;
+	jobs->parallel_for(SOLVER_ANGLES * SOLVER_POWERS, SOLVER_ANGLES, [&](int begin, int end) {
+		vector<Level*> copy = acquire_copy();
+		Level *level = copy[hole];
+
+		for (int index = begin; index < end; ++index) {
+			float angle = (float)((index % SOLVER_ANGLES) * 2.0 * PI / SOLVER_ANGLES);
+			float power = (index / SOLVER_ANGLES + 1) * SOLVER_MAX_POWER / SOLVER_POWERS;
+
+			ShotOutcome outcome = simulate_shot(level, tee, angle, power);
+			if (outcome.holed) {
+				heat_map[index] = 1.0f;
+			}
+			else if (outcome.in_bounds && tee_distance > 0.0f) {
+				float gained = 1.0f - length(level->get_cup()->get_position() - outcome.end_position) / tee_distance;
+				heat_map[index] = gained > 0.0f ? 0.9f * gained : 0.0f; // Leave 1 for shots that hole out.
+			}
+		}
+
+		release_copy(copy);
+	});
+
+	// Rounds: strokes to hole out under the simulated player.
+	vector<int> strokes(rounds);
+	jobs->parallel_for(rounds, 1, [&](int begin, int end) {
+		vector<Level*> copy = acquire_copy();
+		Level *level = copy[hole];
+
+		for (int index = begin; index < end; ++index) {
+			strokes[index] = play_round(level, hole, index);
+		}
+
+		release_copy(copy);
+	});
+
+	estimate.strokes.assign(SOLVER_MAX_STROKES + 1, 0);
+	double total = 0.0;
+	for (int i = 0; i < rounds; ++i) {
+		estimate.strokes[strokes[i] - 1]++;
+		total += strokes[i];
+	}
+	estimate.expected_strokes = rounds > 0 ? total / rounds : 0.0;
+	estimate.suggested_par = (int)floor(estimate.expected_strokes + 0.5);
+
+	return estimate;
+}
+
+// Angle runs left to right from 0 to 2 pi, power bottom to top. Each cell is 4x4 pixels.
+bool ParSolver::write_heat_map_pgm(string fname, const HoleEstimate &estimate)
+{
+	ofstream out_file(fname.c_str(), ios::binary);
+	if (!out_file.is_open()) {
+		cout << "error - unable to open " << fname << " for writing." << endl;
+		return false;
+	}
+
+	const int scale = 4;
+	out_file << "P5\n" << SOLVER_ANGLES * scale << " " << SOLVER_POWERS * scale << "\n255\n";
+
+	for (int row = SOLVER_POWERS - 1; row >= 0; --row) {
+		string line;
+		for (int column = 0; column < SOLVER_ANGLES; ++column) {
+			char value = (char)(unsigned char)(estimate.heat_map[row * SOLVER_ANGLES + column] * 255.0f + 0.5f);
+			line.append(scale, value);
+		}
+		for (int i = 0; i < scale; ++i) {
+			out_file.write(line.data(), line.size());
+		}
+	}
+
+	return out_file.good();
+}
+
+bool ParSolver::write_heat_map_csv(string fname, const HoleEstimate &estimate)
+{
+	ofstream out_file(fname.c_str());
+	if (!out_file.is_open()) {
+		cout << "error - unable to open " << fname << " for writing." << endl;
+		return false;
+	}
+
+	out_file << "power\\angle";
+	for (int column = 0; column < SOLVER_ANGLES; ++column) {
+		out_file << "," << column * 360 / SOLVER_ANGLES;
+	}
+	out_file << "\n";
+
+	for (int row = 0; row < SOLVER_POWERS; ++row) {
+		out_file << (row + 1) * SOLVER_MAX_POWER / SOLVER_POWERS;
+		for (int column = 0; column < SOLVER_ANGLES; ++column) {
+			out_file << "," << estimate.heat_map[row * SOLVER_ANGLES + column];
+		}
+		out_file << "\n";
+	}
+
+	return out_file.good();
+}
+
+// Solves and prints every hole of a course on the given pool.
+static int solve_course(const char *fname, int rounds, string prefix, JobSystem *jobs)
+{
+	Timer timer;
+	timer.start();
+
+	ParSolver solver(fname, jobs);
+	if (solver.get_hole_count() == 0) {
+		return 1;
+	}
+
+	printf("%-4s %-32s %4s %8s %4s  strokes 1..%d, picked up\n", "hole", "name", "par", "expected", "est", SOLVER_MAX_STROKES);
+
+	for (int i = 0; i < solver.get_hole_count(); ++i) {
+		HoleEstimate estimate = solver.solve(i, rounds);
+
+		printf("%-4d %-32s %4s %8.2f %4d ", i + 1, estimate.name.substr(0, 32).c_str(), estimate.par.c_str(),
+			estimate.expected_strokes, estimate.suggested_par);
+		for (vector<int>::size_type j = 0; j < estimate.strokes.size(); ++j) {
+			printf(" %3.0f%%", 100.0 * estimate.strokes[j] / rounds);
+		}
+		printf("\n");
+
+		if (!prefix.empty()) {
+			char name[16];
+			sprintf(name, "%02d", i + 1);
+			ParSolver::write_heat_map_pgm(prefix + name + ".pgm", estimate);
+			ParSolver::write_heat_map_csv(prefix + name + ".csv", estimate);
+		}
+	}
+
+	printf("Solved %d holes in %.2f s\n", solver.get_hole_count(), timer.get_elapsed_time_in_sec());
+
+	return 0;
+}
+
+int run_par_solver(int argc, char **argv)
+{
+	if (argc < 1) {
+		cout << "usage: MiniGolf --solve-par <course> [rounds per hole] [heat map prefix] [threads]" << endl;
+		return 1;
+	}
+
+	int rounds = argc > 1 ? atoi(argv[1]) : SOLVER_ROLLOUTS;
+	string prefix = argc > 2 ? argv[2] : "";
+	int threads = argc > 3 ? atoi(argv[3]) : 0;
+
+	if (rounds < 1) {
+		cout << "error - need at least one round per hole." << endl;
+		return 1;
+	}
+
+	Object3D::set_headless(true);
+
+	// A thread count gets a pool of its own, stopped on the way out; the shared pool is never started.
+	if (threads > 0) {
+		JobSystem jobs(threads - 1);
+		return solve_course(argv[0], rounds, prefix, &jobs);
+	}
+	return solve_course(argv[0], rounds, prefix, JobSystem::get_instance());
+}
\ No newline at end of file
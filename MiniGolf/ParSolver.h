@@ -0,0 +1,84 @@
+#ifndef PAR_SOLVER_H
+#define PAR_SOLVER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include <glm/glm.hpp>
+
+#include "Level.h"
+#include "JobSystem.h"
+
+using namespace std;
+using namespace glm;
+
+static const int SOLVER_ANGLES = 72; // Heat map columns, 5 degrees apart.
+static const int SOLVER_POWERS = 32; // Heat map rows.
+static const float SOLVER_MAX_POWER = 8.0f; // About eight frames of a full-power hit.
+static const int SOLVER_ROLLOUTS = 256; // Simulated rounds per hole.
+static const int SOLVER_CANDIDATES = 32; // Shots a simulated player tries before committing to one.
+static const int SOLVER_MAX_STROKES = 8; // A round still out after this many strokes is picked up.
+static const unsigned int SOLVER_MAX_STEPS = 60 * 60; // Physics steps before a shot is called finished.
+static const float SOLVER_ANGLE_NOISE = 0.03f; // Standard deviation of the executed angle, radians.
+static const float SOLVER_POWER_NOISE = 0.05f; // Standard deviation of the executed power, relative.
+
+struct ShotOutcome {
+	vec3 end_position;
+	bool holed;
+	bool in_bounds;
+};
+
+struct HoleEstimate {
+	string name;
+	string par; // As written in the course file.
+	int suggested_par;
+	double expected_strokes;
+	vector<int> strokes; // Rounds finished in each number of strokes; the last entry counts picked-up rounds.
+	vector<float> heat_map; // SOLVER_POWERS rows of SOLVER_ANGLES, first shot from the tee: 1 holes out, 0 gains nothing.
+};
+
+// Estimates par by playing many simulated rounds of each hole on the headless physics core.
+// A simulated player tries random shots from where the ball lies, keeps the one that ends nearest
+// the cup and then plays it with some error. Every job borrows a copy of the course for itself, so any
+// threads, in or out of the pool, may solve at once.
+class ParSolver
+{
+public:
+	ParSolver(string fname, JobSystem *jobs = JobSystem::get_instance());
+
+	~ParSolver();
+
+	int get_hole_count() const;
+
+	HoleEstimate solve(int hole, int rounds = SOLVER_ROLLOUTS);
+
+	static bool write_heat_map_pgm(string fname, const HoleEstimate &estimate);
+
+	static bool write_heat_map_csv(string fname, const HoleEstimate &estimate);
+
+	static ShotOutcome simulate_shot(Level *level, vec3 start, float angle, float power);
+
+private:
+	JobSystem *jobs;
+	string source; // The course file's text, for copies made on demand.
+	int hole_count;
+	vector<vector<Level*> > idle; // Copies of the course no job is using; starts with one per pool thread.
+	mutex idle_lock;
+
+	ParSolver(const ParSolver &);
+
+	ParSolver &operator=(const ParSolver &);
+
+	vector<Level*> acquire_copy(); // A copy of the course for this caller alone; loads another if all are in use.
+
+	void release_copy(vector<Level*> &copy);
+
+	int play_round(Level *level, int hole, int round);
+};
+
+// MiniGolf --solve-par <course> [rounds per hole] [heat map prefix] [threads]
+int run_par_solver(int argc, char **argv);
+
+#endif
\ No newline at end of file
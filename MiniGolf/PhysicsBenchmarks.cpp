@@ -0,0 +1,261 @@
+#include <sstream>
+#include <algorithm>
+
+#include "PhysicsBenchmarks.h"
+#include "Benchmark.h"
+#include "CourseGenerator.h"
+#include "JobSystem.h"
+
+static const double BENCHMARK_TIME_STEP = 1.0 / 60.0;
+static const int SYNTHETIC_MIN_TILES = 10000; // Synthetic holes grow tenfold from here up to the largest.
+static const int SYNTHETIC_MAX_TILES = 500000; // Peaks under 500 MB in a 64-bit build, so it also fits a 32-bit process.
+static const int BATCH_HOLES = 4096; // Independent balls stepped together by the batch benchmark.
+static const int BATCH_GRAIN = 32; // Holes per job.
+
+static vector<Level*> batch;
+static JobSystem *batch_jobs = NULL;
+
+// A full-power shot straight at the cup.
+static vec3 aim_at_cup(Level *level)
+{
+	vec3 to_cup = level->get_cup()->get_position() - level->get_ball()->get_position();
+	to_cup.y = 0.0f;
+
+	if (dot(to_cup, to_cup) == 0.0f) {
+		return vec3(0.0f, 0.0f, -1.0f);
+	}
+	return normalize(to_cup);
+}
+
+// Whole shots through Level::step, as the game plays them.
+static void bm_level_step(BenchmarkState &state, Level *level)
+{
+	level->reset_ball();
+	vec3 shot = aim_at_cup(level);
+	level->get_ball()->add_force(shot);
+
+	while (state.keep_running()) {
+		level->step(BENCHMARK_TIME_STEP);
+
+		if (!level->get_ball()->is_active()) {
+			level->reset_ball();
+			level->get_ball()->add_force(shot);
+		}
+	}
+}
+
+// A ball on a bordered tile, moving so that it hits the first border halfway through the step.
+static void bm_collide_with_edge(BenchmarkState &state, Level *level)
+{
+	const vector<Tile*> &tiles = level->get_tiles();
+	Tile *tile = NULL;
+
+	for (vector<Tile*>::size_type i = 0; i < tiles.size() && !tile; ++i) {
+		if (!tiles[i]->get_borders().empty()) {
+			tile = tiles[i];
+		}
+	}
+	if (!tile) {
+		return;
+	}
+
+	const vector<vec3> &verts = tile->get_vertices();
+	vec3 center = vec3(0.0f);
+	for (vector<vec3>::size_type i = 0; i < verts.size(); ++i) {
+		center += verts[i];
+	}
+	center /= (float)verts.size();
+
+	Border *border = tile->get_borders()[0];
+	vec3 n = border->get_normal();
+	vec3 velocity = -(dot(n, center) + border->get_dist_from_origin()) * n / (float)(BENCHMARK_TIME_STEP / 2);
+
+	Ball *ball = level->get_ball();
+	ball->set_current_tile(tile);
+
+	while (state.keep_running()) {
+		ball->reset(center);
+		ball->set_velocity(velocity);
+		ball->collide_with_edge(BENCHMARK_TIME_STEP);
+	}
+}
+
+static void bm_set_ball_tile(BenchmarkState &state, Level *level)
+{
+	level->reset_ball();
+	vec3 point = level->get_ball()->get_position();
+
+	while (state.keep_running()) {
+		level->set_ball_tile(point);
+	}
+	state.set_items_processed(state.get_iterations() * level->get_tiles().size());
+}
+
+static void bm_isect_sphere_plane(BenchmarkState &state, Level *level)
+{
+	Tile *tile = level->get_tiles()[0];
+	vec3 n = tile->get_normal();
+	const vector<vec3> &verts = tile->get_vertices();
+
+	while (state.keep_running()) {
+		Benchmark::keep(PhysicsObject::isect_sphere_plane(vec3(0.0f, 1.0f, 0.0f), 0.05f, vec3(0.1f, -1.0f, 0.2f), n, verts));
+	}
+}
+
+static void bm_isect_sphere_plane_distance(BenchmarkState &state, Level *level)
+{
+	Tile *tile = level->get_tiles()[0];
+	vec3 n = tile->get_normal();
+	float d = tile->get_dist_from_origin();
+
+	while (state.keep_running()) {
+		Benchmark::keep(PhysicsObject::isect_sphere_plane(vec3(0.0f, 1.0f, 0.0f), 0.05f, vec3(0.1f, -1.0f, 0.2f), n, d));
+	}
+}
+
+// Pure vector math, so it ignores the hole it is run on.
+static void bm_plane_reflection_velocity(BenchmarkState &state, Level *)
+{
+	vec3 n = normalize(vec3(1.0f, 0.0f, 1.0f));
+	vec3 velocity = vec3(0.3f, 0.0f, -0.7f);
+
+	while (state.keep_running()) {
+		velocity = PhysicsObject::plane_reflection_velocity(velocity, n);
+	}
+
+	Benchmark::keep(velocity.x);
+}
+
+// One fixed step of every hole in the batch per iteration, spread over batch_jobs. Runs on the batch, not a given hole.
+static void bm_batch_step(BenchmarkState &state, Level *)
+{
+	batch_jobs->parallel_for(batch.size(), BATCH_GRAIN, [](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			batch[i]->reset_ball();
+			batch[i]->get_ball()->add_force(aim_at_cup(batch[i]) * 4.0f);
+		}
+	});
+
+	while (state.keep_running()) {
+		batch_jobs->parallel_for(batch.size(), BATCH_GRAIN, [](int begin, int end) {
+			for (int i = begin; i < end; ++i) {
+				Level *hole = batch[i];
+				hole->step(BENCHMARK_TIME_STEP);
+
+				if (!hole->get_ball()->is_active()) {
+					hole->reset_ball();
+					hole->get_ball()->add_force(aim_at_cup(hole) * 4.0f);
+				}
+			}
+		});
+	}
+	state.set_items_processed(state.get_iterations() * batch.size());
+}
+
+// The batch at 1, 2, 4, ... threads up to every core, to show how the job system scales.
+static void run_batch()
+{
+	istringstream course(CourseGenerator(BATCH_HOLES, 100, 0.2f, 0.1f).to_string());
+	batch = Level::load_levels(course);
+
+	int cores = thread::hardware_concurrency();
+	if (cores < 1) {
+		cores = 1;
+	}
+	for (int threads = 1; ; threads *= 2) {
+		if (threads > cores) {
+			threads = cores;
+		}
+
+		JobSystem jobs(threads - 1);
+		batch_jobs = &jobs;
+
+		ostringstream name;
+		name << "batch/" << BATCH_HOLES << "/threads:" << threads;
+		Benchmark::run(name.str(), bm_batch_step, NULL);
+
+		batch_jobs = NULL;
+
+		if (threads >= cores) {
+			break;
+		}
+	}
+
+	for (vector<Level*>::size_type i = 0; i < batch.size(); ++i) {
+		delete batch[i];
+	}
+	batch.clear();
+}
+
+static void run_course(string name, Level *level)
+{
+	Benchmark::run(name + "/step", bm_level_step, level);
+	Benchmark::run(name + "/collide_with_edge", bm_collide_with_edge, level);
+	Benchmark::run(name + "/set_ball_tile", bm_set_ball_tile, level);
+	Benchmark::run(name + "/isect_sphere_plane", bm_isect_sphere_plane, level);
+	Benchmark::run(name + "/isect_sphere_plane_distance", bm_isect_sphere_plane_distance, level);
+	Benchmark::run(name + "/plane_reflection_velocity", bm_plane_reflection_velocity, level);
+}
+
+static void free_levels(vector<Level*> &levels)
+{
+	for (vector<Level*>::size_type i = 0; i < levels.size(); ++i) {
+		delete levels[i];
+	}
+	levels.clear();
+}
+
+int run_physics_benchmarks(int argc, char **argv)
+{
+	string directory = argc > 0 ? argv[0] : "data";
+	int max_tiles = argc > 1 ? atoi(argv[1]) : SYNTHETIC_MAX_TILES;
+
+	if (max_tiles < 1) {
+		cout << "usage: MiniGolf --bench [data directory] [tiles in the largest synthetic hole]" << endl;
+		return 1;
+	}
+
+	Object3D::set_headless(true);
+
+	Benchmark::print_header("step");
+
+	vector<string> courses = Benchmark::list_courses(directory);
+	for (vector<string>::size_type i = 0; i < courses.size(); ++i) {
+		vector<Level*> levels = Level::load_levels(courses[i]);
+
+		if (levels.empty()) {
+			printf("%-52s skipped, not a course file\n", courses[i].c_str());
+			continue;
+		}
+
+		// The whole suite on the first hole, and whole shots on every other hole.
+		run_course(courses[i] + "/1", levels[0]);
+
+		for (vector<Level*>::size_type j = 1; j < levels.size(); ++j) {
+			ostringstream name;
+			name << courses[i] << "/" << j + 1;
+			Benchmark::run(name.str() + "/step", bm_level_step, levels[j]);
+		}
+
+		free_levels(levels);
+	}
+
+	for (int tiles = min(SYNTHETIC_MIN_TILES, max_tiles); ; tiles = min(tiles * 10, max_tiles)) {
+		istringstream course(CourseGenerator(1, tiles).to_string());
+		vector<Level*> levels = Level::load_levels(course);
+
+		ostringstream name;
+		name << "synthetic/" << tiles;
+		run_course(name.str(), levels[0]);
+
+		free_levels(levels);
+
+		if (tiles >= max_tiles) {
+			break;
+		}
+	}
+
+	run_batch();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#ifndef PHYSICS_BENCHMARKS_H
+#define PHYSICS_BENCHMARKS_H
+
+// MiniGolf --bench [data directory] [tiles in the largest synthetic hole]
+// Runs the headless physics benchmarks over every course in the directory and over synthetic holes of
+// 10k tiles, growing tenfold up to the largest (500k unless given).
+int run_physics_benchmarks(int argc, char **argv);
+
+#endif
\ No newline at end of file
@@ -4,10 +4,8 @@
 PhysicsObject::PhysicsObject()
 {
 	velocity = vec3(0.0f); // No initial velocity.
+	force = vec3(0.0f);
 	angle = (float)2.5; // Starting at about a 45 degree angle.
-
-	timer.start(); // Start the timer.
-	last_time = timer.get_elapsed_time_in_sec(); // Set the initial time step.
 }
 
 
@@ -23,13 +21,13 @@ void PhysicsObject::set_velocity(vec3 v)
 
 void PhysicsObject::add_force(vec3 f)
 {
-	forces.push(f); // Add force to queue.
+	force += f; // Accumulate until the next step.
 }
 
 void PhysicsObject::add_force()
 {
 	vec3 f = vec3(18.f, 0.0f, -21.f);
- 	forces.push(f);
+ 	force += f;
 }
 
 vec3 PhysicsObject::euler_integration(vec3 position, vec3 velocity, float t)
@@ -52,8 +50,6 @@ vec3 PhysicsObject::plane_reflection_velocity(vec3 velocity, vec3 plane_normal)
 	vec3 d = normalize(velocity);
 	float magnitude = (float)glm::sqrt(dot(velocity, velocity));
 
-	cout << "Reflection Magnitude: " << magnitude << endl;
-
 	// r = 2(n dot -l)n + l
 	vec3 reflect = 2 * dot(plane_normal, -d) * plane_normal + d;
 
@@ -61,15 +57,15 @@ vec3 PhysicsObject::plane_reflection_velocity(vec3 velocity, vec3 plane_normal)
 }
 
 // Calculate the time of sphere-plane intersection.
-float PhysicsObject::isect_sphere_plane(vec3 s_pos, float s_rad, vec3 s_vel, vec3 plane_normal, vector<vec3> plane_vertices)
+float PhysicsObject::isect_sphere_plane(vec3 s_pos, float s_rad, vec3 s_vel, vec3 plane_normal, const vector<vec3> &plane_vertices)
 {
-	vec3 sphere_plane_offset = s_rad * plane_normal;
-
-	for (vector<vec3>::size_type i = 0; i < plane_vertices.size(); ++i) {
-		plane_vertices[i] += sphere_plane_offset;
-	}
+	return isect_sphere_plane(s_pos, s_rad, s_vel, plane_normal, -dot(plane_normal, plane_vertices[0]));
+}
 
-	float offset_plane_distance = -dot(plane_normal, plane_vertices[0]);
+// Offsetting the plane by the radius along its normal only shifts its distance term.
+float PhysicsObject::isect_sphere_plane(vec3 s_pos, float s_rad, vec3 s_vel, vec3 plane_normal, float plane_distance)
+{
+	float offset_plane_distance = plane_distance - s_rad;
 
 	return -(dot(plane_normal, s_pos) + offset_plane_distance) / dot(s_vel, plane_normal);
 }
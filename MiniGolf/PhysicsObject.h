@@ -1,11 +1,10 @@
 #ifndef PHYSICS_OBJECT_H
 #define PHYSICS_OBJECT_H
 
-#include <queue>
-#include <glm\glm.hpp>
-
-#include "Timer.h"
+#include <vector>
+#include <glm/glm.hpp>
 
+using namespace std;
 using namespace glm;
 
 class PhysicsObject
@@ -13,8 +12,6 @@ class PhysicsObject
 public:
 	PhysicsObject(); // Constructor.
 
-	virtual void run_simulation() = 0; // Every physics object must have a simulation.
-
 	vec3 get_velocity();
 
 	void set_velocity(vec3 v);
@@ -31,7 +28,9 @@ public:
 
 	static vec3 plane_reflection_velocity(vec3 velocity, vec3 plane_normal); // Get the reflection vector.
 
-	static float isect_sphere_plane(vec3 s_pos, float s_rad, vec3 s_vel, vec3 plane_normal, vector<vec3> plane_vertices); // Sphere-Plane intersection test.
+	static float isect_sphere_plane(vec3 s_pos, float s_rad, vec3 s_vel, vec3 plane_normal, const vector<vec3> &plane_vertices); // Sphere-Plane intersection test.
+
+	static float isect_sphere_plane(vec3 s_pos, float s_rad, vec3 s_vel, vec3 plane_normal, float plane_distance); // Same, with the plane given as n.p + d = 0.
 
 	static bool isect_sphere_sphere(vec3 p1, float r1, vec3 p2, float r2);
 
@@ -40,12 +39,8 @@ public:
 protected:
 	// Physics members.
 	vec3 velocity;
-	queue<vec3> forces; // Accumulate forces.
+	vec3 force; // Net force accumulated since the last step.
 	float angle; // Angle of this object.
-
-	// Timimg members.
-	Timer timer; // This physics objects timer.
-	double last_time; // The last time step.
 };
 
 #endif
\ No newline at end of file
@@ -1,8 +1,9 @@
 #include "Plane.h"
+#include "FrameStats.h"
 
 Plane::Plane() {}
 
-Plane::Plane(int id, vec3 position, vector<vec3> verts) : Object3D(id, position)
+Plane::Plane(int id, vec3 position, vector<vec3> verts, Arena *arena) : Object3D(id, position, arena)
 {
 	vertices = verts;
 
@@ -10,12 +11,16 @@ Plane::Plane(int id, vec3 position, vector<vec3> verts) : Object3D(id, position)
 
 	calc_min_max();
 
+	calc_gravity();
+
 	dist_from_origin = -dot(normal, vertices[0]);
 
-	init_gl();
+	if (!headless) {
+		init_gl();
+	}
 }
 
-Plane::Plane(int id, vec3 position) : Object3D(id, position) {}
+Plane::Plane(int id, vec3 position, Arena *arena) : Object3D(id, position, arena) {}
 
 void Plane::calc_min_max()
 {
@@ -44,7 +49,10 @@ void Plane::calc_min_max()
 			max_vec.z = v.z;
 		}
 	}
+}
 
+void Plane::calc_gravity()
+{
 	if (min_vec.y == max_vec.y) {
 		direction_gravity = vec3(0.0f);
 		is_sloped = false;
@@ -55,6 +63,12 @@ void Plane::calc_min_max()
 	}
 }
 
+void Plane::get_bounds(vec3 &min, vec3 &max) const
+{
+	min = min_vec;
+	max = max_vec;
+}
+
 bool Plane::point_in_plane(vec3 point)
 {
 	if (point.x < min_vec.x  || point.z < min_vec.z || point.x > max_vec.x || point.z > max_vec.z) {
@@ -63,50 +77,35 @@ bool Plane::point_in_plane(vec3 point)
 	return true;
 }
 
-void Plane::draw(Camera *camera, Light *light)
+void Plane::draw_geometry() const
 {
-	shader->use();
-
-	glBindVertexArray(vao_handle);
-
-	shader->set_uniforms(camera, light, material, mat4(1.0f));
-
-	glDrawArrays(GL_POLYGON, 0, vertices.size());
-
-	glBindVertexArray(0);
+	glDrawArrays(GL_POLYGON, geometry.first_vertex, geometry.vertex_count);
+	FrameStats::count_draw_call();
 }
 
 void Plane::init_gl()
 {
-	vector<float> vertex_indices;
+	init_gl(vector<vec3>(vertices.size(), normal));
+}
 
+void Plane::init_gl(const vector<vec3> &vertex_normals)
+{
+	vector<Vertex> data(vertices.size());
 	for (vector<vec3>::size_type i = 0; i < vertices.size(); ++i) {
-		vertex_indices.push_back(vertices[i].x);
-		vertex_indices.push_back(vertices[i].y);
-		vertex_indices.push_back(vertices[i].z);
+		Vertex &v = data[i];
+		v.position[0] = vertices[i].x;
+		v.position[1] = vertices[i].y;
+		v.position[2] = vertices[i].z;
+		v.normal[0] = vertex_normals[i].x;
+		v.normal[1] = vertex_normals[i].y;
+		v.normal[2] = vertex_normals[i].z;
+		v.uv[0] = v.uv[1] = 0.0f;
 	}
 
-	glGenVertexArrays(1, &vao_handle);
-	glBindVertexArray(vao_handle);
-
-	unsigned int handle[2];
-	glGenBuffers(2, handle);
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle[0]);
-	glBufferData(GL_ARRAY_BUFFER, vertex_indices.size() * sizeof(float), &vertex_indices[0], GL_STATIC_DRAW);
-	glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
-	glEnableVertexAttribArray(0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, handle[1]);
-	float n[3] = { normal.x, normal.y, normal.z };
-	glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(float), n, GL_STATIC_DRAW);
-	glVertexAttribPointer((GLuint)1, 3, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
-	glEnableVertexAttribArray(1);
-
-	glBindVertexArray(0);
+	upload(data, vector<GLuint>());
 }
 
-vector<vec3> Plane::get_vertices()
+const vector<vec3> &Plane::get_vertices() const
 {
 	return vertices;
 }
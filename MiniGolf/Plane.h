@@ -2,7 +2,7 @@
 #define PLANE_H
 
 #include <vector>
-#include <glm\glm.hpp>
+#include <glm/glm.hpp>
 
 #include "Object3D.h"
 #include "PhysicsObject.h"
@@ -15,13 +15,15 @@ class Plane : public Object3D
 public:
 	Plane();
 
-	Plane(int id, vec3 position, vector<vec3> verts);
+	Plane(int id, vec3 position, vector<vec3> verts, Arena *arena);
 
-	Plane(int id, vec3 position);
+	Plane(int id, vec3 position, Arena *arena);
 
-	virtual void draw(Camera *camera, Light *light);
+	virtual void draw_geometry() const;
 
-	vector<vec3> get_vertices();
+	virtual void get_bounds(vec3 &min, vec3 &max) const;
+
+	const vector<vec3> &get_vertices() const;
 
 	vec3 get_normal();
 
@@ -52,9 +54,13 @@ protected:
 
 	vec3 calculate_normal();
 
-	void init_gl();
+	void init_gl(); // Every vertex gets the plane's normal.
+
+	void init_gl(const vector<vec3> &vertex_normals); // One normal per vertex, for objects made of several faces.
 
 	void calc_min_max();
+
+	void calc_gravity(); // Needs min_vec and max_vec.
 };
 
 #endif
\ No newline at end of file
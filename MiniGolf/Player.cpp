@@ -1 +1,53 @@
-#include "Player.h"
\ No newline at end of file
+#include "Player.h"
+
+Player::Player(string name, int holes)
+{
+	this->name = name;
+	strokes.assign(holes, 0);
+	lie = vec3(0.0f);
+	holed = false;
+}
+
+string Player::get_name() const
+{
+	return name;
+}
+
+int Player::get_strokes(int hole) const
+{
+	return strokes.at(hole);
+}
+
+int Player::get_total() const
+{
+	int total = 0;
+	for (vector<int>::size_type i = 0; i < strokes.size(); ++i) {
+		total += strokes[i];
+	}
+	return total;
+}
+
+void Player::add_stroke(int hole)
+{
+	strokes.at(hole)++;
+}
+
+vec3 Player::get_lie() const
+{
+	return lie;
+}
+
+void Player::set_lie(vec3 lie)
+{
+	this->lie = lie;
+}
+
+bool Player::is_holed() const
+{
+	return holed;
+}
+
+void Player::set_holed(bool h)
+{
+	holed = h;
+}
\ No newline at end of file
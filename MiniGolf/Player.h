@@ -1,8 +1,39 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
 class Player {
+public:
+	Player(string name, int holes);
+
+	string get_name() const;
+
+	int get_strokes(int hole) const;
+
+	int get_total() const;
+
+	void add_stroke(int hole);
+
+	vec3 get_lie() const; // Where the ball rests between this player's turns.
+
+	void set_lie(vec3 lie);
+
+	bool is_holed() const; // Finished the current hole, in the cup or picked up.
+
+	void set_holed(bool h);
 
+private:
+	string name;
+	vector<int> strokes; // Per hole.
+	vec3 lie;
+	bool holed;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,292 @@
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "Profiler.h"
+
+#ifdef _MSC_VER
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILER_THREAD_LOCAL __thread
+#endif
+
+static PROFILER_THREAD_LOCAL ProfileRing *thread_ring = NULL;
+
+ProfileRing::ProfileRing(unsigned int thread_id) : head(0)
+{
+	this->thread_id = thread_id;
+
+	for (unsigned int i = 0; i < PROFILER_RING_SIZE; ++i) {
+		slots[i].sequence.store(0, memory_order_relaxed);
+	}
+}
+
+void ProfileRing::push(const ProfileEvent &event)
+{
+	unsigned int h = head.load(memory_order_relaxed);
+	Slot &slot = slots[h & (PROFILER_RING_SIZE - 1)];
+
+	slot.sequence.store(2 * h + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release); // The odd sequence is visible before any field changes.
+	slot.name.store(event.name, memory_order_relaxed);
+	slot.begin.store(event.begin, memory_order_relaxed);
+	slot.end.store(event.end, memory_order_relaxed);
+	slot.gpu.store(event.gpu, memory_order_relaxed);
+	slot.sequence.store(2 * h + 2, memory_order_release);
+
+	head.store(h + 1, memory_order_release);
+}
+
+void ProfileRing::copy_events(vector<ProfileEvent> &out) const
+{
+	unsigned int h = head.load(memory_order_acquire);
+	unsigned int count = h < PROFILER_RING_SIZE ? h : PROFILER_RING_SIZE;
+
+	for (unsigned int i = h - count; i != h; ++i) {
+		const Slot &slot = slots[i & (PROFILER_RING_SIZE - 1)];
+		unsigned int complete = 2 * i + 2;
+
+		if (slot.sequence.load(memory_order_acquire) != complete) {
+			continue; // Already overwritten by a newer event.
+		}
+
+		ProfileEvent event;
+		event.name = slot.name.load(memory_order_relaxed);
+		event.begin = slot.begin.load(memory_order_relaxed);
+		event.end = slot.end.load(memory_order_relaxed);
+		event.gpu = slot.gpu.load(memory_order_relaxed);
+
+		atomic_thread_fence(memory_order_acquire); // The fields are read before the sequence is checked again.
+		if (slot.sequence.load(memory_order_relaxed) != complete) {
+			continue; // Overwritten while it was copied; the fields may be torn.
+		}
+
+		out.push_back(event);
+	}
+}
+
+unsigned int ProfileRing::get_thread_id() const
+{
+	return thread_id;
+}
+
+bool Profiler::enabled = true;
+bool Profiler::gpu_enabled = false;
+mutex Profiler::rings_mutex;
+vector<ProfileRing*> Profiler::rings;
+GLuint Profiler::queries[PROFILER_FRAME_LATENCY][PROFILER_QUERIES_PER_FRAME];
+vector<Profiler::GpuZone> Profiler::gpu_zones[PROFILER_FRAME_LATENCY];
+int Profiler::gpu_frame = 0;
+bool Profiler::gpu_frame_busy = false;
+int Profiler::queries_used = 0;
+long long Profiler::gpu_offset = 0;
+
+bool Profiler::is_enabled()
+{
+	return enabled;
+}
+
+void Profiler::set_enabled(bool e)
+{
+	enabled = e;
+}
+
+void Profiler::set_gpu_enabled(bool e)
+{
+	if (e && !gpu_enabled) {
+		for (int i = 0; i < PROFILER_FRAME_LATENCY; ++i) {
+			glGenQueries(PROFILER_QUERIES_PER_FRAME, queries[i]);
+			gpu_zones[i].reserve(PROFILER_QUERIES_PER_FRAME / 2);
+		}
+
+		GLint64 gpu_now;
+		glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+		gpu_offset = now() - gpu_now;
+	}
+	gpu_enabled = e;
+}
+
+long long Profiler::now()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency = { 0 };
+	if (!frequency.QuadPart) {
+		QueryPerformanceFrequency(&frequency);
+	}
+
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+
+	// Split the conversion so the multiplication cannot overflow.
+	long long seconds = count.QuadPart / frequency.QuadPart;
+	long long remainder = count.QuadPart % frequency.QuadPart;
+	return seconds * 1000000000LL + remainder * 1000000000LL / frequency.QuadPart;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000000000LL + t.tv_nsec;
+#endif
+}
+
+// The first event on a thread registers its ring; after that recording takes no locks.
+ProfileRing *Profiler::get_ring()
+{
+	if (!thread_ring) {
+		lock_guard<mutex> lock(rings_mutex);
+		thread_ring = new ProfileRing(rings.size() + 1);
+		rings.push_back(thread_ring);
+	}
+	return thread_ring;
+}
+
+void Profiler::record(const char *name, long long begin, long long end)
+{
+	ProfileEvent event;
+	event.name = name;
+	event.begin = begin;
+	event.end = end;
+	event.gpu = false;
+
+	get_ring()->push(event);
+}
+
+int Profiler::begin_gpu_zone()
+{
+	if (!gpu_enabled || gpu_frame_busy || queries_used + 2 > PROFILER_QUERIES_PER_FRAME) {
+		return -1;
+	}
+
+	int slot = queries_used;
+	queries_used += 2;
+
+	glQueryCounter(queries[gpu_frame][slot], GL_TIMESTAMP);
+
+	return slot;
+}
+
+void Profiler::end_gpu_zone(const char *name, int slot)
+{
+	glQueryCounter(queries[gpu_frame][slot + 1], GL_TIMESTAMP);
+
+	GpuZone zone;
+	zone.name = name;
+	zone.slot = slot;
+	gpu_zones[gpu_frame].push_back(zone);
+}
+
+void Profiler::end_frame()
+{
+	if (!gpu_enabled) {
+		return;
+	}
+
+	// Oldest frame first. Whatever the GPU has not finished stays for a later frame instead of stalling this one.
+	for (int i = 1; i <= PROFILER_FRAME_LATENCY; ++i) {
+		resolve_gpu_zones((gpu_frame + i) % PROFILER_FRAME_LATENCY);
+	}
+
+	gpu_frame = (gpu_frame + 1) % PROFILER_FRAME_LATENCY;
+	gpu_frame_busy = !gpu_zones[gpu_frame].empty();
+	queries_used = 0;
+}
+
+void Profiler::resolve_gpu_zones(int frame)
+{
+	vector<GpuZone> &zones = gpu_zones[frame];
+
+	vector<GpuZone>::size_type resolved = 0;
+	for (; resolved < zones.size(); ++resolved) {
+		// Zones are kept in the order they ended, which is the order the GPU finishes their queries.
+		GLint available = 0;
+		glGetQueryObjectiv(queries[frame][zones[resolved].slot + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			break;
+		}
+
+		GLuint64 begin, end;
+		glGetQueryObjectui64v(queries[frame][zones[resolved].slot], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(queries[frame][zones[resolved].slot + 1], GL_QUERY_RESULT, &end);
+
+		ProfileEvent event;
+		event.name = zones[resolved].name;
+		event.begin = (long long)begin + gpu_offset;
+		event.end = (long long)end + gpu_offset;
+		event.gpu = true;
+
+		get_ring()->push(event);
+	}
+
+	zones.erase(zones.begin(), zones.begin() + resolved);
+}
+
+// Chrome's about:tracing format. GPU zones get a track of their own.
+bool Profiler::write_chrome_trace(string fname)
+{
+	vector<ProfileEvent> events;
+	vector<unsigned int> threads;
+	{
+		lock_guard<mutex> lock(rings_mutex);
+		for (vector<ProfileRing*>::size_type i = 0; i < rings.size(); ++i) {
+			rings[i]->copy_events(events);
+			threads.resize(events.size(), rings[i]->get_thread_id());
+		}
+	}
+
+	FILE *out = fopen(fname.c_str(), "w");
+	if (!out) {
+		printf("error - unable to open %s for writing.\n", fname.c_str());
+		return false;
+	}
+
+	long long origin = 0;
+	for (vector<ProfileEvent>::size_type i = 0; i < events.size(); ++i) {
+		if (i == 0 || events[i].begin < origin) {
+			origin = events[i].begin;
+		}
+	}
+
+	fprintf(out, "{\"traceEvents\":[\n");
+	fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}");
+
+	for (vector<ProfileEvent>::size_type i = 0; i < events.size(); ++i) {
+		const ProfileEvent &e = events[i];
+		fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			e.name, e.gpu ? 0 : threads[i], (e.begin - origin) / 1000.0, (e.end - e.begin) / 1000.0);
+	}
+
+	fprintf(out, "\n]}\n");
+	fclose(out);
+
+	printf("Wrote %u profile events to %s\n", (unsigned int)events.size(), fname.c_str());
+
+	return true;
+}
+
+ProfileZone::ProfileZone(const char *name, bool gpu)
+{
+	if (!Profiler::is_enabled()) {
+		this->name = NULL;
+		return;
+	}
+
+	this->name = name;
+	gpu_slot = gpu ? Profiler::begin_gpu_zone() : -1;
+	begin = Profiler::now();
+}
+
+ProfileZone::~ProfileZone()
+{
+	if (!name) {
+		return;
+	}
+
+	Profiler::record(name, begin, Profiler::now());
+
+	if (gpu_slot >= 0) {
+		Profiler::end_gpu_zone(name, gpu_slot);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <GL/glew.h>
+
+using namespace std;
+
+static const unsigned int PROFILER_RING_SIZE = 1 << 15; // Events kept per thread; must be a power of two.
+static const int PROFILER_FRAME_LATENCY = 4; // Frames of GPU timestamps in flight; results are read back once available.
+static const int PROFILER_QUERIES_PER_FRAME = 2048; // GPU zones beyond this in a frame are CPU-only.
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+// Time the rest of the enclosing scope. name must be a string literal.
+#define PROFILE_ZONE(name) ProfileZone PROFILER_CONCAT(profile_zone_, __LINE__)(name, false)
+
+// Same, and also time the GL commands issued in the scope. Only use on the GL thread.
+#define PROFILE_GPU_ZONE(name) ProfileZone PROFILER_CONCAT(profile_zone_, __LINE__)(name, true)
+
+struct ProfileEvent {
+	const char *name;
+	long long begin; // Nanoseconds on the CPU clock.
+	long long end;
+	bool gpu;
+};
+
+// Written only by its own thread; old events are overwritten. Each slot is a seqlock, so a reader on
+// another thread never takes an event the owner was overwriting while it was copied.
+class ProfileRing
+{
+public:
+	ProfileRing(unsigned int thread_id);
+
+	void push(const ProfileEvent &event);
+
+	void copy_events(vector<ProfileEvent> &out) const; // Skips events overwritten before or while they were read.
+
+	unsigned int get_thread_id() const;
+
+private:
+	struct Slot {
+		atomic<unsigned int> sequence; // 2n + 1 while event n is written into it, 2n + 2 once it is complete.
+		atomic<const char*> name;
+		atomic<long long> begin;
+		atomic<long long> end;
+		atomic<bool> gpu;
+	};
+
+	Slot slots[PROFILER_RING_SIZE];
+	atomic<unsigned int> head; // Total events ever pushed.
+	unsigned int thread_id;
+};
+
+class Profiler
+{
+public:
+	static bool is_enabled();
+
+	static void set_enabled(bool e);
+
+	static void set_gpu_enabled(bool e); // Needs a current GL context with timer queries.
+
+	static long long now(); // CPU clock in nanoseconds.
+
+	static void record(const char *name, long long begin, long long end);
+
+	static int begin_gpu_zone(); // Returns a query slot, or -1 when GPU timing is unavailable.
+
+	static void end_gpu_zone(const char *name, int slot);
+
+	static void end_frame(); // Call once per frame on the GL thread, after the swap. Never waits for the GPU.
+
+	static bool write_chrome_trace(string fname);
+
+private:
+	struct GpuZone {
+		const char *name;
+		int slot;
+	};
+
+	static bool enabled;
+	static bool gpu_enabled;
+
+	static mutex rings_mutex;
+	static vector<ProfileRing*> rings;
+
+	static GLuint queries[PROFILER_FRAME_LATENCY][PROFILER_QUERIES_PER_FRAME];
+	static vector<GpuZone> gpu_zones[PROFILER_FRAME_LATENCY]; // Zones whose timestamps have not been read back.
+	static int gpu_frame;
+	static bool gpu_frame_busy; // The frame's queries still hold unread results, so it times nothing on the GPU.
+	static int queries_used;
+	static long long gpu_offset; // Added to GPU timestamps to put them on the CPU clock.
+
+	static ProfileRing *get_ring();
+
+	static void resolve_gpu_zones(int frame); // Reads back the zones the GPU has finished, in order.
+};
+
+class ProfileZone
+{
+public:
+	ProfileZone(const char *name, bool gpu);
+
+	~ProfileZone();
+
+private:
+	const char *name;
+	long long begin;
+	int gpu_slot;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "RenderQueue.h"
+#include "Profiler.h"
+#include "GLState.h"
+
+#include <algorithm>
+
+bool DrawCommand::operator<(const DrawCommand &other) const
+{
+	return key < other.key;
+}
+
+void RenderQueue::submit(Object3D *object)
+{
+	DrawCommand command;
+	command.key = 0;
+	command.program = find_program(object->get_shader());
+	command.material = object->get_material();
+	command.object = object;
+	commands.push_back(command);
+}
+
+// Shaders are shared, so there are only ever a handful to scan.
+int RenderQueue::find_program(Shader *shader)
+{
+	for (vector<Shader*>::size_type i = 0; i < programs.size(); ++i) {
+		if (programs[i] == shader) {
+			return (int)i;
+		}
+	}
+	programs.push_back(shader);
+	return (int)programs.size() - 1;
+}
+
+void RenderQueue::flush(Camera *camera, Light *light)
+{
+	PROFILE_GPU_ZONE("RenderQueue::flush");
+
+	mat4 view = camera->get_view();
+	for (vector<DrawCommand>::size_type i = 0; i < commands.size(); ++i) {
+		DrawCommand &c = commands[i];
+
+		vec3 min, max;
+		c.object->get_bounds(min, max);
+		float depth = -(view * vec4((min + max) * 0.5f, 1.0f)).z;
+		unsigned long long quantized = (unsigned long long)(clamp(depth / RENDER_QUEUE_DEPTH_RANGE, 0.0f, 1.0f) * 0xFFFF);
+
+		c.key = ((unsigned long long)(c.program & 0xFF) << 45) |
+			((unsigned long long)(c.object->culls_back_faces() ? 1 : 0) << 44) |
+			((unsigned long long)(c.object->get_vao() & 0xFFFFF) << 24) |
+			((unsigned long long)(c.material & 0xFF) << 16) |
+			quantized;
+	}
+	sort(commands.begin(), commands.end());
+
+	MaterialTable::bind();
+
+	// Other drawing between flushes may change any of this, so nothing is assumed from the last frame.
+	int program = -1, material = -1;
+	GLuint vao = 0;
+	bool cull = false;
+	for (vector<DrawCommand>::size_type i = 0; i < commands.size(); ++i) {
+		PROFILE_GPU_ZONE("RenderQueue::draw"); // One per object, covering the state it changes and its draw.
+
+		const DrawCommand &c = commands[i];
+		Shader *shader = programs[c.program];
+
+		if (c.program != program) {
+			shader->use();
+			shader->set_frame_uniforms(camera, light);
+			program = c.program;
+			material = -1; // Uniforms belong to the program.
+		}
+
+		if (c.object->culls_back_faces() != cull) {
+			cull = !cull;
+			if (cull) {
+				GLState::enable(GL_CULL_FACE);
+				GLState::cull_face(GL_BACK);
+			}
+			else {
+				GLState::disable(GL_CULL_FACE);
+			}
+		}
+
+		if (c.object->get_vao() != vao) {
+			vao = c.object->get_vao();
+			GLState::bind_vertex_array(vao);
+		}
+
+		if (c.material != material) {
+			shader->set_material(c.material);
+			material = c.material;
+		}
+
+		shader->set_model_uniforms(camera, c.object->get_model_to_world());
+
+		c.object->draw_geometry();
+	}
+
+	if (vao != 0) {
+		GLState::bind_vertex_array(0);
+	}
+	if (cull) {
+		GLState::disable(GL_CULL_FACE);
+	}
+	commands.clear();
+}
\ No newline at end of file
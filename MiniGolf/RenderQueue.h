@@ -0,0 +1,45 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Object3D.h"
+#include "Camera.h"
+#include "Light.h"
+#include "Material.h"
+#include "Shader.h"
+
+using namespace std;
+using namespace glm;
+
+static const float RENDER_QUEUE_DEPTH_RANGE = 100.0f; // The camera's far plane; depths past it share the last key value.
+
+// Sort key, high bits first: program slot (8), back face culling (1), VAO (20), material (8), depth (16).
+struct DrawCommand {
+	unsigned long long key;
+	int program; // Slot in the queue's program list.
+	int material; // MaterialTable index.
+	Object3D *object;
+
+	bool operator<(const DrawCommand &other) const;
+};
+
+// Collects a frame's draws, sorts them so draws sharing state run back to back (nearest first within
+// a group, for early depth rejection) and issues them, touching GL state only where it changes.
+class RenderQueue
+{
+public:
+	void submit(Object3D *object);
+
+	void flush(Camera *camera, Light *light); // Sorts, draws and empties the queue. Needs a current GL context.
+
+private:
+	vector<DrawCommand> commands; // Keeps its capacity between frames.
+	vector<Shader*> programs; // Shaders seen so far, in first-seen order.
+
+	int find_program(Shader *shader);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include <cstring>
+
+#include "Replay.h"
+#include "Game.h"
+#include "Timer.h"
+#include "Varint.h"
+
+static void write_u32(ostream &out, unsigned int value)
+{
+	for (int i = 0; i < 4; ++i) {
+		out.put((char)(value >> (8 * i)));
+	}
+}
+
+static bool read_u32(istream &in, unsigned int &value)
+{
+	value = 0;
+	for (int i = 0; i < 4; ++i) {
+		int c = in.get();
+		if (c == EOF) {
+			return false;
+		}
+		value |= (unsigned int)c << (8 * i);
+	}
+	return true;
+}
+
+// Raw bit patterns, so playback starts from exactly the recorded state.
+static void write_vec3(ostream &out, vec3 v)
+{
+	float f[3] = { v.x, v.y, v.z };
+	for (int i = 0; i < 3; ++i) {
+		unsigned int bits;
+		memcpy(&bits, &f[i], sizeof(bits));
+		write_u32(out, bits);
+	}
+}
+
+static bool read_vec3(istream &in, vec3 &v)
+{
+	float f[3];
+	for (int i = 0; i < 3; ++i) {
+		unsigned int bits;
+		if (!read_u32(in, bits)) {
+			return false;
+		}
+		memcpy(&f[i], &bits, sizeof(bits));
+	}
+	v = vec3(f[0], f[1], f[2]);
+	return true;
+}
+
+ShotLog::ShotLog(string course_name)
+{
+	this->course_name = course_name;
+}
+
+string ShotLog::get_course_name() const
+{
+	return course_name;
+}
+
+const vector<Shot> &ShotLog::get_shots() const
+{
+	return shots;
+}
+
+void ShotLog::add(const Shot &shot)
+{
+	shots.push_back(shot);
+}
+
+void ShotLog::write_header(ostream &out) const
+{
+	out.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+	out.put((char)REPLAY_VERSION);
+	write_varint(out, course_name.size());
+	out.write(course_name.data(), course_name.size());
+}
+
+void ShotLog::write_shot(ostream &out, const Shot &shot)
+{
+	write_varint(out, shot.hole);
+	write_u32(out, shot.hole_hash);
+	write_vec3(out, shot.start_position);
+	write_vec3(out, shot.start_velocity);
+
+	write_varint(out, shot.events.size());
+	unsigned int last_step = 0;
+	for (vector<ShotEvent>::size_type i = 0; i < shot.events.size(); ++i) {
+		write_varint(out, shot.events[i].step - last_step);
+		write_vec3(out, shot.events[i].force);
+		last_step = shot.events[i].step;
+	}
+
+	write_varint(out, shot.steps);
+	out.put(shot.holed ? 1 : 0);
+	write_vec3(out, shot.end_position);
+}
+
+void ShotLog::write(ostream &out) const
+{
+	write_header(out);
+	for (vector<Shot>::size_type i = 0; i < shots.size(); ++i) {
+		write_shot(out, shots[i]);
+	}
+}
+
+bool ShotLog::read(istream &in)
+{
+	char magic[sizeof(REPLAY_MAGIC)];
+	if (!in.read(magic, sizeof(magic)) || memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) {
+		cout << "error - not a replay file." << endl;
+		return false;
+	}
+	if (in.get() != REPLAY_VERSION) {
+		cout << "error - unsupported replay version." << endl;
+		return false;
+	}
+
+	unsigned int length;
+	if (!read_varint(in, length)) {
+		cout << "error - truncated replay header." << endl;
+		return false;
+	}
+	course_name.resize(length);
+	if (length > 0 && !in.read(&course_name[0], length)) {
+		cout << "error - truncated replay header." << endl;
+		return false;
+	}
+
+	shots.clear();
+
+	// A log from a game that was killed mid-write ends in a partial shot; keep the complete ones.
+	while (in.peek() != EOF) {
+		Shot shot;
+		unsigned int count, holed = 0;
+
+		bool ok = read_varint(in, shot.hole) && read_u32(in, shot.hole_hash) &&
+			read_vec3(in, shot.start_position) && read_vec3(in, shot.start_velocity) &&
+			read_varint(in, count);
+
+		unsigned int step = 0;
+		for (unsigned int i = 0; ok && i < count; ++i) {
+			ShotEvent event;
+			unsigned int delta;
+			ok = read_varint(in, delta) && read_vec3(in, event.force);
+			step += delta;
+			event.step = step;
+			shot.events.push_back(event);
+		}
+
+		ok = ok && read_varint(in, shot.steps) && (holed = in.get()) != (unsigned int)EOF && read_vec3(in, shot.end_position);
+		if (!ok) {
+			cout << "error - truncated shot at the end of the replay, " << shots.size() << " shot(s) read." << endl;
+			break;
+		}
+		shot.holed = holed != 0;
+
+		shots.push_back(shot);
+	}
+
+	return true;
+}
+
+bool ShotLog::read_file(string fname)
+{
+	ifstream in_file(fname.c_str(), ios::binary);
+	if (!in_file.is_open()) {
+		cout << "error - unable to open " << fname << endl;
+		return false;
+	}
+	return read(in_file);
+}
+
+ShotRecorder::ShotRecorder()
+{
+	recording = false;
+}
+
+bool ShotRecorder::is_recording() const
+{
+	return recording;
+}
+
+void ShotRecorder::begin(unsigned int hole, Level *level)
+{
+	Ball *ball = level->get_ball();
+
+	shot.hole = hole;
+	shot.hole_hash = level->get_source_hash();
+	shot.start_position = ball->get_position();
+	shot.start_velocity = ball->get_velocity();
+	shot.events.clear();
+	shot.steps = 0;
+	recording = true;
+}
+
+void ShotRecorder::add_force(vec3 f)
+{
+	ShotEvent event;
+	event.step = shot.steps;
+	event.force = f;
+	shot.events.push_back(event);
+}
+
+void ShotRecorder::step()
+{
+	shot.steps++;
+}
+
+Shot ShotRecorder::end(Level *level)
+{
+	shot.holed = level->ball_in_cup();
+	shot.end_position = level->get_ball()->get_position();
+	recording = false;
+
+	return shot;
+}
+
+void ShotRecorder::cancel()
+{
+	recording = false;
+}
+
+// Mirrors Game::update: forces land before the step they were recorded in, and the shot ends
+// once the ball drops or comes to rest.
+ReplayResult replay_shot(Level *level, const Shot &shot, double time_step)
+{
+	Ball *ball = level->get_ball();
+	ball->reset(shot.start_position);
+	ball->set_velocity(shot.start_velocity);
+	level->set_ball_tile(shot.start_position);
+
+	ReplayResult result;
+	result.holed = false;
+
+	vector<ShotEvent>::size_type next = 0;
+	unsigned int step = 0;
+
+	while (step < shot.steps + 1 && step < REPLAY_MAX_STEPS) {
+		while (next < shot.events.size() && shot.events[next].step == step) {
+			ball->add_force(shot.events[next].force);
+			next++;
+		}
+
+		level->step(time_step);
+		step++;
+
+		if (level->ball_in_cup()) {
+			result.holed = true;
+			break;
+		}
+		if (!ball->is_active() && next == shot.events.size()) {
+			break;
+		}
+	}
+
+	result.steps = step;
+	result.end_position = ball->get_position();
+
+	return result;
+}
+
+int run_replay(int argc, char **argv)
+{
+	if (argc < 2) {
+		cout << "usage: MiniGolf --replay <course> <log>" << endl;
+		return 1;
+	}
+
+	Object3D::set_headless(true);
+
+	vector<Level*> levels = Level::load_levels(argv[0]);
+	ShotLog log;
+	if (levels.empty() || !log.read_file(argv[1])) {
+		return 1;
+	}
+
+	int mismatches = 0, skipped = 0;
+	Timer timer;
+	timer.start();
+
+	const vector<Shot> &shots = log.get_shots();
+	for (vector<Shot>::size_type i = 0; i < shots.size(); ++i) {
+		const Shot &shot = shots[i];
+
+		if (shot.hole >= levels.size() || levels[shot.hole]->get_source_hash() != shot.hole_hash) {
+			skipped++; // Recorded on a different layout; its outcome means nothing here.
+			continue;
+		}
+
+		ReplayResult result = replay_shot(levels[shot.hole], shot, PHYSICS_TIME_STEP);
+
+		if (result.steps != shot.steps || result.holed != shot.holed || result.end_position != shot.end_position) {
+			vec3 p = result.end_position, q = shot.end_position;
+			cout << "shot " << i << " (hole " << shot.hole + 1 << "): recorded " << shot.steps << " steps to ("
+				<< q.x << ", " << q.y << ", " << q.z << ")" << (shot.holed ? " holed" : "")
+				<< ", replayed " << result.steps << " steps to (" << p.x << ", " << p.y << ", " << p.z << ")"
+				<< (result.holed ? " holed" : "") << endl;
+			mismatches++;
+		}
+	}
+
+	double seconds = timer.get_elapsed_time_in_sec();
+
+	cout << shots.size() << " shot(s) from " << log.get_course_name() << ": " << mismatches << " mismatch(es), "
+		<< skipped << " skipped for a changed hole, " << seconds << " s" << endl;
+
+	for (vector<Level*>::size_type i = 0; i < levels.size(); ++i) {
+		delete levels[i];
+	}
+
+	return mismatches == 0 ? 0 : 2;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Level.h"
+
+using namespace std;
+using namespace glm;
+
+static const char REPLAY_MAGIC[4] = { 'M', 'G', 'R', 'P' };
+static const unsigned char REPLAY_VERSION = 1;
+static const unsigned int REPLAY_MAX_STEPS = 60 * 60 * 10; // A shot still rolling after ten simulated minutes is cut off.
+
+struct ShotEvent {
+	unsigned int step; // Physics steps since the shot began; the force lands in this step.
+	vec3 force; // As passed to add_force.
+};
+
+// One shot: everything needed to re-simulate it, plus the outcome to check the re-simulation against.
+struct Shot {
+	unsigned int hole; // Index of the hole in its course.
+	unsigned int hole_hash; // Level::get_source_hash() when recorded.
+	vec3 start_position;
+	vec3 start_velocity;
+	vector<ShotEvent> events;
+	unsigned int steps; // Fixed steps until the ball stopped or dropped.
+	bool holed;
+	vec3 end_position;
+};
+
+// Binary shot log. Little-endian; counts and step deltas are varints and vectors are raw floats,
+// so a typical single-hit shot takes about 50 bytes.
+class ShotLog
+{
+public:
+	ShotLog(string course_name = "");
+
+	string get_course_name() const;
+
+	const vector<Shot> &get_shots() const;
+
+	void add(const Shot &shot);
+
+	void write_header(ostream &out) const;
+
+	static void write_shot(ostream &out, const Shot &shot);
+
+	void write(ostream &out) const;
+
+	bool read(istream &in);
+
+	bool read_file(string fname);
+
+private:
+	string course_name;
+	vector<Shot> shots;
+};
+
+// Builds Shots from a live game. Call add_force as forces are applied and step after every fixed step.
+class ShotRecorder
+{
+public:
+	ShotRecorder();
+
+	bool is_recording() const;
+
+	void begin(unsigned int hole, Level *level);
+
+	void add_force(vec3 f);
+
+	void step();
+
+	Shot end(Level *level);
+
+	void cancel();
+
+private:
+	Shot shot;
+	bool recording;
+};
+
+struct ReplayResult {
+	unsigned int steps;
+	bool holed;
+	vec3 end_position;
+};
+
+// Re-simulate a shot on a level through Level::step at the recording's time step.
+ReplayResult replay_shot(Level *level, const Shot &shot, double time_step);
+
+// --replay <course> <log>: re-simulate every shot in a log and report any that come out differently.
+int run_replay(int argc, char **argv);
+
+#endif
\ No newline at end of file
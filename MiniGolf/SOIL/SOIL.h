@@ -342,6 +342,27 @@ unsigned int
 		unsigned int flags
 	);
 
+/**
+	Uploads a DDS image from RAM exactly as it is stored: the DXT data and
+	any MIPmaps in the file go straight to OpenGL, with no other processing.
+	Unlike SOIL_FLAG_DDS_LOAD_DIRECT, it never falls back to decoding the image.
+	\param buffer the DDS file in RAM
+	\param buffer_length the size of the buffer in bytes
+	\param reuse_texture_ID 0-generate a new texture ID, otherwise reuse the texture ID (overwriting the old texture)
+	\param flags only SOIL_FLAG_TEXTURE_REPEATS is used
+	\param loading_as_cubemap 1 if the DDS must be a cubemap, 0 if it must not be
+	\return 0-failed, otherwise returns the OpenGL texture handle
+**/
+unsigned int
+	SOIL_direct_load_DDS_from_memory
+	(
+		const unsigned char *const buffer,
+		int buffer_length,
+		unsigned int reuse_texture_ID,
+		int flags,
+		int loading_as_cubemap
+	);
+
 /**
 	Captures the OpenGL window (RGB) and saves it to disk
 	\return 0 if it failed, otherwise returns 1
@@ -7,12 +7,33 @@
 	public domain
 */
 
+#ifdef WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
 #include "image_DXT.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+/*	SSE2 is always there on x64, and on x86 when the compiler was told it may use it	*/
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define SOIL_DXT_SSE2	1
+	#include <emmintrin.h>
+#else
+	#define SOIL_DXT_SSE2	0
+#endif
+
+/*	images are split across at most this many threads, and
+	each thread gets at least this many rows of 4x4 blocks	*/
+#define SOIL_DXT_MAX_THREADS	32
+#define SOIL_DXT_MIN_BLOCK_ROWS	16
+
 /*	set this =1 if you want to use the covarince matrix method...
 	which is better than my method of using standard deviations
 	overall, except on the infintesimal chance that the power
@@ -98,40 +119,41 @@ int
 	return 1;
 }
 
-unsigned char* convert_image_to_DXT1(
-		const unsigned char *const uncompressed,
-		int width, int height, int channels,
-		int *out_size )
+/*	one horizontal band of 4x4 blocks, so that bands can be handed to different threads	*/
+typedef struct
 {
+	const unsigned char *uncompressed;
+	int width, height, channels;
+	int with_alpha;
 	unsigned char *compressed;
+	int first_block_row, last_block_row;
+}
+DXT_band;
+
+static void compress_DXT_band( const DXT_band *band )
+{
+	const unsigned char *const uncompressed = band->uncompressed;
+	const int width = band->width, height = band->height, channels = band->channels;
+	const int block_size = band->with_alpha ? 16 : 8;
 	int i, j, x, y;
-	unsigned char ublock[16*3];
+	unsigned char ublock[16*4];
 	unsigned char cblock[8];
-	int index = 0, chan_step = 1;
-	int block_count = 0;
-	/*	error check	*/
-	*out_size = 0;
-	if( (width < 1) || (height < 1) ||
-		(NULL == uncompressed) ||
-		(channels < 1) || (channels > 4) )
-	{
-		return NULL;
-	}
+	int chan_step = 1, has_alpha;
+	int index = band->first_block_row * ((width+3) >> 2) * block_size;
 	/*	for channels == 1 or 2, I do not step forward for R,G,B values	*/
 	if( channels < 3 )
 	{
 		chan_step = 0;
 	}
-	/*	get the RAM for the compressed image
-		(8 bytes per 4x4 pixel block)	*/
-	*out_size = ((width+3) >> 2) * ((height+3) >> 2) * 8;
-	compressed = (unsigned char*)malloc( *out_size );
+	/*	# channels = 1 or 3 have no alpha, 2 & 4 do have alpha	*/
+	has_alpha = 1 - (channels & 1);
 	/*	go through each block	*/
-	for( j = 0; j < height; j += 4 )
+	for( j = band->first_block_row * 4; j < height && j < band->last_block_row * 4; j += 4 )
 	{
 		for( i = 0; i < width; i += 4 )
 		{
-			/*	copy this block into a new one	*/
+			/*	copy this block into a new one, always 4 bytes per pixel
+				(DXT1 never reads the 4th, but the SIMD paths want the stride)	*/
 			int idx = 0;
 			int mx = 4, my = 4;
 			if( j+4 >= height )
@@ -149,12 +171,16 @@ unsigned char* convert_image_to_DXT1(
 					ublock[idx++] = uncompressed[(j+y)*width*channels+(i+x)*channels];
 					ublock[idx++] = uncompressed[(j+y)*width*channels+(i+x)*channels+chan_step];
 					ublock[idx++] = uncompressed[(j+y)*width*channels+(i+x)*channels+chan_step+chan_step];
+					ublock[idx++] =
+						has_alpha * uncompressed[(j+y)*width*channels+(i+x)*channels+channels-1]
+						+ (1-has_alpha)*255;
 				}
 				for( x = mx; x < 4; ++x )
 				{
 					ublock[idx++] = ublock[0];
 					ublock[idx++] = ublock[1];
 					ublock[idx++] = ublock[2];
+					ublock[idx++] = ublock[3];
 				}
 			}
 			for( y = my; y < 4; ++y )
@@ -164,114 +190,186 @@ unsigned char* convert_image_to_DXT1(
 					ublock[idx++] = ublock[0];
 					ublock[idx++] = ublock[1];
 					ublock[idx++] = ublock[2];
+					ublock[idx++] = ublock[3];
 				}
 			}
-			/*	compress the block	*/
-			++block_count;
-			compress_DDS_color_block( 3, ublock, cblock );
-			/*	copy the data from the block into the main block	*/
+			if( band->with_alpha )
+			{
+				/*	compress the alpha block first	*/
+				compress_DDS_alpha_block( ublock, cblock );
+				for( x = 0; x < 8; ++x )
+				{
+					band->compressed[index++] = cblock[x];
+				}
+			}
+			/*	then the color block	*/
+			compress_DDS_color_block( 4, ublock, cblock );
 			for( x = 0; x < 8; ++x )
 			{
-				compressed[index++] = cblock[x];
+				band->compressed[index++] = cblock[x];
 			}
 		}
 	}
-	return compressed;
 }
 
-unsigned char* convert_image_to_DXT5(
+#ifdef WIN32
+static DWORD WINAPI DXT_band_thread( LPVOID band )
+{
+	compress_DXT_band( (const DXT_band*)band );
+	return 0;
+}
+#else
+static void *DXT_band_thread( void *band )
+{
+	compress_DXT_band( (const DXT_band*)band );
+	return NULL;
+}
+#endif
+
+/*	most threads one conversion may use; 0 means one per processor	*/
+static int DXT_thread_limit = 0;
+
+void set_DXT_thread_count( int count )
+{
+	DXT_thread_limit = count < 0 ? 0 : count;
+}
+
+static int DXT_thread_count( void )
+{
+	int count;
+#ifdef WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	count = (int)info.dwNumberOfProcessors;
+#else
+	count = (int)sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	if( DXT_thread_limit > 0 && count > DXT_thread_limit )
+	{
+		count = DXT_thread_limit;
+	}
+	if( count < 1 )
+	{
+		count = 1;
+	} else if( count > SOIL_DXT_MAX_THREADS )
+	{
+		count = SOIL_DXT_MAX_THREADS;
+	}
+	return count;
+}
+
+/*	split the rows of blocks into one band per thread; the calling thread takes the first band.
+	Every band writes its own part of the output, so there is nothing to synchronize.	*/
+static void compress_DXT_parallel( const DXT_band *whole )
+{
+	DXT_band bands[SOIL_DXT_MAX_THREADS];
+#ifdef WIN32
+	HANDLE threads[SOIL_DXT_MAX_THREADS];
+#else
+	pthread_t threads[SOIL_DXT_MAX_THREADS];
+#endif
+	int started[SOIL_DXT_MAX_THREADS];
+	int block_rows = (whole->height+3) >> 2;
+	int count = DXT_thread_count();
+	int i;
+	if( count > block_rows / SOIL_DXT_MIN_BLOCK_ROWS )
+	{
+		count = block_rows / SOIL_DXT_MIN_BLOCK_ROWS;
+	}
+	if( count <= 1 )
+	{
+		compress_DXT_band( whole );
+		return;
+	}
+	for( i = 0; i < count; ++i )
+	{
+		bands[i] = *whole;
+		bands[i].first_block_row = block_rows * i / count;
+		bands[i].last_block_row = block_rows * (i+1) / count;
+	}
+	for( i = 1; i < count; ++i )
+	{
+#ifdef WIN32
+		threads[i] = CreateThread( NULL, 0, DXT_band_thread, &bands[i], 0, NULL );
+		started[i] = (threads[i] != NULL);
+#else
+		started[i] = (pthread_create( &threads[i], NULL, DXT_band_thread, &bands[i] ) == 0);
+#endif
+	}
+	compress_DXT_band( &bands[0] );
+	for( i = 1; i < count; ++i )
+	{
+		if( !started[i] )
+		{
+			/*	could not get a thread, so do it here	*/
+			compress_DXT_band( &bands[i] );
+			continue;
+		}
+#ifdef WIN32
+		WaitForSingleObject( threads[i], INFINITE );
+		CloseHandle( threads[i] );
+#else
+		pthread_join( threads[i], NULL );
+#endif
+	}
+}
+
+unsigned char* convert_image_to_DXT1(
 		const unsigned char *const uncompressed,
 		int width, int height, int channels,
 		int *out_size )
 {
-	unsigned char *compressed;
-	int i, j, x, y;
-	unsigned char ublock[16*4];
-	unsigned char cblock[8];
-	int index = 0, chan_step = 1;
-	int block_count = 0, has_alpha;
+	DXT_band whole;
 	/*	error check	*/
 	*out_size = 0;
 	if( (width < 1) || (height < 1) ||
 		(NULL == uncompressed) ||
-		(channels < 1) || ( channels > 4) )
+		(channels < 1) || (channels > 4) )
 	{
 		return NULL;
 	}
-	/*	for channels == 1 or 2, I do not step forward for R,G,B vales	*/
-	if( channels < 3 )
+	/*	get the RAM for the compressed image
+		(8 bytes per 4x4 pixel block)	*/
+	*out_size = ((width+3) >> 2) * ((height+3) >> 2) * 8;
+	whole.uncompressed = uncompressed;
+	whole.width = width;
+	whole.height = height;
+	whole.channels = channels;
+	whole.with_alpha = 0;
+	whole.compressed = (unsigned char*)malloc( *out_size );
+	whole.first_block_row = 0;
+	whole.last_block_row = (height+3) >> 2;
+	compress_DXT_parallel( &whole );
+	return whole.compressed;
+}
+
+unsigned char* convert_image_to_DXT5(
+		const unsigned char *const uncompressed,
+		int width, int height, int channels,
+		int *out_size )
+{
+	DXT_band whole;
+	/*	error check	*/
+	*out_size = 0;
+	if( (width < 1) || (height < 1) ||
+		(NULL == uncompressed) ||
+		(channels < 1) || ( channels > 4) )
 	{
-		chan_step = 0;
+		return NULL;
 	}
-	/*	# channels = 1 or 3 have no alpha, 2 & 4 do have alpha	*/
-	has_alpha = 1 - (channels & 1);
 	/*	get the RAM for the compressed image
 		(16 bytes per 4x4 pixel block)	*/
 	*out_size = ((width+3) >> 2) * ((height+3) >> 2) * 16;
-	compressed = (unsigned char*)malloc( *out_size );
-	/*	go through each block	*/
-	for( j = 0; j < height; j += 4 )
-	{
-		for( i = 0; i < width; i += 4 )
-		{
-			/*	local variables, and my block counter	*/
-			int idx = 0;
-			int mx = 4, my = 4;
-			if( j+4 >= height )
-			{
-				my = height - j;
-			}
-			if( i+4 >= width )
-			{
-				mx = width - i;
-			}
-			for( y = 0; y < my; ++y )
-			{
-				for( x = 0; x < mx; ++x )
-				{
-					ublock[idx++] = uncompressed[(j+y)*width*channels+(i+x)*channels];
-					ublock[idx++] = uncompressed[(j+y)*width*channels+(i+x)*channels+chan_step];
-					ublock[idx++] = uncompressed[(j+y)*width*channels+(i+x)*channels+chan_step+chan_step];
-					ublock[idx++] =
-						has_alpha * uncompressed[(j+y)*width*channels+(i+x)*channels+channels-1]
-						+ (1-has_alpha)*255;
-				}
-				for( x = mx; x < 4; ++x )
-				{
-					ublock[idx++] = ublock[0];
-					ublock[idx++] = ublock[1];
-					ublock[idx++] = ublock[2];
-					ublock[idx++] = ublock[3];
-				}
-			}
-			for( y = my; y < 4; ++y )
-			{
-				for( x = 0; x < 4; ++x )
-				{
-					ublock[idx++] = ublock[0];
-					ublock[idx++] = ublock[1];
-					ublock[idx++] = ublock[2];
-					ublock[idx++] = ublock[3];
-				}
-			}
-			/*	now compress the alpha block	*/
-			compress_DDS_alpha_block( ublock, cblock );
-			/*	copy the data from the compressed alpha block into the main buffer	*/
-			for( x = 0; x < 8; ++x )
-			{
-				compressed[index++] = cblock[x];
-			}
-			/*	then compress the color block	*/
-			++block_count;
-			compress_DDS_color_block( 4, ublock, cblock );
-			/*	copy the data from the compressed color block into the main buffer	*/
-			for( x = 0; x < 8; ++x )
-			{
-				compressed[index++] = cblock[x];
-			}
-		}
-	}
-	return compressed;
+	whole.uncompressed = uncompressed;
+	whole.width = width;
+	whole.height = height;
+	whole.channels = channels;
+	whole.with_alpha = 1;
+	whole.compressed = (unsigned char*)malloc( *out_size );
+	whole.first_block_row = 0;
+	whole.last_block_row = (height+3) >> 2;
+	compress_DXT_parallel( &whole );
+	return whole.compressed;
 }
 
 /********* Helper Functions *********/
@@ -308,6 +406,51 @@ void compute_color_line_STDEV(
 	float sum_rg = 0.0f, sum_rb = 0.0f, sum_gb = 0.0f;
 	/*	calculate all data needed for the covariance matrix
 		( to compare with _rygdxt code)	*/
+#if SOIL_DXT_SSE2
+	if( channels == 4 )
+	{
+		/*	every sum is an integer below 2^24, so summing in integers
+			gives exactly what the float loop below would	*/
+		int sums[9][4];
+		__m128i acc[9];
+		for( i = 0; i < 9; ++i )
+		{
+			acc[i] = _mm_setzero_si128();
+		}
+		for( i = 0; i < 4; ++i )
+		{
+			/*	4 RGBA pixels, split into one 32 bit lane per pixel and channel	*/
+			const __m128i mask = _mm_set1_epi32( 0xFF );
+			__m128i v = _mm_loadu_si128( (const __m128i*)(uncompressed + i*16) );
+			__m128i r = _mm_and_si128( v, mask );
+			__m128i g = _mm_and_si128( _mm_srli_epi32( v, 8 ), mask );
+			__m128i b = _mm_and_si128( _mm_srli_epi32( v, 16 ), mask );
+			acc[0] = _mm_add_epi32( acc[0], r );
+			acc[1] = _mm_add_epi32( acc[1], g );
+			acc[2] = _mm_add_epi32( acc[2], b );
+			/*	the high half of each lane is 0, so madd is a plain 32 bit product	*/
+			acc[3] = _mm_add_epi32( acc[3], _mm_madd_epi16( r, r ) );
+			acc[4] = _mm_add_epi32( acc[4], _mm_madd_epi16( g, g ) );
+			acc[5] = _mm_add_epi32( acc[5], _mm_madd_epi16( b, b ) );
+			acc[6] = _mm_add_epi32( acc[6], _mm_madd_epi16( r, g ) );
+			acc[7] = _mm_add_epi32( acc[7], _mm_madd_epi16( r, b ) );
+			acc[8] = _mm_add_epi32( acc[8], _mm_madd_epi16( g, b ) );
+		}
+		for( i = 0; i < 9; ++i )
+		{
+			_mm_storeu_si128( (__m128i*)sums[i], acc[i] );
+		}
+		sum_r = (float)(sums[0][0] + sums[0][1] + sums[0][2] + sums[0][3]);
+		sum_g = (float)(sums[1][0] + sums[1][1] + sums[1][2] + sums[1][3]);
+		sum_b = (float)(sums[2][0] + sums[2][1] + sums[2][2] + sums[2][3]);
+		sum_rr = (float)(sums[3][0] + sums[3][1] + sums[3][2] + sums[3][3]);
+		sum_gg = (float)(sums[4][0] + sums[4][1] + sums[4][2] + sums[4][3]);
+		sum_bb = (float)(sums[5][0] + sums[5][1] + sums[5][2] + sums[5][3]);
+		sum_rg = (float)(sums[6][0] + sums[6][1] + sums[6][2] + sums[6][3]);
+		sum_rb = (float)(sums[7][0] + sums[7][1] + sums[7][2] + sums[7][3]);
+		sum_gb = (float)(sums[8][0] + sums[8][1] + sums[8][2] + sums[8][3]);
+	} else
+#endif
 	for( i = 0; i < 16*channels; i += channels )
 	{
 		sum_r += uncompressed[i+0];
@@ -438,6 +581,48 @@ void LSE_master_colors_max_min(
 				sum_x2[2] * uncompressed[2]
 			);
 	dot_min = dot_max;
+#if SOIL_DXT_SSE2
+	/*	4 pixels at a time, adding the products in the same order as below
+		(a NaN direction is left to the scalar loop, min/max would treat it differently)	*/
+	if( (channels == 4) && (dot_max == dot_max) )
+	{
+		const __m128i mask = _mm_set1_epi32( 0xFF );
+		const __m128 dir_r = _mm_set1_ps( sum_x2[0] );
+		const __m128 dir_g = _mm_set1_ps( sum_x2[1] );
+		const __m128 dir_b = _mm_set1_ps( sum_x2[2] );
+		__m128 vmin = _mm_set1_ps( dot_min );
+		__m128 vmax = _mm_set1_ps( dot_max );
+		float lanes[4];
+		for( i = 0; i < 4; ++i )
+		{
+			__m128i v = _mm_loadu_si128( (const __m128i*)(uncompressed + i*16) );
+			__m128 r = _mm_cvtepi32_ps( _mm_and_si128( v, mask ) );
+			__m128 g = _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( v, 8 ), mask ) );
+			__m128 b = _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( v, 16 ), mask ) );
+			__m128 d = _mm_add_ps(
+					_mm_add_ps( _mm_mul_ps( dir_r, r ), _mm_mul_ps( dir_g, g ) ),
+					_mm_mul_ps( dir_b, b ) );
+			vmin = _mm_min_ps( vmin, d );
+			vmax = _mm_max_ps( vmax, d );
+		}
+		_mm_storeu_ps( lanes, vmin );
+		for( i = 0; i < 4; ++i )
+		{
+			if( lanes[i] < dot_min )
+			{
+				dot_min = lanes[i];
+			}
+		}
+		_mm_storeu_ps( lanes, vmax );
+		for( i = 0; i < 4; ++i )
+		{
+			if( lanes[i] > dot_max )
+			{
+				dot_max = lanes[i];
+			}
+		}
+	} else
+#endif
 	for( i = 1; i < 16; ++i )
 	{
 		dot =
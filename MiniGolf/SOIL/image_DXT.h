@@ -45,6 +45,17 @@ convert_image_to_DXT5
     int *out_size
 );
 
+/**
+	cap the threads one DXT conversion may start; 0 (the default) means
+	one per processor and 1 converts on the calling thread only.
+	set it before any conversion starts, as it is read without a lock
+**/
+void
+set_DXT_thread_count
+(
+    int count
+);
+
 /**	A bunch of DirectDraw Surface structures and flags **/
 typedef struct
 {
@@ -8,8 +8,469 @@
 
 #include "image_helper.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+/*	SSE2 is always there on x64, and on x86 when the compiler was told it may use it.
+	AVX2 needs a compiler that knows the intrinsics, and is only used if cpuid says so.	*/
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define SOIL_HELPER_SSE2	1
+	#include <emmintrin.h>
+	#if defined(_MSC_VER) && (_MSC_VER >= 1700)
+		#define SOIL_HELPER_AVX2	1
+		#define SOIL_AVX2_FUNCTION
+		#include <immintrin.h>
+		#include <intrin.h>
+	#elif defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))))
+		#define SOIL_HELPER_AVX2	1
+		#define SOIL_AVX2_FUNCTION	__attribute__((target("avx2")))
+		#include <immintrin.h>
+		#include <cpuid.h>
+	#else
+		#define SOIL_HELPER_AVX2	0
+	#endif
+#else
+	#define SOIL_HELPER_SSE2	0
+	#define SOIL_HELPER_AVX2	0
+#endif
+
+enum
+{
+	SOIL_SIMD_NONE = 0,
+	SOIL_SIMD_SSE2 = 1,
+	SOIL_SIMD_AVX2 = 2
+};
+
+/*	the mipmap column sums are 16 bit, so at most this many rows per block	*/
+#define SOIL_MIPMAP_MAX_SIMD_ROWS	256
+
+/*	the NTSC safe scaling table is (i*1767 + 31720) >> 11, checked against the
+	table before it is used (x87 builds could round the table differently)	*/
+#define SOIL_NTSC_MUL	1767
+#define SOIL_NTSC_ADD	31720
+#define SOIL_NTSC_SHIFT	11
+
+#if SOIL_HELPER_AVX2
+static int
+	detect_AVX2
+	(
+		void
+	)
+{
+	unsigned int xcr0;
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid( info, 0 );
+	if( info[0] < 7 )
+	{
+		return 0;
+	}
+	__cpuid( info, 1 );
+	/*	AVX, and the OS saves the YMM registers	*/
+	if( (info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 )
+	{
+		return 0;
+	}
+	xcr0 = (unsigned int)_xgetbv( 0 );
+	__cpuidex( info, 7, 0 );
+	return ((xcr0 & 6) == 6) && ((info[1] & (1 << 5)) != 0);
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if( __get_cpuid_max( 0, NULL ) < 7 )
+	{
+		return 0;
+	}
+	__cpuid( 1, eax, ebx, ecx, edx );
+	if( (ecx & (1u << 27)) == 0 || (ecx & (1u << 28)) == 0 )
+	{
+		return 0;
+	}
+	__asm__ __volatile__( "xgetbv" : "=a"(xcr0), "=d"(edx) : "c"(0) );
+	__cpuid_count( 7, 0, eax, ebx, ecx, edx );
+	return ((xcr0 & 6) == 6) && ((ebx & (1u << 5)) != 0);
+#endif
+}
+#endif
+
+/*	the highest level the caller allows (see image_helper_limit_SIMD)	*/
+static int SIMD_limit = SOIL_SIMD_AVX2;
+
+/*	which instruction set the kernels below may use (worked out once)	*/
+static int
+	image_helper_SIMD_level
+	(
+		void
+	)
+{
+	static int level = -1;
+	if( level < 0 )
+	{
+		int found = SOIL_SIMD_NONE;
+#if SOIL_HELPER_SSE2
+		found = SOIL_SIMD_SSE2;
+#endif
+#if SOIL_HELPER_AVX2
+		if( detect_AVX2() )
+		{
+			found = SOIL_SIMD_AVX2;
+		}
+#endif
+		level = found;
+	}
+	return (level < SIMD_limit) ? level : SIMD_limit;
+}
+
+int
+	image_helper_limit_SIMD
+	(
+		int max_level
+	)
+{
+	SIMD_limit = max_level;
+	return image_helper_SIMD_level();
+}
+
+#if SOIL_HELPER_SSE2
+/*	one RGB or RGBA pixel as 4 floats (0 alpha for RGB)	*/
+static __m128
+	load_pixel_SSE2
+	(
+		const unsigned char* p,
+		int channels
+	)
+{
+	unsigned int packed = p[0] | (p[1] << 8) | (p[2] << 16);
+	__m128i v;
+	if( channels == 4 )
+	{
+		packed |= (unsigned int)p[3] << 24;
+	}
+	v = _mm_cvtsi32_si128( (int)packed );
+	v = _mm_unpacklo_epi8( v, _mm_setzero_si128() );
+	v = _mm_unpacklo_epi16( v, _mm_setzero_si128() );
+	return _mm_cvtepi32_ps( v );
+}
+
+/*	4 truncated values back into bytes	*/
+static void
+	store_pixel_SSE2
+	(
+		unsigned char* p,
+		int channels,
+		__m128 value
+	)
+{
+	__m128i v = _mm_cvttps_epi32( value );
+	unsigned int packed;
+	v = _mm_packs_epi32( v, v );
+	v = _mm_packus_epi16( v, v );
+	packed = (unsigned int)_mm_cvtsi128_si32( v );
+	p[0] = (unsigned char)(packed);
+	p[1] = (unsigned char)(packed >> 8);
+	p[2] = (unsigned char)(packed >> 16);
+	if( channels == 4 )
+	{
+		p[3] = (unsigned char)(packed >> 24);
+	}
+}
+
+/*	one row of up_scale_image, for 3 or 4 channels, doing the same float
+	operations in the same order as the scalar loop (so the output matches)	*/
+static void
+	up_scale_row_SSE2
+	(
+		const unsigned char* const row,
+		int width, int channels,
+		unsigned char* resampled_row,
+		int resampled_width,
+		const int* intx, const float* samplex,
+		float sampley
+	)
+{
+	const __m128 sy = _mm_set1_ps( sampley );
+	const __m128 inv_sy = _mm_set1_ps( 1.0f - sampley );
+	int x;
+	for( x = 0; x < resampled_width; ++x )
+	{
+		const unsigned char* base = row + intx[x] * channels;
+		const __m128 sx = _mm_set1_ps( samplex[x] );
+		const __m128 inv_sx = _mm_set1_ps( 1.0f - samplex[x] );
+		__m128 value = _mm_set1_ps( 0.5f );
+		value = _mm_add_ps( value, _mm_mul_ps( _mm_mul_ps(
+				load_pixel_SSE2( base, channels ), inv_sx ), inv_sy ) );
+		value = _mm_add_ps( value, _mm_mul_ps( _mm_mul_ps(
+				load_pixel_SSE2( base + channels, channels ), sx ), inv_sy ) );
+		value = _mm_add_ps( value, _mm_mul_ps( _mm_mul_ps(
+				load_pixel_SSE2( base + width*channels, channels ), inv_sx ), sy ) );
+		value = _mm_add_ps( value, _mm_mul_ps( _mm_mul_ps(
+				load_pixel_SSE2( base + width*channels + channels, channels ), sx ), sy ) );
+		store_pixel_SSE2( resampled_row + x*channels, channels, value );
+	}
+}
+
+/*	add a row of bytes into 16 bit column sums, returns how many were done	*/
+static int
+	add_row_SSE2
+	(
+		const unsigned char* row,
+		unsigned short* sums,
+		int count
+	)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int i;
+	for( i = 0; i + 16 <= count; i += 16 )
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*)(row + i) );
+		__m128i lo = _mm_loadu_si128( (const __m128i*)(sums + i) );
+		__m128i hi = _mm_loadu_si128( (const __m128i*)(sums + i + 8) );
+		lo = _mm_add_epi16( lo, _mm_unpacklo_epi8( v, zero ) );
+		hi = _mm_add_epi16( hi, _mm_unpackhi_epi8( v, zero ) );
+		_mm_storeu_si128( (__m128i*)(sums + i), lo );
+		_mm_storeu_si128( (__m128i*)(sums + i + 8), hi );
+	}
+	return i;
+}
+
+/*	16 bytes through the NTSC safe mapping, leaving the bytes in keep alone	*/
+static __m128i
+	NTSC_safe_SSE2
+	(
+		__m128i v,
+		__m128i keep
+	)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16( 1 );
+	const __m128i k = _mm_set1_epi32( (SOIL_NTSC_ADD << 16) | SOIL_NTSC_MUL );
+	__m128i lo = _mm_unpacklo_epi8( v, zero );
+	__m128i hi = _mm_unpackhi_epi8( v, zero );
+	__m128i a, b, scaled;
+	/*	madd of (x, 1) with (MUL, ADD) is x*MUL + ADD in 32 bits	*/
+	a = _mm_srli_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( lo, one ), k ), SOIL_NTSC_SHIFT );
+	b = _mm_srli_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( lo, one ), k ), SOIL_NTSC_SHIFT );
+	lo = _mm_packs_epi32( a, b );
+	a = _mm_srli_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( hi, one ), k ), SOIL_NTSC_SHIFT );
+	b = _mm_srli_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( hi, one ), k ), SOIL_NTSC_SHIFT );
+	hi = _mm_packs_epi32( a, b );
+	scaled = _mm_packus_epi16( lo, hi );
+	return _mm_or_si128( _mm_and_si128( keep, v ), _mm_andnot_si128( keep, scaled ) );
+}
+
+/*	4 RGBA pixels to CoCgAY.  Every result is in [0,256], so x - (x >> 8)
+	is the same clamp as clamp_byte	*/
+static __m128i
+	RGBA_to_CoCgAY_SSE2
+	(
+		__m128i v
+	)
+{
+	const __m128i mask = _mm_set1_epi32( 0xFF );
+	const __m128i c128 = _mm_set1_epi32( 128 );
+	__m128i r = _mm_and_si128( v, mask );
+	__m128i g = _mm_and_si128( _mm_srli_epi32( v, 8 ), mask );
+	__m128i b = _mm_and_si128( _mm_srli_epi32( v, 16 ), mask );
+	__m128i a = _mm_srli_epi32( v, 24 );
+	__m128i tmp, co, cg, y;
+	g = _mm_srli_epi32( _mm_add_epi32( g, _mm_set1_epi32( 1 ) ), 1 );
+	tmp = _mm_srli_epi32( _mm_add_epi32( _mm_add_epi32( r, b ), _mm_set1_epi32( 2 ) ), 2 );
+	co = _mm_add_epi32( c128, _mm_srai_epi32(
+			_mm_add_epi32( _mm_sub_epi32( r, b ), _mm_set1_epi32( 1 ) ), 1 ) );
+	cg = _mm_sub_epi32( _mm_add_epi32( c128, g ), tmp );
+	y = _mm_add_epi32( g, tmp );
+	co = _mm_sub_epi32( co, _mm_srli_epi32( co, 8 ) );
+	cg = _mm_sub_epi32( cg, _mm_srli_epi32( cg, 8 ) );
+	y = _mm_sub_epi32( y, _mm_srli_epi32( y, 8 ) );
+	return _mm_or_si128(
+			_mm_or_si128( co, _mm_slli_epi32( cg, 8 ) ),
+			_mm_or_si128( _mm_slli_epi32( a, 16 ), _mm_slli_epi32( y, 24 ) ) );
+}
+#endif
+
+#if SOIL_HELPER_AVX2
+/*	two neighbouring RGB or RGBA pixels as 8 floats	*/
+static SOIL_AVX2_FUNCTION __m256
+	load_pixel_pair_AVX2
+	(
+		const unsigned char* p,
+		int channels
+	)
+{
+	unsigned int first = p[0] | (p[1] << 8) | (p[2] << 16);
+	unsigned int second = p[channels] | (p[channels+1] << 8) | (p[channels+2] << 16);
+	if( channels == 4 )
+	{
+		first |= (unsigned int)p[3] << 24;
+		second |= (unsigned int)p[7] << 24;
+	}
+	return _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32(
+			_mm_unpacklo_epi32( _mm_cvtsi32_si128( (int)first ), _mm_cvtsi32_si128( (int)second ) ) ) );
+}
+
+static SOIL_AVX2_FUNCTION __m256
+	pair_AVX2
+	(
+		float first, float second
+	)
+{
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_set1_ps( first ) ), _mm_set1_ps( second ), 1 );
+}
+
+static SOIL_AVX2_FUNCTION void
+	up_scale_row_AVX2
+	(
+		const unsigned char* const row,
+		int width, int channels,
+		unsigned char* resampled_row,
+		int resampled_width,
+		const int* intx, const float* samplex,
+		float sampley
+	)
+{
+	const __m256 sy = _mm256_set1_ps( sampley );
+	const __m256 inv_sy = _mm256_set1_ps( 1.0f - sampley );
+	int x;
+	/*	two output pixels at a time, each with its own x weights	*/
+	for( x = 0; x + 2 <= resampled_width; x += 2 )
+	{
+		const unsigned char* base0 = row + intx[x] * channels;
+		const unsigned char* base1 = row + intx[x+1] * channels;
+		const __m256 sx = pair_AVX2( samplex[x], samplex[x+1] );
+		const __m256 inv_sx = pair_AVX2( 1.0f - samplex[x], 1.0f - samplex[x+1] );
+		__m256 p00, p10, p01, p11, value;
+		__m256i v;
+		/*	pixels [a, a+1] and [b, b+1] from 2 pairs of loads	*/
+		__m256 top0 = load_pixel_pair_AVX2( base0, channels );
+		__m256 top1 = load_pixel_pair_AVX2( base1, channels );
+		__m256 bottom0 = load_pixel_pair_AVX2( base0 + width*channels, channels );
+		__m256 bottom1 = load_pixel_pair_AVX2( base1 + width*channels, channels );
+		p00 = _mm256_permute2f128_ps( top0, top1, 0x20 );
+		p10 = _mm256_permute2f128_ps( top0, top1, 0x31 );
+		p01 = _mm256_permute2f128_ps( bottom0, bottom1, 0x20 );
+		p11 = _mm256_permute2f128_ps( bottom0, bottom1, 0x31 );
+		value = _mm256_set1_ps( 0.5f );
+		value = _mm256_add_ps( value, _mm256_mul_ps( _mm256_mul_ps( p00, inv_sx ), inv_sy ) );
+		value = _mm256_add_ps( value, _mm256_mul_ps( _mm256_mul_ps( p10, sx ), inv_sy ) );
+		value = _mm256_add_ps( value, _mm256_mul_ps( _mm256_mul_ps( p01, inv_sx ), sy ) );
+		value = _mm256_add_ps( value, _mm256_mul_ps( _mm256_mul_ps( p11, sx ), sy ) );
+		v = _mm256_cvttps_epi32( value );
+		{
+			__m128i both = _mm_packs_epi32( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ) );
+			unsigned char out[8];
+			both = _mm_packus_epi16( both, both );
+			_mm_storel_epi64( (__m128i*)out, both );
+			memcpy( resampled_row + x*channels, out, channels );
+			memcpy( resampled_row + (x+1)*channels, out + 4, channels );
+		}
+	}
+	if( x < resampled_width )
+	{
+		up_scale_row_SSE2( row, width, channels, resampled_row + x*channels,
+				resampled_width - x, intx + x, samplex + x, sampley );
+	}
+}
+
+static SOIL_AVX2_FUNCTION int
+	add_row_AVX2
+	(
+		const unsigned char* row,
+		unsigned short* sums,
+		int count
+	)
+{
+	int i;
+	for( i = 0; i + 32 <= count; i += 32 )
+	{
+		__m128i v0 = _mm_loadu_si128( (const __m128i*)(row + i) );
+		__m128i v1 = _mm_loadu_si128( (const __m128i*)(row + i + 16) );
+		__m256i lo = _mm256_loadu_si256( (const __m256i*)(sums + i) );
+		__m256i hi = _mm256_loadu_si256( (const __m256i*)(sums + i + 16) );
+		lo = _mm256_add_epi16( lo, _mm256_cvtepu8_epi16( v0 ) );
+		hi = _mm256_add_epi16( hi, _mm256_cvtepu8_epi16( v1 ) );
+		_mm256_storeu_si256( (__m256i*)(sums + i), lo );
+		_mm256_storeu_si256( (__m256i*)(sums + i + 16), hi );
+	}
+	return i + add_row_SSE2( row + i, sums + i, count - i );
+}
+
+/*	the 256 bit unpacks and packs both work within 128 bit lanes, so the bytes come back in order	*/
+static SOIL_AVX2_FUNCTION void
+	NTSC_safe_AVX2
+	(
+		unsigned char* data,
+		int count,
+		__m128i keep128
+	)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi16( 1 );
+	const __m256i k = _mm256_set1_epi32( (SOIL_NTSC_ADD << 16) | SOIL_NTSC_MUL );
+	const __m256i keep = _mm256_broadcastsi128_si256( keep128 );
+	int i;
+	for( i = 0; i + 32 <= count; i += 32 )
+	{
+		__m256i v = _mm256_loadu_si256( (const __m256i*)(data + i) );
+		__m256i lo = _mm256_unpacklo_epi8( v, zero );
+		__m256i hi = _mm256_unpackhi_epi8( v, zero );
+		__m256i a, b, scaled;
+		a = _mm256_srli_epi32( _mm256_madd_epi16( _mm256_unpacklo_epi16( lo, one ), k ), SOIL_NTSC_SHIFT );
+		b = _mm256_srli_epi32( _mm256_madd_epi16( _mm256_unpackhi_epi16( lo, one ), k ), SOIL_NTSC_SHIFT );
+		lo = _mm256_packs_epi32( a, b );
+		a = _mm256_srli_epi32( _mm256_madd_epi16( _mm256_unpacklo_epi16( hi, one ), k ), SOIL_NTSC_SHIFT );
+		b = _mm256_srli_epi32( _mm256_madd_epi16( _mm256_unpackhi_epi16( hi, one ), k ), SOIL_NTSC_SHIFT );
+		hi = _mm256_packs_epi32( a, b );
+		scaled = _mm256_packus_epi16( lo, hi );
+		_mm256_storeu_si256( (__m256i*)(data + i),
+				_mm256_blendv_epi8( scaled, v, keep ) );
+	}
+	for( ; i + 16 <= count; i += 16 )
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*)(data + i) );
+		_mm_storeu_si128( (__m128i*)(data + i), NTSC_safe_SSE2( v, keep128 ) );
+	}
+}
+
+static SOIL_AVX2_FUNCTION void
+	RGBA_to_CoCgAY_AVX2
+	(
+		unsigned char* data,
+		int pixels
+	)
+{
+	const __m256i mask = _mm256_set1_epi32( 0xFF );
+	const __m256i c128 = _mm256_set1_epi32( 128 );
+	const __m256i c1 = _mm256_set1_epi32( 1 );
+	const __m256i c2 = _mm256_set1_epi32( 2 );
+	int i;
+	for( i = 0; i + 8 <= pixels; i += 8 )
+	{
+		__m256i v = _mm256_loadu_si256( (const __m256i*)(data + i*4) );
+		__m256i r = _mm256_and_si256( v, mask );
+		__m256i g = _mm256_and_si256( _mm256_srli_epi32( v, 8 ), mask );
+		__m256i b = _mm256_and_si256( _mm256_srli_epi32( v, 16 ), mask );
+		__m256i a = _mm256_srli_epi32( v, 24 );
+		__m256i tmp, co, cg, y;
+		g = _mm256_srli_epi32( _mm256_add_epi32( g, c1 ), 1 );
+		tmp = _mm256_srli_epi32( _mm256_add_epi32( _mm256_add_epi32( r, b ), c2 ), 2 );
+		co = _mm256_add_epi32( c128, _mm256_srai_epi32(
+				_mm256_add_epi32( _mm256_sub_epi32( r, b ), c1 ), 1 ) );
+		cg = _mm256_sub_epi32( _mm256_add_epi32( c128, g ), tmp );
+		y = _mm256_add_epi32( g, tmp );
+		co = _mm256_min_epi32( co, mask );
+		cg = _mm256_min_epi32( cg, mask );
+		y = _mm256_min_epi32( y, mask );
+		_mm256_storeu_si256( (__m256i*)(data + i*4), _mm256_or_si256(
+				_mm256_or_si256( co, _mm256_slli_epi32( cg, 8 ) ),
+				_mm256_or_si256( _mm256_slli_epi32( a, 16 ), _mm256_slli_epi32( y, 24 ) ) ) );
+	}
+	for( ; i + 4 <= pixels; i += 4 )
+	{
+		__m128i v = _mm_loadu_si128( (const __m128i*)(data + i*4) );
+		_mm_storeu_si128( (__m128i*)(data + i*4), RGBA_to_CoCgAY_SSE2( v ) );
+	}
+}
+#endif
+
 /*	Upscaling the image uses simple bilinear interpolation	*/
 int
 	up_scale_image
@@ -38,6 +499,51 @@ int
 	*/
     dx = (width - 1.0f) / (resampled_width - 1.0f);
     dy = (height - 1.0f) / (resampled_height - 1.0f);
+#if SOIL_HELPER_SSE2
+	/*	RGB(A) does all channels of a pixel at once	*/
+	if( ((channels == 3) || (channels == 4)) &&
+		(width >= 2) && (height >= 2) &&
+		(image_helper_SIMD_level() >= SOIL_SIMD_SSE2) )
+	{
+		int *intx = (int*)malloc( resampled_width * sizeof(int) );
+		float *samplex = (float*)malloc( resampled_width * sizeof(float) );
+		if( (NULL != intx) && (NULL != samplex) )
+		{
+			/*	the x positions are the same for every row	*/
+			for ( x = 0; x < resampled_width; ++x )
+			{
+				samplex[x] = x * dx;
+				intx[x] = (int)samplex[x];
+				if( intx[x] > width - 2 ) { intx[x] = width - 2; }
+				samplex[x] -= intx[x];
+			}
+			for ( y = 0; y < resampled_height; ++y )
+			{
+				float sampley = y * dy;
+				int inty = (int)sampley;
+				if( inty > height - 2 ) { inty = height - 2; }
+				sampley -= inty;
+#if SOIL_HELPER_AVX2
+				if( image_helper_SIMD_level() >= SOIL_SIMD_AVX2 )
+				{
+					up_scale_row_AVX2( orig + inty*width*channels, width, channels,
+							resampled + y*resampled_width*channels, resampled_width,
+							intx, samplex, sampley );
+					continue;
+				}
+#endif
+				up_scale_row_SSE2( orig + inty*width*channels, width, channels,
+						resampled + y*resampled_width*channels, resampled_width,
+						intx, samplex, sampley );
+			}
+			free( intx );
+			free( samplex );
+			return 1;
+		}
+		free( intx );
+		free( samplex );
+	}
+#endif
     for ( y = 0; y < resampled_height; ++y )
     {
     	/* find the base y index and fractional offset from that	*/
@@ -92,6 +598,11 @@ int
 {
 	int mip_width, mip_height;
 	int i, j, c;
+	/*	blocks already done with SIMD	*/
+	int full_width = 0, full_height = 0;
+#if SOIL_HELPER_SSE2
+	unsigned short *sums = NULL;
+#endif
 
 	/*	error check	*/
 	if( (width < 1) || (height < 1) ||
@@ -112,10 +623,84 @@ int
 	{
 		mip_height = 1;
 	}
+#if SOIL_HELPER_SSE2
+	/*	blocks that lie fully inside the image: add each block's rows
+		into column sums with SIMD, then add up the columns	*/
+	if( (block_size_y <= SOIL_MIPMAP_MAX_SIMD_ROWS) &&
+		(image_helper_SIMD_level() >= SOIL_SIMD_SSE2) )
+	{
+		full_width = width / block_size_x;
+		full_height = height / block_size_y;
+		if( full_width > mip_width )
+		{
+			full_width = mip_width;
+		}
+		if( full_height > mip_height )
+		{
+			full_height = mip_height;
+		}
+		sums = (unsigned short*)malloc( full_width * block_size_x * channels * sizeof(unsigned short) + 1 );
+		if( NULL == sums )
+		{
+			full_width = full_height = 0;
+		}
+	}
+	for( j = 0; j < full_height; ++j )
+	{
+		const int count = full_width * block_size_x * channels;
+		const int block_area = block_size_x * block_size_y;
+		int shift = 0;
+		int v;
+		while( (1 << shift) < block_area )
+		{
+			++shift;
+		}
+		memset( sums, 0, count * sizeof(unsigned short) );
+		for( v = 0; v < block_size_y; ++v )
+		{
+			const unsigned char *row = orig + (j*block_size_y + v)*width*channels;
+			int done;
+#if SOIL_HELPER_AVX2
+			if( image_helper_SIMD_level() >= SOIL_SIMD_AVX2 )
+			{
+				done = add_row_AVX2( row, sums, count );
+			} else
+#endif
+			{
+				done = add_row_SSE2( row, sums, count );
+			}
+			for( ; done < count; ++done )
+			{
+				sums[done] += row[done];
+			}
+		}
+		for( i = 0; i < full_width; ++i )
+		{
+			for( c = 0; c < channels; ++c )
+			{
+				const unsigned short *column = sums + (i*block_size_x)*channels + c;
+				int sum_value = block_area >> 1;
+				int u;
+				for( u = 0; u < block_size_x; ++u )
+				{
+					sum_value += column[u*channels];
+				}
+				resampled[j*mip_width*channels + i*channels + c] =
+						((1 << shift) == block_area) ? (sum_value >> shift) : (sum_value / block_area);
+			}
+		}
+	}
+	free( sums );
+#endif
 	for( j = 0; j < mip_height; ++j )
 	{
 		for( i = 0; i < mip_width; ++i )
 		{
+			if( (j < full_height) && (i < full_width) )
+			{
+				/*	already done above	*/
+				continue;
+			}
 			for( c = 0; c < channels; ++c )
 			{
 				const int index = (j*block_size_y)*width*channels + (i*block_size_x)*channels + c;
@@ -177,6 +762,52 @@ int
 	}
 	/*	for channels = 2 or 4, ignore the alpha component	*/
 	nc -= 1 - (channels & 1);
+#if SOIL_HELPER_SSE2
+	for( j = 0; j < 256; ++j )
+	{
+		if( scale_LUT[j] != ((j*SOIL_NTSC_MUL + SOIL_NTSC_ADD) >> SOIL_NTSC_SHIFT) )
+		{
+			break;
+		}
+	}
+	if( (j == 256) && (channels <= 4) &&
+		(image_helper_SIMD_level() >= SOIL_SIMD_SSE2) )
+	{
+		/*	16 bytes is a whole number of 1, 2 or 4 channel pixels, so the
+			alpha bytes sit at the same place in every chunk	*/
+		const int count = width*height*channels;
+		unsigned char keep_bytes[16];
+		__m128i keep;
+		for( j = 0; j < 16; ++j )
+		{
+			keep_bytes[j] = ((channels == 2) || (channels == 4)) && ((j % channels) == channels - 1) ? 0xFF : 0;
+		}
+		keep = _mm_loadu_si128( (const __m128i*)keep_bytes );
+		/*	3 channels has no alpha, so it does not matter where a chunk starts	*/
+#if SOIL_HELPER_AVX2
+		if( image_helper_SIMD_level() >= SOIL_SIMD_AVX2 )
+		{
+			NTSC_safe_AVX2( orig, count, keep );
+		} else
+#endif
+		{
+			for( i = 0; i + 16 <= count; i += 16 )
+			{
+				__m128i v = _mm_loadu_si128( (const __m128i*)(orig + i) );
+				_mm_storeu_si128( (__m128i*)(orig + i), NTSC_safe_SSE2( v, keep ) );
+			}
+		}
+		/*	the leftover bytes (always whole pixels) go through the table	*/
+		for( i = count & ~15; i < count; ++i )
+		{
+			if( (nc == channels) || ((i % channels) != channels - 1) )
+			{
+				orig[i] = scale_LUT[orig[i]];
+			}
+		}
+		return 1;
+	}
+#endif
 	/*	OK, go through the image and scale any non-alpha components	*/
 	for( i = 0; i < width*height*channels; i += channels )
 	{
@@ -231,7 +862,25 @@ int
 		}
 	} else
 	{
-		for( i = 0; i < width*height*4; i += 4 )
+		i = 0;
+#if SOIL_HELPER_SSE2
+#if SOIL_HELPER_AVX2
+		if( image_helper_SIMD_level() >= SOIL_SIMD_AVX2 )
+		{
+			RGBA_to_CoCgAY_AVX2( orig, width*height );
+			i = (width*height & ~3) * 4;
+		} else
+#endif
+		if( image_helper_SIMD_level() >= SOIL_SIMD_SSE2 )
+		{
+			for( ; i + 16 <= width*height*4; i += 16 )
+			{
+				__m128i v = _mm_loadu_si128( (const __m128i*)(orig + i) );
+				_mm_storeu_si128( (__m128i*)(orig + i), RGBA_to_CoCgAY_SSE2( v ) );
+			}
+		}
+#endif
+		for( ; i < width*height*4; i += 4 )
 		{
 			int r = orig[i+0];
 			int g = (orig[i+1] + 1) >> 1;
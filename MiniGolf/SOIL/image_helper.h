@@ -108,6 +108,19 @@ int
 		int rescale_to_max
 	);
 
+/**
+	Caps the instruction set the functions above may use:
+	0 for plain C, 1 for SSE2, 2 for AVX2 (the default).
+	Returns the level now in use, which is lower than asked
+	for when the compiler or CPU does not have it.  Meant for
+	tests that compare each SIMD path with the plain C one.
+**/
+int
+	image_helper_limit_SIMD
+	(
+		int max_level
+	);
+
 #ifdef __cplusplus
 }
 #endif
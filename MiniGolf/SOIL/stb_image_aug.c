@@ -14,6 +14,9 @@
       writes BMP,TGA (define STBI_NO_WRITE to remove code)
       decoded from memory or through stdio FILE (define STBI_NO_STDIO to remove code)
       supports installable dequantizing-IDCT, YCbCr-to-RGB conversion (define STBI_SIMD)
+      otherwise uses SSE2 for the JPEG IDCT and YCbCr-to-RGB (define STBI_NO_SSE2 to remove code)
+      large JPEGs decode on several threads (define STBI_NO_THREADS to remove code,
+         or call stbi_set_thread_count(1) to turn it off at run time)
 
    TODO:
       stbi_info_*
@@ -78,6 +81,25 @@
 #include <assert.h>
 #include <stdarg.h>
 
+#ifndef STBI_NO_THREADS
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#endif
+
+// SSE2 is always there on x64, and on x86 when the compiler was told it may use it;
+// an installed STBI_SIMD IDCT/colour converter takes precedence
+#if !STBI_SIMD && !defined(STBI_NO_SSE2)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define STBI_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
 #ifndef _MSC_VER
   #ifdef __cplusplus
   #define __forceinline inline
@@ -351,6 +373,10 @@ enum
    SCAN_header,
 };
 
+// files are read through a buffer in the stbi itself, so decoders can keep
+// pulling single bytes without a stdio call for each one
+#define STBI_FILE_BUFFER_SIZE  4096
+
 typedef struct
 {
    uint32 img_x, img_y;
@@ -358,6 +384,7 @@ typedef struct
 
    #ifndef STBI_NO_STDIO
    FILE  *img_file;
+   uint8 file_buffer[STBI_FILE_BUFFER_SIZE];
    #endif
    uint8 *img_buffer, *img_buffer_end;
 } stbi;
@@ -366,6 +393,24 @@ typedef struct
 static void start_file(stbi *s, FILE *f)
 {
    s->img_file = f;
+   s->img_buffer = s->img_buffer_end = s->file_buffer;
+}
+
+// give back what was buffered but not used, so the FILE is left just past
+// the image, as it was when every byte came from fgetc
+static void end_file(stbi *s)
+{
+   if (s->img_buffer < s->img_buffer_end)
+      fseek(s->img_file, -(long) (s->img_buffer_end - s->img_buffer), SEEK_CUR);
+   s->img_buffer = s->img_buffer_end = s->file_buffer;
+}
+
+static int refill_buffer(stbi *s)
+{
+   int n = (int) fread(s->file_buffer, 1, STBI_FILE_BUFFER_SIZE, s->img_file);
+   s->img_buffer = s->file_buffer;
+   s->img_buffer_end = s->file_buffer + n;
+   return n;
 }
 #endif
 
@@ -380,22 +425,20 @@ static void start_mem(stbi *s, uint8 const *buffer, int len)
 
 __forceinline static int get8(stbi *s)
 {
-#ifndef STBI_NO_STDIO
-   if (s->img_file) {
-      int c = fgetc(s->img_file);
-      return c == EOF ? 0 : c;
-   }
-#endif
    if (s->img_buffer < s->img_buffer_end)
       return *s->img_buffer++;
+#ifndef STBI_NO_STDIO
+   if (s->img_file && refill_buffer(s))
+      return *s->img_buffer++;
+#endif
    return 0;
 }
 
 __forceinline static int at_eof(stbi *s)
 {
 #ifndef STBI_NO_STDIO
-   if (s->img_file)
-      return feof(s->img_file);
+   if (s->img_file && s->img_buffer >= s->img_buffer_end)
+      return !refill_buffer(s);
 #endif
    return s->img_buffer >= s->img_buffer_end;
 }
@@ -408,11 +451,17 @@ __forceinline static uint8 get8u(stbi *s)
 static void skip(stbi *s, int n)
 {
 #ifndef STBI_NO_STDIO
-   if (s->img_file)
-      fseek(s->img_file, n, SEEK_CUR);
-   else
+   if (s->img_file) {
+      int left = (int) (s->img_buffer_end - s->img_buffer);
+      if (n < 0 || n > left) {
+         // the FILE is at the end of the buffer, 'left' bytes past us
+         fseek(s->img_file, n - left, SEEK_CUR);
+         s->img_buffer = s->img_buffer_end = s->file_buffer;
+         return;
+      }
+   }
 #endif
-      s->img_buffer += n;
+   s->img_buffer += n;
 }
 
 static int get16(stbi *s)
@@ -439,16 +488,34 @@ static uint32 get32le(stbi *s)
    return z + (get16le(s) << 16);
 }
 
-static void getn(stbi *s, stbi_uc *buffer, int n)
+// returns 0 if the image ran out first
+static int getn(stbi *s, stbi_uc *buffer, int n)
 {
 #ifndef STBI_NO_STDIO
    if (s->img_file) {
-      fread(buffer, 1, n, s->img_file);
-      return;
+      int left = (int) (s->img_buffer_end - s->img_buffer);
+      if (n <= left) {
+         memcpy(buffer, s->img_buffer, n);
+         s->img_buffer += n;
+         return 1;
+      }
+      // large reads go straight from the FILE into the destination
+      memcpy(buffer, s->img_buffer, left);
+      s->img_buffer = s->img_buffer_end = s->file_buffer;
+      return (int) fread(buffer+left, 1, n-left, s->img_file) == n-left;
    }
 #endif
+   if (s->img_buffer+n > s->img_buffer_end) {
+      // don't read past the caller's buffer; what is missing reads as 0, like get8
+      int left = (int) (s->img_buffer_end - s->img_buffer);
+      memcpy(buffer, s->img_buffer, left);
+      memset(buffer+left, 0, n-left);
+      s->img_buffer = s->img_buffer_end;
+      return 0;
+   }
    memcpy(buffer, s->img_buffer, n);
    s->img_buffer += n;
+   return 1;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -556,6 +623,105 @@ static stbi_uc *hdr_to_ldr(float   *data, int x, int y, int comp)
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//  running independent pieces of a decode on several threads
+//
+
+// most threads one decode may use; 0 means one per processor
+static int stbi_thread_limit = 0;
+
+void stbi_set_thread_count(int count)
+{
+   stbi_thread_limit = count < 0 ? 0 : count;
+}
+
+#ifndef STBI_NO_THREADS
+
+// large images are split across at most this many threads, and each thread
+// gets at least this many pixels' worth of work
+#define STBI_MAX_THREADS        32
+#define STBI_THREAD_MIN_PIXELS  (256*256)
+
+typedef void (*stbi_work_func)(void *work);
+
+typedef struct
+{
+   stbi_work_func func;
+   void *work;
+} stbi_thread_work;
+
+#ifdef WIN32
+static DWORD WINAPI stbi_thread_main(LPVOID work)
+{
+   stbi_thread_work *w = (stbi_thread_work *) work;
+   w->func(w->work);
+   return 0;
+}
+#else
+static void *stbi_thread_main(void *work)
+{
+   stbi_thread_work *w = (stbi_thread_work *) work;
+   w->func(w->work);
+   return NULL;
+}
+#endif
+
+// how many threads an image of this many pixels is worth
+static int stbi_thread_count(uint32 pixels)
+{
+   int count;
+#ifdef WIN32
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   count = (int) info.dwNumberOfProcessors;
+#else
+   count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+   if (stbi_thread_limit > 0 && count > stbi_thread_limit) count = stbi_thread_limit;
+   if (count > STBI_MAX_THREADS) count = STBI_MAX_THREADS;
+   if ((uint32) count > pixels / STBI_THREAD_MIN_PIXELS) count = (int) (pixels / STBI_THREAD_MIN_PIXELS);
+   return count < 1 ? 1 : count;
+}
+
+// call func on each of the count items of size bytes at work; the calling
+// thread takes the first, and any thread that can't be started is done here
+static void stbi_run_parallel(stbi_work_func func, void *work, int size, int count)
+{
+   stbi_thread_work threads[STBI_MAX_THREADS];
+#ifdef WIN32
+   HANDLE handles[STBI_MAX_THREADS];
+#else
+   pthread_t handles[STBI_MAX_THREADS];
+#endif
+   int started[STBI_MAX_THREADS];
+   int i;
+   for (i=1; i < count; ++i) {
+      threads[i].func = func;
+      threads[i].work = (char *) work + i*size;
+#ifdef WIN32
+      handles[i] = CreateThread(NULL, 0, stbi_thread_main, &threads[i], 0, NULL);
+      started[i] = (handles[i] != NULL);
+#else
+      started[i] = (pthread_create(&handles[i], NULL, stbi_thread_main, &threads[i]) == 0);
+#endif
+   }
+   func(work);
+   for (i=1; i < count; ++i) {
+      if (!started[i]) {
+         func(threads[i].work);
+         continue;
+      }
+#ifdef WIN32
+      WaitForSingleObject(handles[i], INFINITE);
+      CloseHandle(handles[i]);
+#else
+      pthread_join(handles[i], NULL);
+#endif
+   }
+}
+#endif // STBI_NO_THREADS
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //  "baseline" JPEG/JFIF decoder (not actually fully baseline implementation)
@@ -870,6 +1036,116 @@ __forceinline static uint8 clamp(int x)
    t1 += p2+p4;                                \
    t0 += p1+p3;
 
+#ifdef STBI_SSE2
+// IDCT_1D on eight columns (or rows) at once, one per 16-bit lane. Every
+// product IDCT_1D forms is a sum over the inputs, so each output is built
+// from _mm_madd_epi16 on input pairs with the constants folded together;
+// the 32-bit sums are exactly the integers IDCT_1D computes.
+#define madd_const(a,b)  _mm_setr_epi16((short) (a),(short) (b),(short) (a),(short) (b),(short) (a),(short) (b),(short) (a),(short) (b))
+
+static void idct_1d_sse2(__m128i out[8][2], __m128i const s[8], __m128i bias, __m128i shift)
+{
+   __m128i p04[2],p26[2],p13[2],p57[2];
+   int h;
+   p04[0] = _mm_unpacklo_epi16(s[0],s[4]);   p04[1] = _mm_unpackhi_epi16(s[0],s[4]);
+   p26[0] = _mm_unpacklo_epi16(s[2],s[6]);   p26[1] = _mm_unpackhi_epi16(s[2],s[6]);
+   p13[0] = _mm_unpacklo_epi16(s[1],s[3]);   p13[1] = _mm_unpackhi_epi16(s[1],s[3]);
+   p57[0] = _mm_unpacklo_epi16(s[5],s[7]);   p57[1] = _mm_unpackhi_epi16(s[5],s[7]);
+   for (h=0; h < 2; ++h) {
+      // even part
+      __m128i t2 = _mm_madd_epi16(p26[h], madd_const(f2f(0.5411961f), f2f(0.5411961f) + f2f(-1.847759065f)));
+      __m128i t3 = _mm_madd_epi16(p26[h], madd_const(f2f(0.5411961f) + f2f( 0.765366865f), f2f(0.5411961f)));
+      __m128i t0 = _mm_add_epi32(_mm_madd_epi16(p04[h], madd_const(4096, 4096)), bias);
+      __m128i t1 = _mm_add_epi32(_mm_madd_epi16(p04[h], madd_const(4096,-4096)), bias);
+      __m128i x0 = _mm_add_epi32(t0,t3), x3 = _mm_sub_epi32(t0,t3);
+      __m128i x1 = _mm_add_epi32(t1,t2), x2 = _mm_sub_epi32(t1,t2);
+      // odd part; o0..o3 are t0..t3 at the end of IDCT_1D
+      __m128i o3 = _mm_add_epi32(
+         _mm_madd_epi16(p13[h], madd_const(f2f(1.501321110f) + f2f(1.175875602f) + f2f(-0.899976223f) + f2f(-0.390180644f), f2f(1.175875602f))),
+         _mm_madd_epi16(p57[h], madd_const(f2f(1.175875602f) + f2f(-0.390180644f), f2f(1.175875602f) + f2f(-0.899976223f))));
+      __m128i o2 = _mm_add_epi32(
+         _mm_madd_epi16(p13[h], madd_const(f2f(1.175875602f), f2f(3.072711026f) + f2f(1.175875602f) + f2f(-2.562915447f) + f2f(-1.961570560f))),
+         _mm_madd_epi16(p57[h], madd_const(f2f(1.175875602f) + f2f(-2.562915447f), f2f(1.175875602f) + f2f(-1.961570560f))));
+      __m128i o1 = _mm_add_epi32(
+         _mm_madd_epi16(p13[h], madd_const(f2f(1.175875602f) + f2f(-0.390180644f), f2f(1.175875602f) + f2f(-2.562915447f))),
+         _mm_madd_epi16(p57[h], madd_const(f2f(2.053119869f) + f2f(1.175875602f) + f2f(-2.562915447f) + f2f(-0.390180644f), f2f(1.175875602f))));
+      __m128i o0 = _mm_add_epi32(
+         _mm_madd_epi16(p13[h], madd_const(f2f(1.175875602f) + f2f(-0.899976223f), f2f(1.175875602f) + f2f(-1.961570560f))),
+         _mm_madd_epi16(p57[h], madd_const(f2f(1.175875602f), f2f(0.298631336f) + f2f(1.175875602f) + f2f(-0.899976223f) + f2f(-1.961570560f))));
+      out[0][h] = _mm_sra_epi32(_mm_add_epi32(x0,o3), shift);
+      out[7][h] = _mm_sra_epi32(_mm_sub_epi32(x0,o3), shift);
+      out[1][h] = _mm_sra_epi32(_mm_add_epi32(x1,o2), shift);
+      out[6][h] = _mm_sra_epi32(_mm_sub_epi32(x1,o2), shift);
+      out[2][h] = _mm_sra_epi32(_mm_add_epi32(x2,o1), shift);
+      out[5][h] = _mm_sra_epi32(_mm_sub_epi32(x2,o1), shift);
+      out[3][h] = _mm_sra_epi32(_mm_add_epi32(x3,o0), shift);
+      out[4][h] = _mm_sra_epi32(_mm_sub_epi32(x3,o0), shift);
+   }
+}
+
+static void transpose_sse2(__m128i r[8])
+{
+   __m128i a0 = _mm_unpacklo_epi16(r[0],r[1]), a1 = _mm_unpackhi_epi16(r[0],r[1]);
+   __m128i a2 = _mm_unpacklo_epi16(r[2],r[3]), a3 = _mm_unpackhi_epi16(r[2],r[3]);
+   __m128i a4 = _mm_unpacklo_epi16(r[4],r[5]), a5 = _mm_unpackhi_epi16(r[4],r[5]);
+   __m128i a6 = _mm_unpacklo_epi16(r[6],r[7]), a7 = _mm_unpackhi_epi16(r[6],r[7]);
+   __m128i b0 = _mm_unpacklo_epi32(a0,a2), b1 = _mm_unpackhi_epi32(a0,a2);
+   __m128i b2 = _mm_unpacklo_epi32(a1,a3), b3 = _mm_unpackhi_epi32(a1,a3);
+   __m128i b4 = _mm_unpacklo_epi32(a4,a6), b5 = _mm_unpackhi_epi32(a4,a6);
+   __m128i b6 = _mm_unpacklo_epi32(a5,a7), b7 = _mm_unpackhi_epi32(a5,a7);
+   r[0] = _mm_unpacklo_epi64(b0,b4);   r[1] = _mm_unpackhi_epi64(b0,b4);
+   r[2] = _mm_unpacklo_epi64(b1,b5);   r[3] = _mm_unpackhi_epi64(b1,b5);
+   r[4] = _mm_unpacklo_epi64(b2,b6);   r[5] = _mm_unpackhi_epi64(b2,b6);
+   r[6] = _mm_unpacklo_epi64(b3,b7);   r[7] = _mm_unpackhi_epi64(b3,b7);
+}
+
+// same output as idct_block, 8 lanes at a time; the pairwise products need
+// 16-bit inputs, so returns 0 (and writes nothing) for the rare block whose
+// dequantized coefficients or first-pass results don't fit in 16 bits
+static int idct_block_sse2(uint8 *out, int out_stride, short data[64], uint8 *dequantize)
+{
+   __m128i zero = _mm_setzero_si128();
+   __m128i bad = zero;
+   __m128i row[8], val[8][2];
+   int i;
+
+   // dequantize; mulhi is the sign extension of mullo exactly when the product fits
+   for (i=0; i < 8; ++i) {
+      __m128i d  = _mm_loadu_si128((__m128i const *) (data + i*8));
+      __m128i dq = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i const *) (dequantize + i*8)), zero);
+      row[i] = _mm_mullo_epi16(d, dq);
+      bad = _mm_or_si128(bad, _mm_xor_si128(_mm_mulhi_epi16(d, dq), _mm_srai_epi16(row[i], 15)));
+   }
+
+   // columns, keeping 2 extra bits of precision; the all-zero-AC shortcut in
+   // idct_block gives the same values as the full transform, so none is needed
+   idct_1d_sse2(val, row, _mm_set1_epi32(512), _mm_cvtsi32_si128(10));
+   for (i=0; i < 8; ++i) {
+      bad = _mm_or_si128(bad, _mm_xor_si128(_mm_srai_epi32(val[i][0], 15), _mm_srai_epi32(val[i][0], 31)));
+      bad = _mm_or_si128(bad, _mm_xor_si128(_mm_srai_epi32(val[i][1], 15), _mm_srai_epi32(val[i][1], 31)));
+      row[i] = _mm_packs_epi32(val[i][0], val[i][1]);
+   }
+   if (_mm_movemask_epi8(_mm_cmpeq_epi8(bad, zero)) != 0xffff) return 0;
+
+   // rows; lanes are now the rows of the block
+   transpose_sse2(row);
+   idct_1d_sse2(val, row, _mm_set1_epi32(65536), _mm_cvtsi32_si128(17));
+   for (i=0; i < 8; ++i) {
+      __m128i c128 = _mm_set1_epi32(128);
+      row[i] = _mm_packs_epi32(_mm_add_epi32(val[i][0], c128), _mm_add_epi32(val[i][1], c128));
+   }
+   transpose_sse2(row);
+
+   // packus is clamp()
+   for (i=0; i < 8; i += 2) {
+      __m128i p = _mm_packus_epi16(row[i], row[i+1]);
+      _mm_storel_epi64((__m128i *) (out + out_stride*i), p);
+      _mm_storel_epi64((__m128i *) (out + out_stride*(i+1)), _mm_srli_si128(p, 8));
+   }
+   return 1;
+}
+#endif
+
 #if !STBI_SIMD
 // .344 seconds on 3*anemones.jpg
 static void idct_block(uint8 *out, int out_stride, short data[64], uint8 *dequantize)
@@ -878,6 +1154,10 @@ static void idct_block(uint8 *out, int out_stride, short data[64], uint8 *dequan
    uint8 *o,*dq = dequantize;
    short *d = data;
 
+   #ifdef STBI_SSE2
+   if (idct_block_sse2(out, out_stride, data, dequantize)) return;
+   #endif
+
    // columns
    for (i=0; i < 8; ++i,++d,++dq, ++v) {
       // if all zeroes, shortcut -- this avoids dequantizing 0s and IDCTing
@@ -1017,78 +1297,165 @@ static void reset(jpeg *j)
    // since we don't even allow 1<<30 pixels
 }
 
-static int parse_entropy_coded_data(jpeg *z)
+// decode MCUs [first,last) of the scan, in scan order, counting down the
+// restart interval as it goes. Returns 0 on error, and 2 if it stopped early
+// because an interval didn't end in a restart marker.
+static int decode_mcus(jpeg *z, int first, int last)
 {
-   reset(z);
-   if (z->scan_n == 1) {
-      int i,j;
-      #if STBI_SIMD
-      __declspec(align(16))
-      #endif
-      short data[64];
-      int n = z->order[0];
-      // non-interleaved data, we just need to process one block at a time,
-      // in trivial scanline order
-      // number of blocks to do just depends on how many actual "pixels" this
-      // component has, independent of interleaved MCU blocking and such
-      int w = (z->img_comp[n].x+7) >> 3;
-      int h = (z->img_comp[n].y+7) >> 3;
-      for (j=0; j < h; ++j) {
-         for (i=0; i < w; ++i) {
-            if (!decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+z->img_comp[n].ha, n)) return 0;
-            #if STBI_SIMD
-            stbi_idct_installed(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data, z->dequant2[z->img_comp[n].tq]);
-            #else
-            idct_block(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data, z->dequant[z->img_comp[n].tq]);
-            #endif
-            // every data block is an MCU, so countdown the restart interval
-            if (--z->todo <= 0) {
-               if (z->code_bits < 24) grow_buffer_unsafe(z);
-               // if it's NOT a restart, then just bail, so we get corrupt data
-               // rather than no data
-               if (!RESTART(z->marker)) return 1;
-               reset(z);
-            }
-         }
-      }
-   } else { // interleaved!
-      int i,j,k,x,y;
-      short data[64];
-      for (j=0; j < z->img_mcu_y; ++j) {
-         for (i=0; i < z->img_mcu_x; ++i) {
-            // scan an interleaved mcu... process scan_n components in order
-            for (k=0; k < z->scan_n; ++k) {
-               int n = z->order[k];
-               // scan out an mcu's worth of this component; that's just determined
-               // by the basic H and V specified for the component
-               for (y=0; y < z->img_comp[n].v; ++y) {
-                  for (x=0; x < z->img_comp[n].h; ++x) {
-                     int x2 = (i*z->img_comp[n].h + x)*8;
-                     int y2 = (j*z->img_comp[n].v + y)*8;
-                     if (!decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+z->img_comp[n].ha, n)) return 0;
-                     #if STBI_SIMD
-                     stbi_idct_installed(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data, z->dequant2[z->img_comp[n].tq]);
-                     #else
-                     idct_block(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data, z->dequant[z->img_comp[n].tq]);
-                     #endif
-                  }
+   int m;
+   for (m=first; m < last; ++m) {
+      if (z->scan_n == 1) {
+         #if STBI_SIMD
+         __declspec(align(16))
+         #endif
+         short data[64];
+         int n = z->order[0];
+         // non-interleaved data, we just need to process one block at a time,
+         // in trivial scanline order
+         // number of blocks to do just depends on how many actual "pixels" this
+         // component has, independent of interleaved MCU blocking and such
+         int w = (z->img_comp[n].x+7) >> 3;
+         int i = m % w, j = m / w;
+         if (!decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+z->img_comp[n].ha, n)) return 0;
+         #if STBI_SIMD
+         stbi_idct_installed(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data, z->dequant2[z->img_comp[n].tq]);
+         #else
+         idct_block(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data, z->dequant[z->img_comp[n].tq]);
+         #endif
+         // every data block is an MCU, so countdown the restart interval
+      } else { // interleaved!
+         int k,x,y;
+         short data[64];
+         int i = m % z->img_mcu_x, j = m / z->img_mcu_x;
+         // scan an interleaved mcu... process scan_n components in order
+         for (k=0; k < z->scan_n; ++k) {
+            int n = z->order[k];
+            // scan out an mcu's worth of this component; that's just determined
+            // by the basic H and V specified for the component
+            for (y=0; y < z->img_comp[n].v; ++y) {
+               for (x=0; x < z->img_comp[n].h; ++x) {
+                  int x2 = (i*z->img_comp[n].h + x)*8;
+                  int y2 = (j*z->img_comp[n].v + y)*8;
+                  if (!decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+z->img_comp[n].ha, n)) return 0;
+                  #if STBI_SIMD
+                  stbi_idct_installed(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data, z->dequant2[z->img_comp[n].tq]);
+                  #else
+                  idct_block(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data, z->dequant[z->img_comp[n].tq]);
+                  #endif
                }
             }
-            // after all interleaved components, that's an interleaved MCU,
-            // so now count down the restart interval
-            if (--z->todo <= 0) {
-               if (z->code_bits < 24) grow_buffer_unsafe(z);
-               // if it's NOT a restart, then just bail, so we get corrupt data
-               // rather than no data
-               if (!RESTART(z->marker)) return 1;
-               reset(z);
-            }
          }
+         // after all interleaved components, that's an interleaved MCU,
+         // so now count down the restart interval
+      }
+      if (--z->todo <= 0) {
+         if (z->code_bits < 24) grow_buffer_unsafe(z);
+         // if it's NOT a restart, then just bail, so we get corrupt data
+         // rather than no data
+         if (!RESTART(z->marker)) return 2;
+         reset(z);
       }
    }
    return 1;
 }
 
+#ifndef STBI_NO_THREADS
+typedef struct
+{
+   jpeg *z;
+   uint8 *start, *end;  // the span's entropy-coded bytes, through the marker after it
+   int first, last;     // the span's MCUs
+   int result;          // from decode_mcus
+   uint8 *stop;         // where the span left the stream
+   unsigned char marker;
+} stbi_jpeg_span;
+
+static void decode_span(void *work)
+{
+   stbi_jpeg_span *span = (stbi_jpeg_span *) work;
+   jpeg j = *span->z; // tables are shared by copy; the component buffers by pointer
+   start_mem(&j.s, span->start, (int) (span->end - span->start));
+   reset(&j);
+   span->result = decode_mcus(&j, span->first, span->last);
+   span->stop = j.s.img_buffer;
+   span->marker = j.marker;
+}
+
+// Every restart interval starts with a fresh entropy decoder and dc
+// prediction, so once the markers are found in the data, runs of intervals
+// decode on their own threads. A span reads exactly the bytes the serial
+// decoder would, so the result matches it; anything unexpected (a marker that
+// isn't a restart, an interval that stops early, an error) returns 0 for the
+// serial decoder to redo the scan. Needs the whole stream in memory.
+static int parse_entropy_coded_data_parallel(jpeg *z, int mcus)
+{
+   stbi_jpeg_span spans[STBI_MAX_THREADS];
+   uint8 *p, *end;
+   int intervals, count, markers, i;
+
+   #ifndef STBI_NO_STDIO
+   if (z->s.img_file) return 0;
+   #endif
+   if (!z->restart_interval) return 0;
+   intervals = (mcus + z->restart_interval-1) / z->restart_interval;
+   count = stbi_thread_count(z->s.img_x * z->s.img_y);
+   if (count > intervals) count = intervals;
+   if (count < 2) return 0;
+
+   // find where each span starts: just past its first interval's restart
+   // marker, found by the same byte pairing grow_buffer_unsafe does
+   p = z->s.img_buffer;
+   end = z->s.img_buffer_end;
+   markers = 0;
+   spans[0].start = p;
+   for (i=1; i < count; ++i) {
+      int first_interval = intervals * i / count;
+      while (markers < first_interval) {
+         uint8 *ff = (uint8 *) memchr(p, 0xff, end - p);
+         if (!ff || ff+1 >= end) return 0;
+         p = ff+2;
+         if (ff[1] == 0) continue;
+         if (!RESTART(ff[1])) return 0;
+         ++markers;
+      }
+      spans[i-1].end = p;
+      spans[i].start = p;
+   }
+   spans[count-1].end = end;
+
+   for (i=0; i < count; ++i) {
+      spans[i].z = z;
+      spans[i].first = z->restart_interval * (intervals * i / count);
+      spans[i].last = i+1 < count ? z->restart_interval * (intervals * (i+1) / count) : mcus;
+   }
+   stbi_run_parallel(decode_span, spans, sizeof(spans[0]), count);
+
+   // the last span may legitimately stop at whatever marker ends the scan
+   for (i=0; i+1 < count; ++i)
+      if (spans[i].result != 1) return 0;
+   if (!spans[count-1].result) return 0;
+   z->s.img_buffer = spans[count-1].stop;
+   z->marker = spans[count-1].marker;
+   return 1;
+}
+#endif
+
+static int parse_entropy_coded_data(jpeg *z)
+{
+   int mcus;
+   if (z->scan_n == 1) {
+      int n = z->order[0];
+      mcus = ((z->img_comp[n].x+7) >> 3) * ((z->img_comp[n].y+7) >> 3);
+   } else {
+      mcus = z->img_mcu_x * z->img_mcu_y;
+   }
+   #ifndef STBI_NO_THREADS
+   if (parse_entropy_coded_data_parallel(z, mcus)) return 1;
+   #endif
+   reset(z);
+   return decode_mcus(z, 0, mcus) != 0;
+}
+
 static int process_marker(jpeg *z, int m)
 {
    int L;
@@ -1380,12 +1747,74 @@ static uint8 *resample_row_generic(uint8 *out, uint8 *in_near, uint8 *in_far, in
 
 #define float2fixed(x)  ((int) ((x) * 65536 + 0.5))
 
+#ifdef STBI_SSE2
+// YCbCr_to_RGB_row on whole groups of 8 pixels; returns how many it did.
+// The fixed-point factors that don't fit in 16 bits are split into a
+// multiple of 65536, added to y before it is shifted up, and a remainder
+// small enough for _mm_madd_epi16, so the sums are exactly the scalar ones.
+static int YCbCr_to_RGB_sse2(uint8 *out, uint8 const *y, uint8 const *pcb, uint8 const *pcr, int count, int step)
+{
+   __m128i zero = _mm_setzero_si128();
+   __m128i c128 = _mm_set1_epi16(128);
+   __m128i round = _mm_set1_epi32(32768);
+   __m128i alpha = _mm_cmpeq_epi8(zero, zero);
+   __m128i kr = madd_const(float2fixed(1.40200f) - 65536, 0);
+   __m128i kg = madd_const(65536 - float2fixed(0.71414f), -float2fixed(0.34414f));
+   __m128i kb = madd_const(0, float2fixed(1.77200f) - 131072);
+   int i,k;
+   for (i=0; i+8 <= count; i += 8) {
+      __m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i const *) (y+i)), zero);
+      __m128i cb = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i const *) (pcb+i)), zero), c128);
+      __m128i cr = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i const *) (pcr+i)), zero), c128);
+      __m128i ry = _mm_add_epi16(yy, cr);
+      __m128i gy = _mm_sub_epi16(yy, cr);
+      __m128i by = _mm_add_epi16(yy, _mm_add_epi16(cb, cb));
+      __m128i crcb[2], rgb[3][2];
+      __m128i r,g,b,rg,ba;
+      crcb[0] = _mm_unpacklo_epi16(cr, cb);
+      crcb[1] = _mm_unpackhi_epi16(cr, cb);
+      for (k=0; k < 2; ++k) {
+         // unpacking under a zero word is the << 16
+         __m128i r_hi = k ? _mm_unpackhi_epi16(zero, ry) : _mm_unpacklo_epi16(zero, ry);
+         __m128i g_hi = k ? _mm_unpackhi_epi16(zero, gy) : _mm_unpacklo_epi16(zero, gy);
+         __m128i b_hi = k ? _mm_unpackhi_epi16(zero, by) : _mm_unpacklo_epi16(zero, by);
+         rgb[0][k] = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(r_hi, _mm_madd_epi16(crcb[k], kr)), round), 16);
+         rgb[1][k] = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(g_hi, _mm_madd_epi16(crcb[k], kg)), round), 16);
+         rgb[2][k] = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(b_hi, _mm_madd_epi16(crcb[k], kb)), round), 16);
+      }
+      // saturating packs do the clamping
+      r = _mm_packs_epi32(rgb[0][0], rgb[0][1]);
+      g = _mm_packs_epi32(rgb[1][0], rgb[1][1]);
+      b = _mm_packs_epi32(rgb[2][0], rgb[2][1]);
+      rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+      ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), alpha);
+      if (step == 4) {
+         _mm_storeu_si128((__m128i *) out,      _mm_unpacklo_epi16(rg, ba));
+         _mm_storeu_si128((__m128i *) (out+16), _mm_unpackhi_epi16(rg, ba));
+      } else {
+         // same overlapping 4-byte writes as the scalar loop
+         uint8 rgba[32];
+         _mm_storeu_si128((__m128i *) rgba,      _mm_unpacklo_epi16(rg, ba));
+         _mm_storeu_si128((__m128i *) (rgba+16), _mm_unpackhi_epi16(rg, ba));
+         for (k=0; k < 8; ++k)
+            memcpy(out + k*step, rgba + k*4, 4);
+      }
+      out += 8*step;
+   }
+   return i;
+}
+#endif
+
 // 0.38 seconds on 3*anemones.jpg   (0.25 with processor = Pro)
 // VC6 without processor=Pro is generating multiple LEAs per multiply!
 static void YCbCr_to_RGB_row(uint8 *out, uint8 *y, uint8 *pcb, uint8 *pcr, int count, int step)
 {
-   int i;
-   for (i=0; i < count; ++i) {
+   int i = 0;
+   #ifdef STBI_SSE2
+   i = YCbCr_to_RGB_sse2(out, y, pcb, pcr, count, step);
+   out += i*step;
+   #endif
+   for (; i < count; ++i) {
       int y_fixed = (y[i] << 16) + 32768; // rounding
       int r,g,b;
       int cr = pcr[i] - 128;
@@ -1443,6 +1872,76 @@ typedef struct
    int ypos;    // which pre-expansion row we're on
 } stbi_resample;
 
+// a run of output rows, resampled and colour-converted on its own
+typedef struct
+{
+   jpeg *z;
+   stbi_resample res_comp[4];
+   uint8 *linebuf[4];
+   uint8 *output;
+   int n, decode_n;
+   uint first_row, last_row;
+   uint8 *row_buffer; // if set, the last row goes through here, so writing
+                      // out[3] past its end can't touch the next band
+} stbi_jpeg_band;
+
+static void advance_resample(stbi_jpeg_band *band, int k)
+{
+   stbi_resample *r = &band->res_comp[k];
+   if (++r->ystep >= r->vs) {
+      r->ystep = 0;
+      r->line0 = r->line1;
+      if (++r->ypos < band->z->img_comp[k].y)
+         r->line1 += band->z->img_comp[k].w2;
+   }
+}
+
+static void resample_band(void *work)
+{
+   stbi_jpeg_band *band = (stbi_jpeg_band *) work;
+   jpeg *z = band->z;
+   int k, n = band->n;
+   uint i,j;
+   uint8 *coutput[4];
+   for (j=band->first_row; j < band->last_row; ++j) {
+      uint8 *row = band->output + n * z->s.img_x * j;
+      uint8 *out = band->row_buffer && j+1 == band->last_row ? band->row_buffer : row;
+      uint8 *converted = out;
+      for (k=0; k < band->decode_n; ++k) {
+         stbi_resample *r = &band->res_comp[k];
+         int y_bot = r->ystep >= (r->vs >> 1);
+         coutput[k] = r->resample(band->linebuf[k],
+                                  y_bot ? r->line1 : r->line0,
+                                  y_bot ? r->line0 : r->line1,
+                                  r->w_lores, r->hs);
+         advance_resample(band, k);
+      }
+      if (n >= 3) {
+         uint8 *y = coutput[0];
+         if (z->s.img_n == 3) {
+            #if STBI_SIMD
+            stbi_YCbCr_installed(out, y, coutput[1], coutput[2], z->s.img_x, n);
+            #else
+            YCbCr_to_RGB_row(out, y, coutput[1], coutput[2], z->s.img_x, n);
+            #endif
+         } else
+            for (i=0; i < z->s.img_x; ++i) {
+               out[0] = out[1] = out[2] = y[i];
+               out[3] = 255; // not used if n==3
+               out += n;
+            }
+      } else {
+         uint8 *y = coutput[0];
+         if (n == 1)
+            for (i=0; i < z->s.img_x; ++i) out[i] = y[i];
+         else
+            for (i=0; i < z->s.img_x; ++i) *out++ = y[i], *out++ = 255;
+      }
+      if (converted != row)
+         memcpy(row, converted, n * z->s.img_x);
+   }
+}
+
 static uint8 *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_comp)
 {
    int n, decode_n;
@@ -1464,19 +1963,24 @@ static uint8 *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int re
    // resample and color-convert
    {
       int k;
-      uint i,j;
       uint8 *output;
-      uint8 *coutput[4];
+      stbi_jpeg_band whole;
 
-      stbi_resample res_comp[4];
+      whole.z = z;
+      whole.n = n;
+      whole.decode_n = decode_n;
+      whole.first_row = 0;
+      whole.last_row = z->s.img_y;
+      whole.row_buffer = NULL;
 
       for (k=0; k < decode_n; ++k) {
-         stbi_resample *r = &res_comp[k];
+         stbi_resample *r = &whole.res_comp[k];
 
          // allocate line buffer big enough for upsampling off the edges
          // with upsample factor of 4
          z->img_comp[k].linebuf = (uint8 *) malloc(z->s.img_x + 3);
          if (!z->img_comp[k].linebuf) { cleanup_jpeg(z); return epuc("outofmem", "Out of memory"); }
+         whole.linebuf[k] = z->img_comp[k].linebuf;
 
          r->hs      = z->img_h_max / z->img_comp[k].h;
          r->vs      = z->img_v_max / z->img_comp[k].v;
@@ -1495,46 +1999,42 @@ static uint8 *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int re
       // can't error after this so, this is safe
       output = (uint8 *) malloc(n * z->s.img_x * z->s.img_y + 1);
       if (!output) { cleanup_jpeg(z); return epuc("outofmem", "Out of memory"); }
+      whole.output = output;
 
       // now go ahead and resample
-      for (j=0; j < z->s.img_y; ++j) {
-         uint8 *out = output + n * z->s.img_x * j;
-         for (k=0; k < decode_n; ++k) {
-            stbi_resample *r = &res_comp[k];
-            int y_bot = r->ystep >= (r->vs >> 1);
-            coutput[k] = r->resample(z->img_comp[k].linebuf,
-                                     y_bot ? r->line1 : r->line0,
-                                     y_bot ? r->line0 : r->line1,
-                                     r->w_lores, r->hs);
-            if (++r->ystep >= r->vs) {
-               r->ystep = 0;
-               r->line0 = r->line1;
-               if (++r->ypos < z->img_comp[k].y)
-                  r->line1 += z->img_comp[k].w2;
+      #ifndef STBI_NO_THREADS
+      {
+         // rows only depend on the decoded components, so bands of them go to
+         // separate threads, each with its own line buffers
+         stbi_jpeg_band bands[STBI_MAX_THREADS];
+         int count = stbi_thread_count(z->s.img_x * z->s.img_y);
+         int band_size = decode_n * (z->s.img_x + 3) + n * z->s.img_x + 1;
+         uint8 *scratch = count > 1 ? (uint8 *) malloc(count * band_size) : NULL;
+         if (scratch) {
+            uint j;
+            int b;
+            for (b=0; b < count; ++b) {
+               stbi_jpeg_band *band = &bands[b];
+               *band = whole;
+               band->first_row = z->s.img_y * b / count;
+               band->last_row = z->s.img_y * (b+1) / count;
+               for (k=0; k < decode_n; ++k)
+                  band->linebuf[k] = scratch + b * band_size + k * (z->s.img_x + 3);
+               if (b+1 < count)
+                  band->row_buffer = scratch + b * band_size + decode_n * (z->s.img_x + 3);
+               for (j=0; j < band->first_row; ++j)
+                  for (k=0; k < decode_n; ++k)
+                     advance_resample(band, k);
             }
-         }
-         if (n >= 3) {
-            uint8 *y = coutput[0];
-            if (z->s.img_n == 3) {
-               #if STBI_SIMD
-               stbi_YCbCr_installed(out, y, coutput[1], coutput[2], z->s.img_x, n);
-               #else
-               YCbCr_to_RGB_row(out, y, coutput[1], coutput[2], z->s.img_x, n);
-               #endif
-            } else
-               for (i=0; i < z->s.img_x; ++i) {
-                  out[0] = out[1] = out[2] = y[i];
-                  out[3] = 255; // not used if n==3
-                  out += n;
-               }
-         } else {
-            uint8 *y = coutput[0];
-            if (n == 1)
-               for (i=0; i < z->s.img_x; ++i) out[i] = y[i];
-            else
-               for (i=0; i < z->s.img_x; ++i) *out++ = y[i], *out++ = 255;
-         }
+            stbi_run_parallel(resample_band, bands, sizeof(bands[0]), count);
+            free(scratch);
+         } else
+            resample_band(&whole);
       }
+      #else
+      resample_band(&whole);
+      #endif
+
       cleanup_jpeg(z);
       *out_x = z->s.img_x;
       *out_y = z->s.img_y;
@@ -1546,9 +2046,12 @@ static uint8 *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int re
 #ifndef STBI_NO_STDIO
 unsigned char *stbi_jpeg_load_from_file(FILE *f, int *x, int *y, int *comp, int req_comp)
 {
+   unsigned char *data;
    jpeg j;
    start_file(&j.s, f);
-   return load_jpeg_image(&j, x,y,comp,req_comp);
+   data = load_jpeg_image(&j, x,y,comp,req_comp);
+   end_file(&j.s);
+   return data;
 }
 
 unsigned char *stbi_jpeg_load(char const *filename, int *x, int *y, int *comp, int req_comp)
@@ -2292,17 +2795,7 @@ static int parse_png_file(png *z, int scan, int req_comp)
                p = (uint8 *) realloc(z->idata, idata_limit); if (p == NULL) return e("outofmem", "Out of memory");
                z->idata = p;
             }
-            #ifndef STBI_NO_STDIO
-            if (s->img_file)
-            {
-               if (fread(z->idata+ioff,1,c.length,s->img_file) != c.length) return e("outofdata","Corrupt PNG");
-            }
-            else
-            #endif
-            {
-               memcpy(z->idata+ioff, s->img_buffer, c.length);
-               s->img_buffer += c.length;
-            }
+            if (!getn(s, z->idata+ioff, c.length)) return e("outofdata","Corrupt PNG");
             ioff += c.length;
             break;
          }
@@ -2383,9 +2876,12 @@ static unsigned char *do_png(png *p, int *x, int *y, int *n, int req_comp)
 #ifndef STBI_NO_STDIO
 unsigned char *stbi_png_load_from_file(FILE *f, int *x, int *y, int *comp, int req_comp)
 {
+   unsigned char *data;
    png p;
    start_file(&p.s, f);
-   return do_png(&p, x,y,comp,req_comp);
+   data = do_png(&p, x,y,comp,req_comp);
+   end_file(&p.s);
+   return data;
 }
 
 unsigned char *stbi_png_load(char const *filename, int *x, int *y, int *comp, int req_comp)
@@ -2715,9 +3211,12 @@ stbi_uc *stbi_bmp_load             (char const *filename,           int *x, int
 
 stbi_uc *stbi_bmp_load_from_file   (FILE *f,                  int *x, int *y, int *comp, int req_comp)
 {
+   stbi_uc *data;
    stbi s;
    start_file(&s, f);
-   return bmp_load(&s, x,y,comp,req_comp);
+   data = bmp_load(&s, x,y,comp,req_comp);
+   end_file(&s);
+   return data;
 }
 #endif
 
@@ -3001,9 +3500,12 @@ stbi_uc *stbi_tga_load             (char const *filename,           int *x, int
 
 stbi_uc *stbi_tga_load_from_file   (FILE *f,                  int *x, int *y, int *comp, int req_comp)
 {
+   stbi_uc *data;
    stbi s;
    start_file(&s, f);
-   return tga_load(&s, x,y,comp,req_comp);
+   data = tga_load(&s, x,y,comp,req_comp);
+   end_file(&s);
+   return data;
 }
 #endif
 
@@ -3215,9 +3717,12 @@ stbi_uc *stbi_psd_load(char const *filename, int *x, int *y, int *comp, int req_
 
 stbi_uc *stbi_psd_load_from_file(FILE *f, int *x, int *y, int *comp, int req_comp)
 {
+   stbi_uc *data;
    stbi s;
    start_file(&s, f);
-   return psd_load(&s, x,y,comp,req_comp);
+   data = psd_load(&s, x,y,comp,req_comp);
+   end_file(&s);
+   return data;
 }
 #endif
 
@@ -3531,16 +4036,22 @@ static stbi_uc *hdr_load_rgbe(stbi *s, int *x, int *y, int *comp, int req_comp)
 #ifndef STBI_NO_STDIO
 float *stbi_hdr_load_from_file(FILE *f, int *x, int *y, int *comp, int req_comp)
 {
+   float *data;
    stbi s;
    start_file(&s,f);
-   return hdr_load(&s,x,y,comp,req_comp);
+   data = hdr_load(&s,x,y,comp,req_comp);
+   end_file(&s);
+   return data;
 }
 
 stbi_uc *stbi_hdr_load_rgbe_file(FILE *f, int *x, int *y, int *comp, int req_comp)
 {
+   stbi_uc *data;
    stbi s;
    start_file(&s,f);
-   return hdr_load_rgbe(&s,x,y,comp,req_comp);
+   data = hdr_load_rgbe(&s,x,y,comp,req_comp);
+   end_file(&s);
+   return data;
 }
 
 stbi_uc *stbi_hdr_load_rgbe        (char const *filename,           int *x, int *y, int *comp, int req_comp)
@@ -216,6 +216,11 @@ extern void   stbi_ldr_to_hdr_scale(float scale);
 // NOT THREADSAFE
 extern char    *stbi_failure_reason  (void); 
 
+// cap the threads one large JPEG decode may start; 0 (the default) means one
+// per processor and 1 decodes on the calling thread only. set it before
+// decoding starts, as it is read without a lock
+extern void     stbi_set_thread_count(int count);
+
 // free the loaded image -- this is just free()
 extern void     stbi_image_free      (void *retval_from_stbi_load);
 
@@ -487,9 +487,12 @@ static stbi_uc *dds_load(stbi *s, int *x, int *y, int *comp, int req_comp)
 #ifndef STBI_NO_STDIO
 stbi_uc *stbi_dds_load_from_file   (FILE *f,                  int *x, int *y, int *comp, int req_comp)
 {
+	stbi_uc *data;
 	stbi s;
    start_file(&s,f);
-   return dds_load(&s,x,y,comp,req_comp);
+   data = dds_load(&s,x,y,comp,req_comp);
+   end_file(&s);
+   return data;
 }
 
 stbi_uc *stbi_dds_load             (char *filename,           int *x, int *y, int *comp, int req_comp)
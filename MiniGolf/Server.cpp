@@ -0,0 +1,554 @@
+#ifdef _WIN32
+#define FD_SETSIZE 1024 // Winsock's default of 64 sockets is too few.
+#include <winsock2.h>
+#pragma comment(lib, "Ws2_32.lib")
+typedef int socklen_t;
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#define closesocket close
+#endif
+
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "Server.h"
+#include "Game.h"
+#include "Varint.h"
+
+#ifdef _WIN32
+typedef SOCKET NativeSocket;
+#else
+typedef int NativeSocket;
+#endif
+
+static NativeSocket native(SocketHandle s)
+{
+	return (NativeSocket)s;
+}
+
+static void set_non_blocking(NativeSocket s)
+{
+#ifdef _WIN32
+	u_long on = 1;
+	ioctlsocket(s, FIONBIO, &on);
+#else
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+static bool would_block()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+Server::Server(JobSystem *jobs)
+{
+	this->jobs = jobs;
+	next_game = 1;
+	next_client = 1;
+	listener = INVALID_SOCKET_HANDLE;
+	last_tick_ms = 0.0;
+	slowest_tick_ms = 0.0;
+	snapshot_sequence = 0;
+	ticks_since_snapshot = 0;
+	timer.start();
+}
+
+Server::~Server()
+{
+	for (map<int, Client>::iterator i = clients.begin(); i != clients.end(); ++i) {
+		closesocket(native(i->second.socket));
+	}
+	if (listener != INVALID_SOCKET_HANDLE) {
+		closesocket(native(listener));
+	}
+
+	for (map<int, ServerGame*>::iterator i = games.begin(); i != games.end(); ++i) {
+		delete i->second;
+	}
+	for (vector<vector<Level*> >::size_type i = 0; i < courses.size(); ++i) {
+		for (vector<Level*>::size_type j = 0; j < courses[i].size(); ++j) {
+			delete courses[i][j];
+		}
+	}
+}
+
+bool Server::load_course(string fname)
+{
+	vector<Level*> levels = Level::load_levels(fname);
+	if (levels.empty()) {
+		return false;
+	}
+
+	courses.push_back(levels);
+	course_names.push_back(levels[0]->get_course_name());
+	return true;
+}
+
+bool Server::listen(int port)
+{
+#ifdef _WIN32
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+		cout << "error - unable to start Winsock." << endl;
+		return false;
+	}
+#else
+	signal(SIGPIPE, SIG_IGN); // A client that disconnects mid-write must not stop the server.
+#endif
+
+	NativeSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (s == native(INVALID_SOCKET_HANDLE)) {
+		cout << "error - unable to create a socket." << endl;
+		return false;
+	}
+
+	int on = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *)&on, sizeof(on));
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons((unsigned short)port);
+
+	if (bind(s, (sockaddr *)&address, sizeof(address)) != 0 || ::listen(s, SOMAXCONN) != 0) {
+		cout << "error - unable to listen on port " << port << endl;
+		closesocket(s);
+		return false;
+	}
+
+	set_non_blocking(s);
+	listener = (SocketHandle)s;
+	return true;
+}
+
+int Server::get_game_count() const
+{
+	return games.size();
+}
+
+// Fixed ticks on the wall clock. Between ticks the thread waits on the sockets.
+void Server::run()
+{
+	double next_tick = timer.get_elapsed_time_in_sec();
+
+	while (true) {
+		double now = timer.get_elapsed_time_in_sec();
+		poll(next_tick > now ? next_tick - now : 0.0);
+
+		now = timer.get_elapsed_time_in_sec();
+		int ticks = 0;
+		while (now >= next_tick) {
+			if (ticks == SERVER_MAX_CATCH_UP) {
+				next_tick = now; // Overloaded: drop the backlog instead of spiralling.
+				break;
+			}
+			tick();
+			next_tick += PHYSICS_TIME_STEP;
+			ticks++;
+		}
+
+		for (map<int, Client>::iterator i = clients.begin(); i != clients.end(); ++i) {
+			write_client(i->second);
+		}
+	}
+}
+
+void Server::tick()
+{
+	double start = timer.get_elapsed_time_in_milli_sec();
+
+	vector<ServerGame*> &list = game_list;
+	jobs->parallel_for(list.size(), SERVER_TICK_GRAIN, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			list[i]->step();
+		}
+	});
+
+	for (map<int, Client>::iterator c = clients.begin(); c != clients.end(); ++c) {
+		Client &client = c->second;
+		for (set<int>::iterator w = client.watching.begin(); w != client.watching.end(); ++w) {
+			map<int, ServerGame*>::iterator g = games.find(*w);
+			if (g != games.end() && !g->second->get_update().empty()) {
+				client.output += g->second->get_update();
+			}
+		}
+	}
+
+	if (++ticks_since_snapshot == SNAPSHOT_INTERVAL) {
+		ticks_since_snapshot = 0;
+		send_snapshots();
+	}
+
+	last_tick_ms = timer.get_elapsed_time_in_milli_sec() - start;
+	if (last_tick_ms > slowest_tick_ms) {
+		slowest_tick_ms = last_tick_ms;
+	}
+}
+
+// Each game is encoded once per baseline and the bytes are shared by every spectator on that baseline,
+// so the cost grows with the number of distinct acks rather than the number of spectators.
+void Server::send_snapshots()
+{
+	snapshot_sequence++;
+
+	SnapshotFrame &frame = snapshot_history[snapshot_sequence];
+	for (map<int, Client>::iterator c = clients.begin(); c != clients.end(); ++c) {
+		for (map<int, unsigned int>::iterator s = c->second.spectating.begin(); s != c->second.spectating.end(); ++s) {
+			if (!frame.count(s->first)) {
+				frame[s->first] = games[s->first]->get_snapshot();
+			}
+		}
+	}
+	while (snapshot_history.size() > SNAPSHOT_HISTORY) {
+		snapshot_history.erase(snapshot_history.begin());
+	}
+
+	map<pair<int, unsigned int>, string> encoded;
+
+	for (map<int, Client>::iterator c = clients.begin(); c != clients.end(); ++c) {
+		Client &client = c->second;
+		if (client.spectating.empty() && client.removed.empty()) {
+			continue;
+		}
+
+		map<unsigned int, SnapshotFrame>::iterator base = snapshot_history.find(client.acked);
+		unsigned int baseline = base == snapshot_history.end() ? 0 : client.acked;
+
+		string body;
+		vector<pair<int, unsigned int> > still_removed;
+		for (vector<pair<int, unsigned int> >::size_type i = 0; i < client.removed.size(); ++i) {
+			if (baseline != 0 && client.removed[i].second < baseline) {
+				continue; // The client's baseline no longer has it.
+			}
+			still_removed.push_back(client.removed[i]);
+		}
+		client.removed = still_removed;
+
+		write_varint(body, client.removed.size());
+		for (vector<pair<int, unsigned int> >::size_type i = 0; i < client.removed.size(); ++i) {
+			write_varint(body, client.removed[i].first);
+		}
+
+		for (map<int, unsigned int>::iterator s = client.spectating.begin(); s != client.spectating.end(); ++s) {
+			// Only a snapshot this client was sent the game in can serve as its baseline.
+			const GameSnapshot *previous = NULL;
+			unsigned int key = 0;
+			if (baseline != 0 && s->second <= baseline) {
+				SnapshotFrame::iterator state = base->second.find(s->first);
+				if (state != base->second.end()) {
+					previous = &state->second;
+					key = baseline;
+				}
+			}
+
+			pair<int, unsigned int> id(s->first, key);
+			map<pair<int, unsigned int>, string>::iterator cached = encoded.find(id);
+			if (cached == encoded.end()) {
+				string bytes;
+				SnapshotEncoder::encode_game(bytes, s->first, frame[s->first], previous);
+				cached = encoded.insert(make_pair(id, bytes)).first;
+			}
+			body += cached->second;
+		}
+
+		ostringstream header;
+		header << "snap " << snapshot_sequence << " " << baseline << " " << body.size() << "\n";
+		client.output += header.str();
+		client.output += body;
+	}
+}
+
+string Server::handle_request(const string &line, int client)
+{
+	istringstream in(line);
+	string command;
+	in >> command;
+
+	ostringstream out;
+
+	if (command == "courses") {
+		for (vector<string>::size_type i = 0; i < course_names.size(); ++i) {
+			out << "course " << i << " " << courses[i].size() << " " << course_names[i] << "\n";
+		}
+		out << "ok";
+	}
+	else if (command == "new") {
+		unsigned int course;
+		vector<string> names;
+		string name;
+
+		if (!(in >> course) || course >= courses.size()) {
+			return "error unknown course";
+		}
+		while (in >> name) {
+			names.push_back(name);
+		}
+		if (names.empty()) {
+			return "error no players";
+		}
+
+		ServerGame *game = new ServerGame(next_game++, courses[course], names);
+		games[game->get_id()] = game;
+		game_list.push_back(game);
+		out << "game " << game->get_id();
+	}
+	else if (command == "shot") {
+		int id, player;
+		float angle, power;
+		string error;
+
+		if (!(in >> id >> player >> angle >> power)) {
+			return "error usage: shot <game> <player> <angle> <power>";
+		}
+		if (!games.count(id)) {
+			return "error unknown game";
+		}
+		if (!games[id]->shoot(player, angle, power, error)) {
+			return "error " + error;
+		}
+		out << "ok";
+	}
+	else if (command == "ack") {
+		unsigned int sequence;
+		if (client >= 0 && in >> sequence && sequence > clients[client].acked && sequence <= snapshot_sequence) {
+			clients[client].acked = sequence;
+		}
+		return "";
+	}
+	else if (command == "watch" || command == "unwatch" || command == "spectate" || command == "unspectate" ||
+		command == "state" || command == "scores" || command == "end") {
+		int id;
+		if (!(in >> id) || !games.count(id)) {
+			return "error unknown game";
+		}
+
+		if (command == "state") {
+			return games[id]->get_state();
+		}
+		if (command == "scores") {
+			return games[id]->get_scores();
+		}
+		if (command == "end") {
+			end_game(id);
+		}
+		else if (client >= 0 && command == "watch") {
+			clients[client].watching.insert(id);
+		}
+		else if (client >= 0 && command == "unwatch") {
+			clients[client].watching.erase(id);
+		}
+		else if (client >= 0 && command == "spectate") {
+			if (!clients[client].spectating.count(id)) {
+				clients[client].spectating[id] = snapshot_sequence + 1;
+			}
+		}
+		else if (client >= 0 && clients[client].spectating.erase(id)) {
+			clients[client].removed.push_back(make_pair(id, snapshot_sequence));
+		}
+		out << "ok";
+	}
+	else if (command == "stats") {
+		out << "stats " << games.size() << " " << clients.size() << " " << last_tick_ms << " " << slowest_tick_ms;
+	}
+	else {
+		out << "error unknown command";
+	}
+
+	return out.str();
+}
+
+void Server::end_game(int id)
+{
+	ServerGame *game = games[id];
+	games.erase(id);
+	game_list.erase(find(game_list.begin(), game_list.end(), game));
+
+	for (map<int, Client>::iterator i = clients.begin(); i != clients.end(); ++i) {
+		i->second.watching.erase(id);
+		if (i->second.spectating.erase(id)) {
+			i->second.removed.push_back(make_pair(id, snapshot_sequence));
+		}
+	}
+	delete game;
+}
+
+// select() on every socket until one is ready or the timeout passes.
+void Server::poll(double timeout)
+{
+	fd_set readable, writable;
+	FD_ZERO(&readable);
+	FD_ZERO(&writable);
+
+	NativeSocket highest = native(listener);
+	FD_SET(native(listener), &readable);
+
+	for (map<int, Client>::iterator i = clients.begin(); i != clients.end(); ++i) {
+		NativeSocket s = native(i->second.socket);
+		FD_SET(s, &readable);
+		if (!i->second.output.empty()) {
+			FD_SET(s, &writable);
+		}
+		if (s > highest) {
+			highest = s;
+		}
+	}
+
+	timeval wait;
+	wait.tv_sec = (long)timeout;
+	wait.tv_usec = (long)((timeout - wait.tv_sec) * 1e6);
+
+	if (select((int)highest + 1, &readable, &writable, NULL, &wait) <= 0) {
+		return;
+	}
+
+	if (FD_ISSET(native(listener), &readable)) {
+		accept_clients();
+	}
+
+	vector<int> closed;
+	for (map<int, Client>::iterator i = clients.begin(); i != clients.end(); ++i) {
+		Client &client = i->second;
+		NativeSocket s = native(client.socket);
+
+		if (FD_ISSET(s, &readable) && !read_client(client, i->first)) {
+			closed.push_back(i->first);
+			continue;
+		}
+		if (FD_ISSET(s, &writable)) {
+			write_client(client);
+		}
+		if (client.closing && client.output.empty()) {
+			closed.push_back(i->first);
+		}
+	}
+
+	for (vector<int>::size_type i = 0; i < closed.size(); ++i) {
+		closesocket(native(clients[closed[i]].socket));
+		clients.erase(closed[i]);
+	}
+}
+
+void Server::accept_clients()
+{
+	while (true) {
+		NativeSocket s = accept(native(listener), NULL, NULL);
+		if (s == native(INVALID_SOCKET_HANDLE)) {
+			return;
+		}
+#ifndef _WIN32
+		if (s >= FD_SETSIZE) {
+			closesocket(s); // select() cannot watch it.
+			continue;
+		}
+#endif
+		set_non_blocking(s);
+
+		Client client;
+		client.socket = (SocketHandle)s;
+		client.acked = 0;
+		client.closing = false;
+		clients[next_client++] = client;
+	}
+}
+
+// Answer every complete line. Returns false when the connection is gone.
+bool Server::read_client(Client &client, int id)
+{
+	char buffer[4096];
+
+	while (true) {
+		int n = recv(native(client.socket), buffer, sizeof(buffer), 0);
+		if (n == 0) {
+			return false;
+		}
+		if (n < 0) {
+			if (would_block()) {
+				break;
+			}
+			return false;
+		}
+		client.input.append(buffer, n);
+	}
+
+	string::size_type start = 0, end;
+	while ((end = client.input.find('\n', start)) != string::npos) {
+		string line = client.input.substr(start, end - start);
+		start = end + 1;
+
+		if (!line.empty() && line[line.size() - 1] == '\r') {
+			line.erase(line.size() - 1);
+		}
+		if (line.empty()) {
+			continue;
+		}
+		if (line == "quit") {
+			client.closing = true;
+			break;
+		}
+		string reply = handle_request(line, id);
+		if (!reply.empty()) {
+			client.output += reply + "\n";
+		}
+	}
+	client.input.erase(0, start);
+
+	return client.input.size() <= SERVER_MAX_LINE;
+}
+
+void Server::write_client(Client &client)
+{
+	while (!client.output.empty()) {
+		int n = send(native(client.socket), client.output.data(), (int)client.output.size(), 0);
+		if (n <= 0) {
+			if (!would_block()) {
+				client.closing = true;
+				client.output.clear();
+			}
+			return;
+		}
+		client.output.erase(0, n);
+	}
+}
+
+int run_server(int argc, char **argv)
+{
+	if (argc < 2) {
+		cout << "usage: MiniGolf --server <port> <course> [course...]" << endl;
+		return 1;
+	}
+
+	Object3D::set_headless(true);
+
+	Server server;
+	for (int i = 1; i < argc; ++i) {
+		if (!server.load_course(argv[i])) {
+			return 1;
+		}
+	}
+
+	int port = atoi(argv[0]);
+	if (!server.listen(port)) {
+		return 1;
+	}
+
+	cout << "Serving " << argc - 1 << " course(s) on 127.0.0.1:" << port << endl;
+	server.run();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "Level.h"
+#include "ServerGame.h"
+#include "Snapshot.h"
+#include "JobSystem.h"
+#include "Timer.h"
+
+using namespace std;
+
+typedef size_t SocketHandle; // SOCKET on Windows, a file descriptor elsewhere.
+static const SocketHandle INVALID_SOCKET_HANDLE = (SocketHandle)-1;
+
+static const int SERVER_TICK_GRAIN = 64; // Games stepped per job.
+static const int SERVER_MAX_CATCH_UP = 8; // Ticks run back to back before the server drops time.
+static const size_t SERVER_MAX_LINE = 4096; // Longer requests close the connection.
+
+// Headless host for many independent games. One thread owns the sockets and all game state
+// between ticks; each tick steps every game once, in parallel on the job system, then streams
+// what changed to the clients watching each game.
+//
+// Line protocol, one request per line, answers in order:
+//   courses                           -> course <index> <holes> <name> ... ok
+//   new <course> <player> [player...] -> game <id>
+//   shot <game> <player> <angle> <power>
+//   watch <game> / unwatch <game>     -> ok, then ball/holed/out/pickup/state/scores lines every tick it changes
+//   spectate <game> / unspectate <game> -> ok, then every SNAPSHOT_INTERVAL ticks a line
+//                                        snap <sequence> <baseline> <length> followed by length bytes of
+//                                        delta-encoded GameSnapshots (see SnapshotDecoder)
+//   ack <sequence>                    -> no reply; later snapshots are deltas against this one
+//   state <game> / scores <game>
+//   end <game>
+//   stats                             -> stats <games> <clients> <last tick ms> <slowest tick ms>
+//   quit
+// Errors come back as error <reason>.
+class Server
+{
+public:
+	Server(JobSystem *jobs = JobSystem::get_instance());
+
+	~Server();
+
+	bool load_course(string fname);
+
+	bool listen(int port); // Loopback only.
+
+	void run(); // Serve until the process is stopped.
+
+	void tick(); // Step every game once and queue the updates.
+
+	string handle_request(const string &line, int client); // Returns the reply; client -1 is a local caller.
+
+	int get_game_count() const;
+
+private:
+	struct Client {
+		SocketHandle socket;
+		string input;
+		string output;
+		set<int> watching;
+		map<int, unsigned int> spectating; // Game ID to the first snapshot that included it.
+		vector<pair<int, unsigned int> > removed; // Spectated games dropped, and when; resent until acked.
+		unsigned int acked; // Latest snapshot the client confirmed, 0 for none.
+		bool closing;
+	};
+
+	JobSystem *jobs;
+	vector<vector<Level*> > courses;
+	vector<string> course_names;
+
+	map<int, ServerGame*> games;
+	vector<ServerGame*> game_list; // Same games, for parallel_for.
+	int next_game;
+
+	SocketHandle listener;
+	map<int, Client> clients;
+	int next_client;
+
+	unsigned int snapshot_sequence;
+	int ticks_since_snapshot;
+	map<unsigned int, SnapshotFrame> snapshot_history; // Spectated games only.
+
+	Timer timer;
+	double last_tick_ms;
+	double slowest_tick_ms;
+
+	Server(const Server &);
+
+	Server &operator=(const Server &);
+
+	void end_game(int id);
+
+	void send_snapshots();
+
+	void poll(double timeout);
+
+	void accept_clients();
+
+	bool read_client(Client &client, int id);
+
+	void write_client(Client &client);
+};
+
+// MiniGolf --server <port> <course> [course...]
+int run_server(int argc, char **argv);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <sstream>
+#include <cmath>
+
+#include "ServerGame.h"
+#include "Game.h"
+
+ServerGame::ServerGame(int id, const vector<Level*> &course, const vector<string> &names) : course(course), arena(SERVER_GAME_ARENA_BLOCK)
+{
+	this->id = id;
+
+	for (vector<string>::size_type i = 0; i < names.size(); ++i) {
+		players.push_back(Player(names[i], course.size()));
+	}
+
+	ball = arena.create<Ball>(0, vec3(0.0f), &arena);
+	rolling = false;
+	shot_steps = 0;
+	over = false;
+
+	start_hole(0);
+}
+
+ServerGame::~ServerGame()
+{
+	arena.release();
+}
+
+int ServerGame::get_id() const
+{
+	return id;
+}
+
+bool ServerGame::is_over() const
+{
+	return over;
+}
+
+bool ServerGame::is_rolling() const
+{
+	return rolling;
+}
+
+bool ServerGame::shoot(int player, float angle, float power, string &error)
+{
+	if (over) {
+		error = "game over";
+		return false;
+	}
+	if (player != turn) {
+		error = "not your turn";
+		return false;
+	}
+	if (rolling) {
+		error = "ball still rolling";
+		return false;
+	}
+	if (!(power > 0.0f && power <= SERVER_MAX_POWER)) {
+		error = "power out of range";
+		return false;
+	}
+
+	Player &p = players[turn];
+	p.add_stroke(hole);
+
+	shot_start = p.get_lie();
+	ball->reset(shot_start);
+	ball->add_force(vec3(sin(angle) * power, 0.0f, cos(angle) * power));
+	rolling = true;
+	shot_steps = 0;
+
+	return true;
+}
+
+bool ServerGame::step()
+{
+	update.clear();
+	if (!rolling) {
+		return false;
+	}
+
+	Level *level = course[hole];
+	level->step_ball(ball, PHYSICS_TIME_STEP);
+	shot_steps++;
+
+	ostringstream out;
+	vec3 p = ball->get_position();
+	out << "ball " << id << " " << p.x << " " << p.y << " " << p.z << "\n";
+	update = out.str();
+
+	if (level->ball_in_cup(ball)) {
+		end_shot(true);
+	}
+	else if (!ball->is_active() || shot_steps >= SERVER_MAX_SHOT_STEPS) {
+		end_shot(false);
+	}
+
+	return true;
+}
+
+void ServerGame::end_shot(bool holed)
+{
+	Player &p = players[turn];
+	Level *level = course[hole];
+	rolling = false;
+
+	ostringstream out;
+
+	if (holed) {
+		p.set_holed(true);
+		out << "holed " << id << " " << turn << " " << p.get_strokes(hole) << "\n";
+	}
+	else {
+		vec3 end = ball->get_position();
+		if (level->find_tile(end)) {
+			p.set_lie(end);
+		}
+		else {
+			out << "out " << id << " " << turn << "\n"; // The lie stays where the shot was played from.
+		}
+
+		if (p.get_strokes(hole) >= SERVER_MAX_STROKES) {
+			p.set_holed(true);
+			out << "pickup " << id << " " << turn << " " << p.get_strokes(hole) << "\n";
+		}
+	}
+
+	update += out.str();
+	next_turn();
+}
+
+// The next player still out on this hole, or the next hole once everyone is in.
+void ServerGame::next_turn()
+{
+	for (vector<Player>::size_type i = 1; i <= players.size(); ++i) {
+		int next = (turn + i) % players.size();
+		if (!players[next].is_holed()) {
+			turn = next;
+			update += get_state() + "\n";
+			return;
+		}
+	}
+
+	if (hole + 1 < (int)course.size()) {
+		start_hole(hole + 1);
+		update += get_state() + "\n";
+	}
+	else {
+		over = true;
+		update += get_scores() + "\n";
+	}
+}
+
+void ServerGame::start_hole(int h)
+{
+	hole = h;
+	turn = 0;
+
+	vec3 tee = course[hole]->get_tee_position();
+	for (vector<Player>::size_type i = 0; i < players.size(); ++i) {
+		players[i].set_lie(tee);
+		players[i].set_holed(false);
+	}
+}
+
+// state <game> <hole> <turn> <x> <y> <z>: the lie of the player whose turn it is.
+string ServerGame::get_state() const
+{
+	ostringstream out;
+	vec3 lie = players[turn].get_lie();
+	out << "state " << id << " " << hole + 1 << " " << (over ? -1 : turn) << " " << lie.x << " " << lie.y << " " << lie.z;
+	return out.str();
+}
+
+string ServerGame::get_scores() const
+{
+	ostringstream out;
+	out << "scores " << id << (over ? " final" : "");
+	for (vector<Player>::size_type i = 0; i < players.size(); ++i) {
+		out << " " << players[i].get_name() << ":" << players[i].get_total();
+	}
+	return out.str();
+}
+
+GameSnapshot ServerGame::get_snapshot() const
+{
+	GameSnapshot snapshot;
+	snapshot.hole = hole;
+	snapshot.turn = turn;
+	snapshot.flags = (rolling ? SNAPSHOT_ROLLING : 0) | (over ? SNAPSHOT_OVER : 0);
+	snapshot.set_position(rolling ? ball->get_position() : players[turn].get_lie());
+	snapshot.set_velocity(rolling ? ball->get_velocity() : vec3(0.0f));
+
+	for (vector<Player>::size_type i = 0; i < players.size(); ++i) {
+		snapshot.scores.push_back(players[i].get_total());
+	}
+	return snapshot;
+}
+
+const string &ServerGame::get_update() const
+{
+	return update;
+}
\ No newline at end of file
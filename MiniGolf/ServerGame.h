@@ -0,0 +1,77 @@
+#ifndef SERVER_GAME_H
+#define SERVER_GAME_H
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Level.h"
+#include "Player.h"
+#include "Arena.h"
+#include "Snapshot.h"
+
+using namespace std;
+using namespace glm;
+
+static const float SERVER_MAX_POWER = 8.0f; // Strongest hit accepted, in add_force units.
+static const int SERVER_MAX_STROKES = 10; // A player still out after this many strokes picks up.
+static const unsigned int SERVER_MAX_SHOT_STEPS = 60 * 60; // Ticks before a rolling ball is stopped where it is.
+static const size_t SERVER_GAME_ARENA_BLOCK = 2048; // Holds the ball.
+
+// One game on the server: players take turns on a course shared with every other game.
+// Only the ball in play exists; the others are kept as a lie per player.
+// shoot() and the getters are for the network thread between ticks, step() for the tick.
+class ServerGame
+{
+public:
+	ServerGame(int id, const vector<Level*> &course, const vector<string> &names);
+
+	~ServerGame();
+
+	int get_id() const;
+
+	bool is_over() const;
+
+	bool is_rolling() const;
+
+	bool shoot(int player, float angle, float power, string &error);
+
+	bool step(); // One tick. Returns true if anything a watcher sees changed.
+
+	string get_state() const; // One protocol line.
+
+	string get_scores() const;
+
+	GameSnapshot get_snapshot() const;
+
+	const string &get_update() const; // Lines produced by the last step() that changed something.
+
+private:
+	int id;
+	const vector<Level*> &course;
+	vector<Player> players;
+	int hole;
+	int turn;
+	bool over;
+
+	Arena arena;
+	Ball *ball;
+	bool rolling;
+	vec3 shot_start;
+	unsigned int shot_steps;
+
+	string update;
+
+	ServerGame(const ServerGame &);
+
+	ServerGame &operator=(const ServerGame &);
+
+	void end_shot(bool holed);
+
+	void next_turn();
+
+	void start_hole(int h);
+};
+
+#endif
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include "Shader.h"
+#include "GLState.h"
+
+map<string, Shader*> Shader::shared;
 
 Shader::Shader(char *v, char *f) : program_handle(0)
 {
@@ -6,6 +9,20 @@ Shader::Shader(char *v, char *f) : program_handle(0)
 	fragmentShaderPath = f;
 }
 
+Shader *Shader::get_shared(char *v, char *f)
+{
+	string key = string(v) + "|" + f;
+	map<string, Shader*>::iterator it = shared.find(key);
+	if (it != shared.end()) {
+		return it->second;
+	}
+
+	Shader *shader = new Shader(v, f);
+	shader->readAndCompileShader();
+	shared[key] = shader;
+	return shader;
+}
+
 void Shader::getGLError()
 {
 	GLenum err = glGetError();
@@ -56,6 +73,11 @@ void Shader::linkProgram()
 		return;
 	}
 
+	GLuint material_block = glGetUniformBlockIndex(program_handle, "MaterialBlock");
+	if (material_block != GL_INVALID_INDEX) {
+		glUniformBlockBinding(program_handle, material_block, MATERIAL_BLOCK_BINDING);
+	}
+
 	glValidateProgram(program_handle);
 	glGetProgramiv(program_handle, GL_INFO_LOG_LENGTH, &logLength);
 	if (logLength > 0) {
@@ -78,9 +100,7 @@ void Shader::buildProgram(sh *vtx, sh *frg)
 {
 	GLint status;
 	GLchar *vtxSourceString = NULL, *frgSourceString = NULL;
-	float  glLanguageVersion;
-
-	sscanf_s((char *)glGetString(GL_SHADING_LANGUAGE_VERSION), "%f", &glLanguageVersion);
+	float  glLanguageVersion = (float)atof((const char *)glGetString(GL_SHADING_LANGUAGE_VERSION));
 
 	GLuint version = static_cast<GLuint>(100 * glLanguageVersion);
 	const GLsizei versionStringSize = sizeof("#version 123\n");
@@ -187,8 +207,7 @@ void Shader::use()
 		printf("[ERROR] Program Handle: %d", program_handle);
 		return;
 	}
-	glUseProgram(program_handle);
-	glBindVertexArray(0);
+	GLState::use_program(program_handle);
 }
 
 GLuint Shader::getProgramHandle()
@@ -200,7 +219,7 @@ void Shader::setUniform(const char *name, float x, float y)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniform2f(loc, x, y);
+		GLState::uniform(loc, x, y);
 	}
 }
 
@@ -208,7 +227,7 @@ void Shader::setUniform(const char *name, float x, float y, float z)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniform3f(loc, x, y, z);
+		GLState::uniform(loc, x, y, z);
 	}
 }
 
@@ -221,7 +240,7 @@ void Shader::setUniform(const char *name, const vec4 &v)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniform4f(loc, v.x, v.y, v.z, v.w);
+		GLState::uniform(loc, v.x, v.y, v.z, v.w);
 	}
 }
 
@@ -229,7 +248,7 @@ void Shader::setUniform(const char *name, const mat4 &m)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniformMatrix4fv(loc, 1, GL_FALSE, &m[0][0]);
+		GLState::uniform_matrix4(loc, &m[0][0]);
 	}
 }
 
@@ -237,7 +256,7 @@ void Shader::setUniform(const char *name, const mat3 &m)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniformMatrix3fv(loc, 1, GL_FALSE, &m[0][0]);
+		GLState::uniform_matrix3(loc, &m[0][0]);
 	}
 }
 
@@ -245,7 +264,7 @@ void Shader::setUniform(const char *name, float val)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniform1f(loc, val);
+		GLState::uniform(loc, val);
 	}
 }
 
@@ -253,7 +272,7 @@ void Shader::setUniform(const char *name, int val)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniform1i(loc, val);
+		GLState::uniform(loc, val);
 	}
 }
 
@@ -261,7 +280,7 @@ void Shader::setUniform(const char *name, bool val)
 {
 	int loc = getUniformLocation(name);
 	if (loc >= 0) {
-		glUniform1i(loc, val);
+		GLState::uniform(loc, val ? 1 : 0);
 	}
 }
 
@@ -270,20 +289,23 @@ int Shader::getUniformLocation(const char *name)
 	return glGetUniformLocation(program_handle, name);
 }
 
-void Shader::set_uniforms(Camera *camera, Light *light, Material *material, mat4 model)
+void Shader::set_frame_uniforms(Camera *camera, Light *light)
 {
-	mat4 mv = (camera->get_view() * model);
-	setUniform("ModelViewMatrix", mv);
-	setUniform("NormalMatrix", mat3(vec3(mv[0]), vec3(mv[1]), vec3(mv[2])));
-	setUniform("MVP", camera->get_projection() * mv);
-
 	setUniform("Light.La", light->get_ambient());
 	setUniform("Light.Ld", light->get_diffuse());
 	setUniform("Light.Ls", light->get_specular());
 	setUniform("Light.Position", camera->get_view() * light->get_position());
+}
+
+void Shader::set_material(int material)
+{
+	setUniform("MaterialIndex", material);
+}
 
-	setUniform("Material.Ka", material->get_ambient());
-	setUniform("Material.Kd", material->get_diffuse());
-	setUniform("Material.Ks", material->get_specular());
-	setUniform("Material.Shininess", material->get_shininess());
+void Shader::set_model_uniforms(Camera *camera, mat4 model)
+{
+	mat4 mv = (camera->get_view() * model);
+	setUniform("ModelViewMatrix", mv);
+	setUniform("NormalMatrix", mat3(vec3(mv[0]), vec3(mv[1]), vec3(mv[2])));
+	setUniform("MVP", camera->get_projection() * mv);
 }
\ No newline at end of file
@@ -7,12 +7,14 @@
 #include <vector>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <map>
 
-#include <gl\glew.h>
-#include <gl\freeglut.h>
-#include <glm\glm.hpp>
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <glm/glm.hpp>
 
-#include "Material.h"
+#include "MaterialTable.h"
 #include "Light.h"
 #include "Camera.h"
 
@@ -30,6 +32,8 @@ class Shader
 public:
 	Shader(char *vtxPath, char *frgPath);
 
+	static Shader *get_shared(char *vtxPath, char *frgPath); // Compiled on first use and kept for the life of the GL context.
+
 	void buildProgram(sh *vtx, sh *frg);
 
 	void linkProgram();
@@ -38,9 +42,13 @@ public:
 
 	void readAndCompileShader();
 
-	void set_uniforms(Camera *camera, Light *light, Material *material, mat4 model);
+	void set_frame_uniforms(Camera *camera, Light *light); // Same for every draw in a frame.
+
+	void set_material(int material); // An index into the MaterialTable, which must be bound.
 
-	void use();
+	void set_model_uniforms(Camera *camera, mat4 model);
+
+	void use(); // Leaves the bound VAO alone; every draw binds its own next.
 
 	GLuint getProgramHandle();
 
@@ -71,6 +79,8 @@ private:
 	char *vertexShaderPath;
 	char *fragmentShaderPath;
 
+	static map<string, Shader*> shared;
+
 	int getUniformLocation(const char *name);
 };
 
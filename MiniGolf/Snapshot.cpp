@@ -0,0 +1,262 @@
+#include <cmath>
+
+#include "Snapshot.h"
+#include "Varint.h"
+
+static int quantize(float value, float scale)
+{
+	return (int)floor(value * scale + 0.5f);
+}
+
+static unsigned int zigzag(int value)
+{
+	return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+}
+
+static int unzigzag(unsigned int value)
+{
+	return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+GameSnapshot::GameSnapshot()
+{
+	hole = 0;
+	turn = 0;
+	flags = 0;
+	for (int i = 0; i < 3; ++i) {
+		position[i] = 0;
+		velocity[i] = 0;
+	}
+}
+
+void GameSnapshot::set_position(vec3 p)
+{
+	position[0] = quantize(p.x, SNAPSHOT_POSITION_SCALE);
+	position[1] = quantize(p.y, SNAPSHOT_POSITION_SCALE);
+	position[2] = quantize(p.z, SNAPSHOT_POSITION_SCALE);
+}
+
+void GameSnapshot::set_velocity(vec3 v)
+{
+	velocity[0] = quantize(v.x, SNAPSHOT_VELOCITY_SCALE);
+	velocity[1] = quantize(v.y, SNAPSHOT_VELOCITY_SCALE);
+	velocity[2] = quantize(v.z, SNAPSHOT_VELOCITY_SCALE);
+}
+
+vec3 GameSnapshot::get_position() const
+{
+	return vec3(position[0], position[1], position[2]) / SNAPSHOT_POSITION_SCALE;
+}
+
+vec3 GameSnapshot::get_velocity() const
+{
+	return vec3(velocity[0], velocity[1], velocity[2]) / SNAPSHOT_VELOCITY_SCALE;
+}
+
+bool GameSnapshot::operator==(const GameSnapshot &other) const
+{
+	for (int i = 0; i < 3; ++i) {
+		if (position[i] != other.position[i] || velocity[i] != other.velocity[i]) {
+			return false;
+		}
+	}
+	return hole == other.hole && turn == other.turn && flags == other.flags && scores == other.scores;
+}
+
+// Without a baseline every field is sent as a difference from zero.
+void SnapshotEncoder::encode_game(string &out, int id, const GameSnapshot &state, const GameSnapshot *baseline)
+{
+	GameSnapshot zero;
+	const GameSnapshot &base = baseline ? *baseline : zero;
+
+	unsigned int mask = 0;
+	if (state.hole != base.hole) mask |= SNAPSHOT_HOLE;
+	if (state.turn != base.turn) mask |= SNAPSHOT_TURN;
+	if (state.flags != base.flags) mask |= SNAPSHOT_FLAGS;
+	for (int i = 0; i < 3; ++i) {
+		if (state.position[i] != base.position[i]) mask |= SNAPSHOT_POSITION_X << i;
+		if (state.velocity[i] != base.velocity[i]) mask |= SNAPSHOT_VELOCITY_X << i;
+	}
+	if (state.scores != base.scores) mask |= SNAPSHOT_SCORES;
+
+	if (mask == 0 && baseline) {
+		return;
+	}
+
+	write_varint(out, id);
+	write_varint(out, mask);
+
+	if (mask & SNAPSHOT_HOLE) write_varint(out, zigzag(state.hole - base.hole));
+	if (mask & SNAPSHOT_TURN) write_varint(out, zigzag(state.turn - base.turn));
+	if (mask & SNAPSHOT_FLAGS) write_varint(out, state.flags);
+	for (int i = 0; i < 3; ++i) {
+		if (mask & (SNAPSHOT_POSITION_X << i)) write_varint(out, zigzag(state.position[i] - base.position[i]));
+	}
+	for (int i = 0; i < 3; ++i) {
+		if (mask & (SNAPSHOT_VELOCITY_X << i)) write_varint(out, zigzag(state.velocity[i] - base.velocity[i]));
+	}
+	if (mask & SNAPSHOT_SCORES) {
+		write_varint(out, state.scores.size());
+		for (vector<int>::size_type i = 0; i < state.scores.size(); ++i) {
+			int previous = i < base.scores.size() ? base.scores[i] : 0;
+			write_varint(out, zigzag(state.scores[i] - previous));
+		}
+	}
+}
+
+bool SnapshotEncoder::decode_game(const string &in, size_t &offset, SnapshotFrame &frame)
+{
+	unsigned int id, mask, value;
+	if (!read_varint(in, offset, id) || !read_varint(in, offset, mask)) {
+		return false;
+	}
+
+	GameSnapshot &state = frame[id];
+
+	if (mask & SNAPSHOT_HOLE) {
+		if (!read_varint(in, offset, value)) return false;
+		state.hole += unzigzag(value);
+	}
+	if (mask & SNAPSHOT_TURN) {
+		if (!read_varint(in, offset, value)) return false;
+		state.turn += unzigzag(value);
+	}
+	if (mask & SNAPSHOT_FLAGS) {
+		if (!read_varint(in, offset, value)) return false;
+		state.flags = value;
+	}
+	for (int i = 0; i < 3; ++i) {
+		if (mask & (SNAPSHOT_POSITION_X << i)) {
+			if (!read_varint(in, offset, value)) return false;
+			state.position[i] += unzigzag(value);
+		}
+	}
+	for (int i = 0; i < 3; ++i) {
+		if (mask & (SNAPSHOT_VELOCITY_X << i)) {
+			if (!read_varint(in, offset, value)) return false;
+			state.velocity[i] += unzigzag(value);
+		}
+	}
+	if (mask & SNAPSHOT_SCORES) {
+		unsigned int count;
+		if (!read_varint(in, offset, count)) return false;
+		state.scores.resize(count, 0);
+		for (unsigned int i = 0; i < count; ++i) {
+			if (!read_varint(in, offset, value)) return false;
+			state.scores[i] += unzigzag(value);
+		}
+	}
+	return true;
+}
+
+// A body is a varint count of removed games and their IDs, then the changed games until the end.
+bool SnapshotDecoder::decode(unsigned int sequence, unsigned int baseline, const string &body)
+{
+	SnapshotFrame frame;
+	if (baseline != 0) {
+		map<unsigned int, SnapshotFrame>::const_iterator base = frames.find(baseline);
+		if (base == frames.end()) {
+			return false;
+		}
+		frame = base->second;
+	}
+
+	size_t offset = 0;
+	unsigned int removed, id;
+	if (!read_varint(body, offset, removed)) {
+		return false;
+	}
+	for (unsigned int i = 0; i < removed; ++i) {
+		if (!read_varint(body, offset, id)) {
+			return false;
+		}
+		frame.erase(id);
+	}
+	while (offset < body.size()) {
+		if (!SnapshotEncoder::decode_game(body, offset, frame)) {
+			return false;
+		}
+	}
+
+	frames[sequence] = frame;
+
+	// The server never deltas against anything older than the client's last ack.
+	while (frames.size() > SNAPSHOT_HISTORY) {
+		frames.erase(frames.begin());
+	}
+	return true;
+}
+
+const SnapshotFrame *SnapshotDecoder::get_frame(unsigned int sequence) const
+{
+	map<unsigned int, SnapshotFrame>::const_iterator i = frames.find(sequence);
+	return i == frames.end() ? NULL : &i->second;
+}
+
+unsigned int SnapshotDecoder::get_latest() const
+{
+	return frames.empty() ? 0 : frames.rbegin()->first;
+}
+
+SnapshotInterpolator::SnapshotInterpolator(double tick, double delay)
+{
+	this->tick = tick;
+	this->delay = delay;
+}
+
+void SnapshotInterpolator::add(unsigned int sequence, const SnapshotFrame &frame)
+{
+	frames[sequence] = frame;
+
+	// Keep one snapshot at or before the render time; everything older is done with.
+	double render = get_render_time();
+	while (frames.size() > 2) {
+		map<unsigned int, SnapshotFrame>::iterator second = frames.begin();
+		++second;
+		if (second->first * tick * SNAPSHOT_INTERVAL > render) {
+			break;
+		}
+		frames.erase(frames.begin());
+	}
+}
+
+double SnapshotInterpolator::get_render_time() const
+{
+	return frames.empty() ? 0.0 : frames.rbegin()->first * tick * SNAPSHOT_INTERVAL - delay;
+}
+
+bool SnapshotInterpolator::sample(int game, double t, vec3 &position) const
+{
+	const GameSnapshot *before = NULL, *after = NULL;
+	double before_time = 0.0, after_time = 0.0;
+
+	for (map<unsigned int, SnapshotFrame>::const_iterator i = frames.begin(); i != frames.end(); ++i) {
+		SnapshotFrame::const_iterator state = i->second.find(game);
+		if (state == i->second.end()) {
+			continue;
+		}
+
+		double time = i->first * tick * SNAPSHOT_INTERVAL;
+		if (time <= t) {
+			before = &state->second;
+			before_time = time;
+		}
+		else {
+			after = &state->second;
+			after_time = time;
+			break;
+		}
+	}
+
+	if (!before && !after) {
+		return false;
+	}
+	if (!before || !after || before->hole != after->hole) {
+		position = (before ? before : after)->get_position(); // Hold at the edges and across holes.
+		return true;
+	}
+
+	float a = (float)((t - before_time) / (after_time - before_time));
+	position = mix(before->get_position(), after->get_position(), a);
+	return true;
+}
\ No newline at end of file
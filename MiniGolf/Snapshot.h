@@ -0,0 +1,106 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+static const float SNAPSHOT_POSITION_SCALE = 4096.0f; // Fixed-point steps per world unit: 0.25 mm on a 4 m hole.
+static const float SNAPSHOT_VELOCITY_SCALE = 1024.0f; // Steps per unit per second.
+static const int SNAPSHOT_INTERVAL = 3; // Ticks between snapshots: 20 a second at the physics rate.
+static const unsigned int SNAPSHOT_HISTORY = 64; // Snapshots kept as possible delta baselines.
+
+enum SnapshotField {
+	SNAPSHOT_HOLE = 1 << 0,
+	SNAPSHOT_TURN = 1 << 1,
+	SNAPSHOT_FLAGS = 1 << 2,
+	SNAPSHOT_POSITION_X = 1 << 3,
+	SNAPSHOT_POSITION_Y = 1 << 4,
+	SNAPSHOT_POSITION_Z = 1 << 5,
+	SNAPSHOT_VELOCITY_X = 1 << 6,
+	SNAPSHOT_VELOCITY_Y = 1 << 7,
+	SNAPSHOT_VELOCITY_Z = 1 << 8,
+	SNAPSHOT_SCORES = 1 << 9
+};
+
+enum SnapshotFlag {
+	SNAPSHOT_ROLLING = 1 << 0,
+	SNAPSHOT_OVER = 1 << 1
+};
+
+// What a spectator sees of one game, already quantized, so equal states compare equal.
+struct GameSnapshot {
+	int hole;
+	int turn;
+	int flags;
+	int position[3];
+	int velocity[3];
+	vector<int> scores; // Total strokes per player.
+
+	GameSnapshot();
+
+	void set_position(vec3 p);
+
+	void set_velocity(vec3 v);
+
+	vec3 get_position() const;
+
+	vec3 get_velocity() const;
+
+	bool operator==(const GameSnapshot &other) const;
+};
+
+typedef map<int, GameSnapshot> SnapshotFrame; // By game ID.
+
+// Delta encoding of one game: a varint mask of the fields that differ from the baseline,
+// then each of those as a zigzag varint difference. Unchanged games encode to nothing.
+class SnapshotEncoder
+{
+public:
+	static void encode_game(string &out, int id, const GameSnapshot &state, const GameSnapshot *baseline);
+
+	static bool decode_game(const string &in, size_t &offset, SnapshotFrame &frame); // Applies onto whatever frame holds for that game.
+};
+
+// Client side: rebuilds frames from the server's deltas and keeps recent ones as baselines.
+class SnapshotDecoder
+{
+public:
+	// body is what followed a "snap <sequence> <baseline> <length>" line. Returns false if the
+	// baseline is no longer known, in which case the client should ack nothing until a full frame.
+	bool decode(unsigned int sequence, unsigned int baseline, const string &body);
+
+	const SnapshotFrame *get_frame(unsigned int sequence) const;
+
+	unsigned int get_latest() const;
+
+private:
+	map<unsigned int, SnapshotFrame> frames;
+};
+
+// Renders between the two snapshots around a point a little in the past, so motion stays
+// smooth while snapshots arrive at SNAPSHOT_INTERVAL ticks.
+class SnapshotInterpolator
+{
+public:
+	SnapshotInterpolator(double tick, double delay);
+
+	void add(unsigned int sequence, const SnapshotFrame &frame);
+
+	// Ball position of a game at server time t; false if there is nothing to show yet.
+	bool sample(int game, double t, vec3 &position) const;
+
+	double get_render_time() const; // Latest server time minus the delay.
+
+private:
+	double tick;
+	double delay;
+	map<unsigned int, SnapshotFrame> frames; // Sequence times tick times SNAPSHOT_INTERVAL is the server time.
+};
+
+#endif
\ No newline at end of file
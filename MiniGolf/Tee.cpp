@@ -2,8 +2,7 @@
 
 Tee::Tee() {}
 
-Tee::Tee(int id, vec3 position, vector<vec3> verts) : Plane(id, position, verts)
+Tee::Tee(int id, vec3 position, vector<vec3> verts, Arena *arena) : Plane(id, position, verts, arena)
 {
-	material = new Material(vec3(0.1f, 0.1f, 1.0f), vec3(0.1f, 0.1f, 1.0f), vec3(0.0f), 100.0f);
-	init_gl();
+	material = MaterialTable::add(Material(vec3(0.1f, 0.1f, 1.0f), vec3(0.1f, 0.1f, 1.0f), vec3(0.0f), 100.0f));
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ class Tee : public Plane {
 public:
 	Tee();
 
-	Tee(int id, vec3 position, vector<vec3> verts);
+	Tee(int id, vec3 position, vector<vec3> verts, Arena *arena);
 };
 
 #endif
\ No newline at end of file
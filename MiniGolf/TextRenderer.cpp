@@ -0,0 +1,242 @@
+#include "TextRenderer.h"
+#include "GLState.h"
+
+TextRenderer::TextRenderer()
+{
+	dirty = false;
+	relayout = false;
+
+	float sx = GLYPH_CELL_WIDTH / STROKE_ADVANCE;
+	float sy = GLYPH_CELL_HEIGHT / (STROKE_ASCENT + STROKE_DESCENT);
+	atlas_scale = sx < sy ? sx : sy;
+
+	glGenBuffers(1, &vbo);
+
+	bake_atlas();
+}
+
+TextRenderer::~TextRenderer()
+{
+	glDeleteBuffers(1, &vbo);
+	glDeleteTextures(1, &atlas);
+}
+
+// Render each glyph once into a texture through an FBO, with the same stroke font the HUD used before.
+void TextRenderer::bake_atlas()
+{
+	glGenTextures(1, &atlas);
+	glBindTexture(GL_TEXTURE_2D, atlas);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	GLuint fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas, 0);
+
+	GLint viewport[4];
+	GLfloat clear_color[4];
+	GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+	glViewport(0, 0, ATLAS_SIZE, ATLAS_SIZE);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	GLState::use_program(0);
+	GLState::disable(GL_DEPTH_TEST);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0.0, ATLAS_SIZE, 0.0, ATLAS_SIZE, -1.0, 1.0);
+
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glColor4f(1, 1, 1, 1);
+	glLineWidth(2.0f);
+
+	for (int i = 0; i < GLYPH_COUNT; ++i) {
+		int column = i % ATLAS_COLUMNS;
+		int row = i / ATLAS_COLUMNS;
+
+		glPushMatrix();
+		glTranslatef((float)(column * GLYPH_CELL_WIDTH), row * GLYPH_CELL_HEIGHT + STROKE_DESCENT * atlas_scale, 0.0f);
+		glScalef(atlas_scale, atlas_scale, 1.0f);
+		glutStrokeCharacter(GLUT_STROKE_MONO_ROMAN, GLYPH_FIRST + i);
+		glPopMatrix();
+	}
+
+	glLineWidth(1.0f);
+
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+
+	if (depth_test) {
+		GLState::enable(GL_DEPTH_TEST);
+	}
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &fbo);
+}
+
+int TextRenderer::create_label(float x, float y, float scale)
+{
+	Label label;
+	label.x = x;
+	label.y = y;
+	label.scale = scale;
+	label.first = 0;
+	label.capacity = 0;
+	label.dirty = false;
+	labels.push_back(label);
+	relayout = true; // Needs a range of its own.
+
+	return labels.size() - 1;
+}
+
+void TextRenderer::set_text(int label, const string &text)
+{
+	Label &l = labels[label];
+	if (l.text != text) {
+		l.text = text;
+		l.dirty = true;
+		dirty = true;
+	}
+}
+
+void TextRenderer::set_text(int label, const char *text)
+{
+	Label &l = labels[label];
+	if (l.text.compare(text) != 0) {
+		l.text.assign(text);
+		l.dirty = true;
+		dirty = true;
+	}
+}
+
+void TextRenderer::build_vertices(Label &label) const
+{
+	label.vertices.clear();
+
+	float cell_u = (float)GLYPH_CELL_WIDTH / ATLAS_SIZE;
+	float cell_v = (float)GLYPH_CELL_HEIGHT / ATLAS_SIZE;
+
+	// A cell is this big on screen at the label's scale.
+	float w = GLYPH_CELL_WIDTH / atlas_scale * label.scale;
+	float h = GLYPH_CELL_HEIGHT / atlas_scale * label.scale;
+	float x = label.x;
+	float y = label.y - STROKE_DESCENT * label.scale;
+
+	for (string::size_type j = 0; j < label.text.size(); ++j) {
+		int glyph = (unsigned char)label.text[j] - GLYPH_FIRST;
+
+		if (glyph > 0 && glyph < GLYPH_COUNT) {
+			float u = (glyph % ATLAS_COLUMNS) * cell_u;
+			float v = (glyph / ATLAS_COLUMNS) * cell_v;
+
+			float quad[16] = {
+				x, y, u, v,
+				x + w, y, u + cell_u, v,
+				x + w, y + h, u + cell_u, v + cell_v,
+				x, y + h, u, v + cell_v
+			};
+			label.vertices.insert(label.vertices.end(), quad, quad + 16);
+		}
+		x += STROKE_ADVANCE * label.scale;
+	}
+}
+
+// Rebuilds the quads of changed labels only. Those that still fit their range are written in place;
+// if one outgrew it, every label gets a new range and the buffer is filled again from the cached quads.
+void TextRenderer::update_buffer()
+{
+	for (vector<Label>::size_type i = 0; i < labels.size(); ++i) {
+		Label &label = labels[i];
+		if (label.dirty) {
+			build_vertices(label);
+			if ((GLsizei)(label.vertices.size() / 4) > label.capacity) {
+				relayout = true;
+			}
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	if (relayout) {
+		GLint total = 0;
+		for (vector<Label>::size_type i = 0; i < labels.size(); ++i) {
+			Label &label = labels[i];
+			GLsizei needed = (GLsizei)(label.vertices.size() / 4);
+			if (needed > label.capacity) {
+				label.capacity = needed * 2 > LABEL_MIN_CAPACITY * 4 ? needed * 2 : LABEL_MIN_CAPACITY * 4;
+			}
+			label.first = total;
+			total += label.capacity;
+		}
+
+		glBufferData(GL_ARRAY_BUFFER, total * 4 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+		for (vector<Label>::size_type i = 0; i < labels.size(); ++i) {
+			labels[i].dirty = !labels[i].vertices.empty();
+		}
+		relayout = false;
+	}
+
+	for (vector<Label>::size_type i = 0; i < labels.size(); ++i) {
+		Label &label = labels[i];
+		if (label.dirty && !label.vertices.empty()) {
+			glBufferSubData(GL_ARRAY_BUFFER, label.first * 4 * sizeof(float), label.vertices.size() * sizeof(float), &label.vertices[0]);
+		}
+		label.dirty = false;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	draw_firsts.clear();
+	draw_counts.clear();
+	for (vector<Label>::size_type i = 0; i < labels.size(); ++i) {
+		if (!labels[i].vertices.empty()) {
+			draw_firsts.push_back(labels[i].first);
+			draw_counts.push_back((GLsizei)(labels[i].vertices.size() / 4));
+		}
+	}
+
+	dirty = false;
+}
+
+void TextRenderer::draw()
+{
+	if (dirty || relayout) {
+		update_buffer();
+	}
+	if (draw_counts.empty()) {
+		return;
+	}
+
+	GLState::enable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, atlas);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 4 * sizeof(float), ((GLubyte *)NULL + (0)));
+	glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(float), ((GLubyte *)NULL + (2 * sizeof(float))));
+
+	glMultiDrawArrays(GL_QUADS, &draw_firsts[0], &draw_counts[0], (GLsizei)draw_counts.size());
+
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::disable(GL_TEXTURE_2D);
+}
\ No newline at end of file
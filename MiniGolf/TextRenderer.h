@@ -0,0 +1,70 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+using namespace std;
+
+// Glyph atlas baked from GLUT_STROKE_MONO_ROMAN: printable ASCII in a grid of fixed-size cells.
+static const int GLYPH_FIRST = 32;
+static const int GLYPH_COUNT = 95;
+static const int GLYPH_CELL_WIDTH = 32;
+static const int GLYPH_CELL_HEIGHT = 48;
+static const int ATLAS_COLUMNS = 16;
+static const int ATLAS_SIZE = 512;
+
+// Stroke font metrics, in font units.
+static const float STROKE_ADVANCE = 104.76f;
+static const float STROKE_ASCENT = 119.05f;
+static const float STROKE_DESCENT = 33.33f;
+
+static const int LABEL_MIN_CAPACITY = 16; // Glyphs reserved for a label before it first grows.
+
+// Draws every label in one textured draw call. Each label keeps its quads and a reserved range of the
+// shared vertex buffer; changing its text rewrites only that range, until it outgrows it.
+class TextRenderer
+{
+public:
+	TextRenderer(); // Needs a current GL context.
+
+	~TextRenderer();
+
+	int create_label(float x, float y, float scale); // Baseline origin in pixels; scale as for glutStrokeCharacter.
+
+	void set_text(int label, const string &text);
+
+	void set_text(int label, const char *text); // Reuses the label's string, so an unchanged or no longer text allocates nothing.
+
+	void draw(); // Expects a pixel-space ortho projection and blending already set up.
+
+private:
+	struct Label {
+		string text;
+		float x, y, scale;
+		vector<float> vertices; // x, y, u, v per corner; four corners per glyph.
+		GLint first; // Where its range starts in the buffer, in vertices.
+		GLsizei capacity; // Vertices reserved for it.
+		bool dirty; // Text changed since its range was written.
+	};
+
+	vector<Label> labels;
+	bool dirty; // Some label needs writing.
+	bool relayout; // Some label outgrew its range, so the whole buffer is laid out again.
+
+	GLuint atlas;
+	GLuint vbo;
+	vector<GLint> draw_firsts; // Ranges of labels with text, for the one glMultiDrawArrays.
+	vector<GLsizei> draw_counts;
+	float atlas_scale; // Font units to atlas pixels.
+
+	void bake_atlas();
+
+	void build_vertices(Label &label) const;
+
+	void update_buffer();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,369 @@
+#include "TextureAtlas.h"
+#include "SOIL/SOIL.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static int next_power_of_two(int n)
+{
+	int p = 1;
+	while (p < n) {
+		p *= 2;
+	}
+	return p;
+}
+
+vec2 AtlasRegion::remap(vec2 uv) const
+{
+	return vec2(u0 + uv.x * (u1 - u0), v0 + uv.y * (v1 - v0));
+}
+
+void AtlasRegion::remap(float *uvs, int count) const
+{
+	for (int i = 0; i < count; ++i) {
+		vec2 uv = remap(vec2(uvs[i * 2], uvs[i * 2 + 1]));
+		uvs[i * 2] = uv.x;
+		uvs[i * 2 + 1] = uv.y;
+	}
+}
+
+// Pages are power-of-two textures, so the page size is rounded up to one.
+TextureAtlas::TextureAtlas(int page_size, int padding)
+{
+	this->page_size = next_power_of_two(page_size);
+	this->padding = padding < 0 ? 0 : padding;
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	for (vector<GLuint>::size_type i = 0; i < textures.size(); ++i) {
+		glDeleteTextures(1, &textures[i]);
+	}
+}
+
+bool TextureAtlas::add(string name, string path)
+{
+	int width, height, channels;
+	unsigned char *rgba = SOIL_load_image(path.c_str(), &width, &height, &channels, SOIL_LOAD_RGBA);
+	if (!rgba) {
+		cout << "error - could not load " << path << ": " << SOIL_last_result() << endl;
+		return false;
+	}
+
+	bool added = add(name, rgba, width, height);
+	SOIL_free_image_data(rgba);
+	return added;
+}
+
+bool TextureAtlas::add(string name, const unsigned char *rgba, int width, int height)
+{
+	bool queued = false;
+	for (vector<Image>::size_type i = 0; i < images.size(); ++i) {
+		queued = queued || images[i].name == name;
+	}
+	if (queued || regions.find(name) != regions.end()) {
+		cout << "error - the atlas already has an image named " << name << endl;
+		return false;
+	}
+	if (width < 1 || height < 1 || width + 2 * padding > page_size || height + 2 * padding > page_size) {
+		cout << "error - " << name << " (" << width << "x" << height << ") does not fit a " << page_size << " atlas page" << endl;
+		return false;
+	}
+
+	Image image;
+	image.name = name;
+	image.width = width;
+	image.height = height;
+	image.pixels.assign(rgba, rgba + width * height * 4);
+	images.push_back(image);
+	return true;
+}
+
+// Tallest first fills shelves with little wasted height; names keep the layout reproducible.
+bool TextureAtlas::is_taller(const Image *a, const Image *b)
+{
+	if (a->height != b->height) {
+		return a->height > b->height;
+	}
+	return a->name < b->name;
+}
+
+bool TextureAtlas::pack()
+{
+	if (!textures.empty()) {
+		cout << "error - the atlas was already uploaded and cannot take more images" << endl;
+		return false;
+	}
+
+	vector<const Image*> order;
+	for (vector<Image>::size_type i = 0; i < images.size(); ++i) {
+		order.push_back(&images[i]);
+	}
+	sort(order.begin(), order.end(), is_taller);
+
+	for (vector<const Image*>::size_type i = 0; i < order.size(); ++i) {
+		const Image &image = *order[i];
+
+		AtlasRegion region;
+		if (!place(image.width + 2 * padding, image.height + 2 * padding, region.page, region.x, region.y)) {
+			cout << "error - no room in the atlas for " << image.name << endl;
+			return false;
+		}
+		region.x += padding;
+		region.y += padding;
+		region.width = image.width;
+		region.height = image.height;
+
+		blit(image, region);
+		regions[image.name] = region;
+	}
+	images.clear();
+
+	update_uvs();
+	return true;
+}
+
+// Shelf packing: each page fills with rows as tall as their first (tallest) image. An image that does not fit
+// the open shelf of a page closes it and starts a new one below, or moves on to the next page.
+bool TextureAtlas::place(int width, int height, int &page, int &x, int &y)
+{
+	for (vector<Page>::size_type i = 0; i <= pages.size(); ++i) {
+		if (i == pages.size()) {
+			Page fresh;
+			fresh.width = fresh.height = 0;
+			fresh.shelf_y = fresh.shelf_height = fresh.cursor_x = 0;
+			fresh.pixels.assign(page_size * page_size * 4, 0);
+			pages.push_back(fresh);
+		}
+		Page &p = pages[i];
+
+		int shelf_y = p.shelf_y, shelf_height = p.shelf_height, cursor_x = p.cursor_x;
+		if (cursor_x + width > page_size || (height > shelf_height && cursor_x > 0)) {
+			shelf_y += shelf_height;
+			shelf_height = 0;
+			cursor_x = 0;
+		}
+		if (shelf_y + max(shelf_height, height) > page_size) {
+			continue;
+		}
+
+		p.shelf_y = shelf_y;
+		p.shelf_height = max(shelf_height, height);
+		p.cursor_x = cursor_x + width;
+		p.width = max(p.width, p.cursor_x);
+		p.height = max(p.height, p.shelf_y + p.shelf_height);
+
+		page = (int)i;
+		x = cursor_x;
+		y = shelf_y;
+		return true;
+	}
+	return false;
+}
+
+// The padding repeats the nearest edge texel, as GL_CLAMP_TO_EDGE would for the image on its own.
+void TextureAtlas::blit(const Image &image, const AtlasRegion &region)
+{
+	Page &p = pages[region.page];
+	for (int row = -padding; row < image.height + padding; ++row) {
+		int src_row = min(max(row, 0), image.height - 1);
+		unsigned char *dst = &p.pixels[((region.y + row) * page_size + region.x - padding) * 4];
+		for (int col = -padding; col < image.width + padding; ++col) {
+			int src_col = min(max(col, 0), image.width - 1);
+			memcpy(dst, &image.pixels[(src_row * image.width + src_col) * 4], 4);
+			dst += 4;
+		}
+	}
+}
+
+// Each page is trimmed to the power of two around what it uses, so UVs move whenever a page grows.
+void TextureAtlas::update_uvs()
+{
+	for (map<string, AtlasRegion>::iterator it = regions.begin(); it != regions.end(); ++it) {
+		AtlasRegion &r = it->second;
+		float width = (float)next_power_of_two(pages[r.page].width);
+		float height = (float)next_power_of_two(pages[r.page].height);
+		r.u0 = r.x / width;
+		r.v0 = r.y / height;
+		r.u1 = (r.x + r.width) / width;
+		r.v1 = (r.y + r.height) / height;
+	}
+}
+
+const AtlasRegion *TextureAtlas::find(string name) const
+{
+	map<string, AtlasRegion>::const_iterator it = regions.find(name);
+	return it == regions.end() ? NULL : &it->second;
+}
+
+int TextureAtlas::get_page_count() const
+{
+	return (int)pages.size();
+}
+
+GLuint TextureAtlas::get_texture(int page) const
+{
+	return page >= 0 && page < (int)textures.size() ? textures[page] : 0;
+}
+
+// Mip levels past log2(padding) would average texels of neighbouring images together, so they are never built.
+void TextureAtlas::upload()
+{
+	int max_level = 0;
+	while ((2 << max_level) <= padding) {
+		++max_level;
+	}
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, page_size);
+	for (vector<Page>::size_type i = 0; i < pages.size(); ++i) {
+		Page &p = pages[i];
+
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, next_power_of_two(p.width), next_power_of_two(p.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, &p.pixels[0]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, max_level);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, max_level > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		if (max_level > 0) {
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
+		textures.push_back(texture);
+
+		vector<unsigned char>().swap(p.pixels);
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// atlas <page size> <padding> <pages>
+// page <index> <width> <height>
+// region <page> <x> <y> <width> <height> <name to the end of the line>
+bool TextureAtlas::write(string path) const
+{
+	if (!textures.empty()) {
+		cout << "error - the atlas was already uploaded, so its pixels are gone" << endl;
+		return false;
+	}
+
+	ofstream out(path.c_str());
+	if (!out) {
+		cout << "error - could not write " << path << endl;
+		return false;
+	}
+	out << "atlas " << page_size << " " << padding << " " << pages.size() << endl;
+
+	for (vector<Page>::size_type i = 0; i < pages.size(); ++i) {
+		const Page &p = pages[i];
+		int width = next_power_of_two(p.width), height = next_power_of_two(p.height);
+		out << "page " << i << " " << width << " " << height << endl;
+
+		vector<unsigned char> trimmed(width * height * 4);
+		for (int row = 0; row < height; ++row) {
+			memcpy(&trimmed[row * width * 4], &p.pixels[row * page_size * 4], width * 4);
+		}
+
+		stringstream name;
+		name << path << "." << i << ".tga";
+		if (!SOIL_save_image(name.str().c_str(), SOIL_SAVE_TYPE_TGA, width, height, 4, &trimmed[0])) {
+			cout << "error - could not write " << name.str() << endl;
+			return false;
+		}
+	}
+
+	for (map<string, AtlasRegion>::const_iterator it = regions.begin(); it != regions.end(); ++it) {
+		const AtlasRegion &r = it->second;
+		out << "region " << r.page << " " << r.x << " " << r.y << " " << r.width << " " << r.height << " " << it->first << endl;
+	}
+	return !out.fail();
+}
+
+// Read pages are closed: images packed afterwards go onto new pages.
+bool TextureAtlas::read(string path)
+{
+	ifstream in(path.c_str());
+	string word;
+	int page_count = 0;
+	if (!(in >> word >> page_size >> padding >> page_count) || word != "atlas" || page_count < 0) {
+		cout << "error - " << path << " is not a texture atlas" << endl;
+		return false;
+	}
+
+	pages.clear();
+	regions.clear();
+	for (int i = 0; i < page_count; ++i) {
+		int index, width, height;
+		if (!(in >> word >> index >> width >> height) || word != "page" || index != i || width > page_size || height > page_size) {
+			cout << "error - bad page in " << path << endl;
+			return false;
+		}
+
+		stringstream name;
+		name << path << "." << i << ".tga";
+		int loaded_width, loaded_height, channels;
+		unsigned char *rgba = SOIL_load_image(name.str().c_str(), &loaded_width, &loaded_height, &channels, SOIL_LOAD_RGBA);
+		if (!rgba || loaded_width != width || loaded_height != height) {
+			cout << "error - could not load atlas page " << name.str() << endl;
+			SOIL_free_image_data(rgba);
+			return false;
+		}
+
+		Page p;
+		p.width = width;
+		p.height = height;
+		p.shelf_y = page_size;
+		p.shelf_height = p.cursor_x = 0;
+		p.pixels.assign(page_size * height * 4, 0);
+		for (int row = 0; row < height; ++row) {
+			memcpy(&p.pixels[row * page_size * 4], &rgba[row * width * 4], width * 4);
+		}
+		SOIL_free_image_data(rgba);
+		pages.push_back(p);
+	}
+
+	while (in >> word) {
+		AtlasRegion r;
+		string name;
+		if (word != "region" || !(in >> r.page >> r.x >> r.y >> r.width >> r.height) || !getline(in >> ws, name) ||
+			r.page < 0 || r.page >= page_count) {
+			cout << "error - bad region in " << path << endl;
+			return false;
+		}
+		regions[name] = r;
+	}
+
+	update_uvs();
+	return true;
+}
+
+int run_atlas_builder(int argc, char **argv)
+{
+	if (argc < 2) {
+		cout << "usage: MiniGolf --build-atlas out.atlas image..." << endl;
+		return 1;
+	}
+
+	// Images are named by their file name without directory or extension.
+	TextureAtlas atlas;
+	for (int i = 1; i < argc; ++i) {
+		string path = argv[i];
+		string name = path.substr(path.find_last_of("/\\") + 1);
+		name = name.substr(0, name.find_last_of('.'));
+		if (!atlas.add(name, path)) {
+			return 1;
+		}
+	}
+
+	if (!atlas.pack() || !atlas.write(argv[0])) {
+		return 1;
+	}
+
+	cout << "Wrote " << argv[0] << ": " << argc - 1 << " images on " << atlas.get_page_count() << " pages." << endl;
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+static const int TEXTURE_ATLAS_SIZE = 2048; // Widest page; every GL the game runs on samples textures this large.
+static const int TEXTURE_ATLAS_PADDING = 4; // Edge texels repeated around each image, so neither filtering nor the first mip levels reach a neighbour.
+
+// Where one image landed in an atlas. Texel coordinates exclude the padding; UVs are in the page's [0, 1] space.
+struct AtlasRegion {
+	int page;
+	int x, y, width, height;
+	float u0, v0, u1, v1;
+
+	vec2 remap(vec2 uv) const; // A UV over the whole source image to the same spot in the atlas. No wrapping: keep it in [0, 1].
+
+	void remap(float *uvs, int count) const; // In place, on count interleaved (s, t) pairs.
+};
+
+// Packs many small RGBA images into a few large textures, so objects drawn with different images
+// can share one bind. Images are sorted by height and laid out on shelves, left to right, a new page
+// starting when one fills up. Pack at runtime with add()/pack()/upload(), or ahead of time with
+// --build-atlas and read() the result.
+class TextureAtlas
+{
+public:
+	TextureAtlas(int page_size = TEXTURE_ATLAS_SIZE, int padding = TEXTURE_ATLAS_PADDING);
+
+	~TextureAtlas(); // Deletes the page textures.
+
+	bool add(string name, string path); // Decodes the file now; the pixels are kept until upload().
+
+	bool add(string name, const unsigned char *rgba, int width, int height);
+
+	bool pack(); // Places everything added since the last pack. False if an image cannot fit on a page.
+
+	const AtlasRegion *find(string name) const; // NULL for a name never packed.
+
+	int get_page_count() const;
+
+	GLuint get_texture(int page) const; // 0 until upload().
+
+	void upload(); // Needs a current GL context. One mipmapped texture per page, then the pixels are dropped.
+
+	// A text manifest at path with the pages beside it as path.N.tga.
+	bool write(string path) const;
+
+	bool read(string path);
+
+private:
+	struct Image {
+		string name;
+		int width, height;
+		vector<unsigned char> pixels;
+	};
+
+	struct Page {
+		int width, height;
+		int shelf_y, shelf_height, cursor_x; // The open shelf.
+		vector<unsigned char> pixels;
+	};
+
+	int page_size;
+	int padding;
+	vector<Image> images; // Added, not yet packed.
+	vector<Page> pages;
+	map<string, AtlasRegion> regions;
+	vector<GLuint> textures;
+
+	TextureAtlas(const TextureAtlas &);
+
+	TextureAtlas &operator=(const TextureAtlas &);
+
+	static bool is_taller(const Image *a, const Image *b);
+
+	bool place(int width, int height, int &page, int &x, int &y); // Finds room for a padded cell.
+
+	void blit(const Image &image, const AtlasRegion &region); // Copies the image in and fills its padding.
+
+	void update_uvs();
+};
+
+// MiniGolf --build-atlas out.atlas image...
+int run_atlas_builder(int argc, char **argv);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "TextureCache.h"
+#include "SOIL/image_DXT.h"
+#include "JobSystem.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+bool TextureImage::is_compressed() const
+{
+	return internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || internal_format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ||
+		internal_format == GL_COMPRESSED_RGBA_S3TC_DXT3_EXT || internal_format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+TextureCache::TextureCache(string directory)
+{
+	this->directory = directory;
+}
+
+// 64-bit FNV-1a over the source bytes, then the flags and cache version, so any change lands on a new file.
+string TextureCache::get_cache_path(const vector<unsigned char> &source, unsigned int flags) const
+{
+	unsigned long long hash = 14695981039346656037ull;
+	for (vector<unsigned char>::size_type i = 0; i < source.size(); ++i) {
+		hash = (hash ^ source[i]) * 1099511628211ull;
+	}
+
+	unsigned int key[2] = { flags, TEXTURE_CACHE_VERSION };
+	for (int i = 0; i < 2; ++i) {
+		for (int b = 0; b < 4; ++b) {
+			hash = (hash ^ ((key[i] >> (b * 8)) & 0xFF)) * 1099511628211ull;
+		}
+	}
+
+	stringstream name;
+	name << directory << "/" << hex << setw(16) << setfill('0') << hash << ".dds";
+	return name.str();
+}
+
+bool TextureCache::read(string cache_path, TextureImage &image) const
+{
+	vector<unsigned char> file;
+	if (!read_file(cache_path, file) || file.size() < sizeof(DDS_header)) {
+		return false;
+	}
+
+	DDS_header header;
+	memcpy(&header, &file[0], sizeof(DDS_header));
+	if (header.dwMagic != (('D' << 0) | ('D' << 8) | ('S' << 16) | (' ' << 24)) || header.dwSize != 124 ||
+		!(header.sPixelFormat.dwFlags & DDPF_FOURCC) || header.dwWidth < 1 || header.dwHeight < 1) {
+		return false;
+	}
+
+	unsigned int block_size = 16;
+	switch (header.sPixelFormat.dwFourCC) {
+	case ('D' << 0) | ('X' << 8) | ('T' << 16) | ('1' << 24):
+		image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		block_size = 8;
+		break;
+	case ('D' << 0) | ('X' << 8) | ('T' << 16) | ('3' << 24):
+		image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		break;
+	case ('D' << 0) | ('X' << 8) | ('T' << 16) | ('5' << 24):
+		image.internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		break;
+	default:
+		return false;
+	}
+	image.pixel_format = GL_RGBA;
+
+	unsigned int level_count = 1;
+	if ((header.sCaps.dwCaps1 & DDSCAPS_MIPMAP) && header.dwMipMapCount > 1) {
+		level_count = header.dwMipMapCount;
+	}
+
+	// Same level sizes as SOIL's DDS loader.
+	image.levels.clear();
+	vector<unsigned char>::size_type offset = sizeof(DDS_header);
+	for (unsigned int i = 0; i < level_count; ++i) {
+		TextureLevel level;
+		level.width = header.dwWidth >> i;
+		level.height = header.dwHeight >> i;
+		if (level.width < 1) {
+			level.width = 1;
+		}
+		if (level.height < 1) {
+			level.height = 1;
+		}
+
+		vector<unsigned char>::size_type size = ((level.width + 3) / 4) * ((level.height + 3) / 4) * block_size;
+		if (offset + size > file.size()) {
+			return false;
+		}
+		level.data.assign(file.begin() + offset, file.begin() + offset + size);
+		offset += size;
+
+		image.levels.push_back(level);
+	}
+	return true;
+}
+
+bool TextureCache::write(string cache_path, const TextureImage &image) const
+{
+	char dxt;
+	switch (image.internal_format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		dxt = '1';
+		break;
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		dxt = '3';
+		break;
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		dxt = '5';
+		break;
+	default:
+		return false;
+	}
+	if (image.levels.empty()) {
+		return false;
+	}
+
+	DDS_header header;
+	memset(&header, 0, sizeof(DDS_header));
+	header.dwMagic = ('D' << 0) | ('D' << 8) | ('S' << 16) | (' ' << 24);
+	header.dwSize = 124;
+	header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+	header.dwWidth = image.levels[0].width;
+	header.dwHeight = image.levels[0].height;
+	header.dwPitchOrLinearSize = (unsigned int)image.levels[0].data.size();
+	header.sPixelFormat.dwSize = 32;
+	header.sPixelFormat.dwFlags = DDPF_FOURCC;
+	header.sPixelFormat.dwFourCC = ('D' << 0) | ('X' << 8) | ('T' << 16) | (dxt << 24);
+	header.sCaps.dwCaps1 = DDSCAPS_TEXTURE;
+	if (image.levels.size() > 1) {
+		header.dwFlags |= DDSD_MIPMAPCOUNT;
+		header.dwMipMapCount = (unsigned int)image.levels.size();
+		header.sCaps.dwCaps1 |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	}
+
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+
+	// Write beside the final name and rename, so a crash never leaves a truncated entry behind.
+	// The thread index keeps two workers baking the same texture out of each other's way.
+	stringstream temp_name;
+	temp_name << cache_path << "." << JobSystem::get_thread_index() << ".tmp";
+	string temp_path = temp_name.str();
+
+	ofstream file(temp_path.c_str(), ios::binary);
+	if (!file) {
+		cout << "error - could not write texture cache entry " << cache_path << endl;
+		return false;
+	}
+	file.write((const char *)&header, sizeof(DDS_header));
+	for (vector<TextureLevel>::size_type i = 0; i < image.levels.size(); ++i) {
+		file.write((const char *)&image.levels[i].data[0], image.levels[i].data.size());
+	}
+	file.close();
+
+	if (file.fail() || rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+		remove(temp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool TextureCache::read_file(string path, vector<unsigned char> &data)
+{
+	ifstream file(path.c_str(), ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	file.seekg(0, ios::end);
+	streamoff size = file.tellg();
+	file.seekg(0, ios::beg);
+	if (size <= 0) {
+		return false;
+	}
+
+	data.resize((vector<unsigned char>::size_type)size);
+	file.read((char *)&data[0], size);
+	return !file.fail();
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+using namespace std;
+
+static const char *const TEXTURE_CACHE_DIRECTORY = "TextureCache";
+static const unsigned int TEXTURE_CACHE_VERSION = 1; // Bump to orphan every baked file when the baking changes.
+
+struct TextureLevel {
+	int width, height;
+	vector<unsigned char> data;
+};
+
+// A texture in its final form, every mip level ready to hand to GL.
+struct TextureImage {
+	GLenum internal_format; // An S3TC format means the levels hold DXT blocks.
+	GLenum pixel_format; // Layout of uncompressed levels.
+	vector<TextureLevel> levels;
+
+	bool is_compressed() const;
+};
+
+// Keeps the fully processed texture (alpha multiplied, mipmapped, DXT compressed) on disk as a DDS,
+// named by a hash of the source file's bytes and the SOIL flags. A hit skips decoding and compression entirely.
+class TextureCache
+{
+public:
+	TextureCache(string directory = TEXTURE_CACHE_DIRECTORY);
+
+	string get_cache_path(const vector<unsigned char> &source, unsigned int flags) const;
+
+	// Entries are plain DDS files holding DXT1/3/5 levels. Neither touches GL, so workers may call them.
+	bool read(string cache_path, TextureImage &image) const;
+
+	bool write(string cache_path, const TextureImage &image) const;
+
+	static bool read_file(string path, vector<unsigned char> &data);
+
+private:
+	string directory;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include "TextureStreamer.h"
+#include "Profiler.h"
+#include "SOIL/SOIL.h"
+#include "SOIL/stb_image_aug.h"
+#include "SOIL/image_helper.h"
+
+extern "C" {
+#include "SOIL/image_DXT.h"
+}
+
+#include <cstdlib>
+#include <cstring>
+
+TextureStreamer::TextureStreamer()
+{
+	jobs = JobSystem::get_instance();
+
+	can_compress = GLEW_EXT_texture_compression_s3tc != 0;
+	max_size = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+	glGenBuffers(TEXTURE_UPLOAD_RING_SIZE, pbos);
+	for (int i = 0; i < TEXTURE_UPLOAD_RING_SIZE; ++i) {
+		pbo_sizes[i] = 0;
+	}
+	next_pbo = 0;
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	decodes.wait();
+
+	for (deque<Request*>::size_type i = 0; i < finished.size(); ++i) {
+		delete finished[i];
+	}
+	glDeleteBuffers(TEXTURE_UPLOAD_RING_SIZE, pbos);
+}
+
+GLuint TextureStreamer::request(string path, unsigned int flags)
+{
+	// One transparent texel until the real image lands; it draws nothing under either blend mode.
+	static const unsigned char placeholder[4] = { 0, 0, 0, 0 };
+
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if (!GLEW_ARB_texture_non_power_of_two) {
+		flags |= SOIL_FLAG_POWER_OF_TWO;
+	}
+
+	Request *r = new Request();
+	r->texture = texture;
+	r->path = path;
+	r->flags = flags;
+	r->compress = (flags & SOIL_FLAG_COMPRESS_TO_DXT) && can_compress;
+	r->max_size = max_size;
+	r->ok = false;
+	r->from_cache = false;
+
+	pending.insert(texture);
+	decodes.run([this, r]() {
+		decode(r);
+
+		lock_guard<mutex> lock(finished_lock);
+		finished.push_back(r);
+	});
+
+	return texture;
+}
+
+// Without pool workers (a single core) nothing would run the decodes, so the GL thread takes one a frame.
+void TextureStreamer::update()
+{
+	PROFILE_ZONE("TextureStreamer::update");
+
+	if (!pending.empty() && jobs->get_thread_count() == 1) {
+		jobs->run_one();
+	}
+
+	size_t uploaded = 0;
+	while (uploaded < TEXTURE_UPLOAD_BUDGET) {
+		Request *r = NULL;
+		{
+			lock_guard<mutex> lock(finished_lock);
+			if (finished.empty()) {
+				break;
+			}
+			r = finished.front();
+			finished.pop_front();
+		}
+
+		if (r->ok) {
+			upload(r);
+			for (vector<TextureLevel>::size_type i = 0; i < r->image.levels.size(); ++i) {
+				uploaded += r->image.levels[i].data.size();
+			}
+			cout << r->path << (r->from_cache ? " streamed from the texture cache" : " streamed") << endl;
+		}
+		else {
+			cout << "error - could not stream " << r->path << endl;
+		}
+
+		pending.erase(r->texture);
+		delete r;
+	}
+}
+
+bool TextureStreamer::is_ready(GLuint texture) const
+{
+	return pending.find(texture) == pending.end();
+}
+
+int TextureStreamer::get_pending_count() const
+{
+	return (int)pending.size();
+}
+
+// The same steps, in the same order, as SOIL_load_OGL_texture, so the result matches a synchronous load.
+void TextureStreamer::decode(Request *r) const
+{
+	PROFILE_ZONE("TextureStreamer::decode");
+
+	vector<unsigned char> source;
+	if (!TextureCache::read_file(r->path, source)) {
+		return;
+	}
+
+	string cache_path;
+	if (r->compress) {
+		cache_path = cache.get_cache_path(source, r->flags);
+		TextureImage cached;
+		if (cache.read(cache_path, cached)) {
+			r->image = cached;
+			r->ok = r->from_cache = true;
+			return;
+		}
+	}
+
+	int width, height, channels;
+	unsigned char *img = stbi_load_from_memory(&source[0], (int)source.size(), &width, &height, &channels, 0);
+	if (!img) {
+		cout << "error - " << r->path << ": " << stbi_failure_reason() << endl;
+		return;
+	}
+
+	if (r->flags & SOIL_FLAG_INVERT_Y) {
+		for (int j = 0; j * 2 < height; ++j) {
+			unsigned char *top = img + j * width * channels;
+			unsigned char *bottom = img + (height - 1 - j) * width * channels;
+			for (int i = 0; i < width * channels; ++i) {
+				unsigned char temp = top[i];
+				top[i] = bottom[i];
+				bottom[i] = temp;
+			}
+		}
+	}
+
+	if (r->flags & SOIL_FLAG_NTSC_SAFE_RGB) {
+		scale_image_RGB_to_NTSC_safe(img, width, height, channels);
+	}
+
+	if ((r->flags & SOIL_FLAG_MULTIPLY_ALPHA) && (channels == 2 || channels == 4)) {
+		for (int i = 0; i < width * height * channels; i += channels) {
+			for (int c = 0; c < channels - 1; ++c) {
+				img[i + c] = (img[i + c] * img[i + channels - 1] + 128) >> 8;
+			}
+		}
+	}
+
+	if ((r->flags & (SOIL_FLAG_POWER_OF_TWO | SOIL_FLAG_MIPMAPS)) || width > r->max_size || height > r->max_size) {
+		int new_width = 1, new_height = 1;
+		while (new_width < width) {
+			new_width *= 2;
+		}
+		while (new_height < height) {
+			new_height *= 2;
+		}
+
+		if (new_width != width || new_height != height) {
+			unsigned char *resampled = (unsigned char *)malloc(channels * new_width * new_height);
+			up_scale_image(img, width, height, channels, resampled, new_width, new_height);
+			stbi_image_free(img);
+			img = resampled;
+			width = new_width;
+			height = new_height;
+		}
+	}
+
+	if (width > r->max_size || height > r->max_size) {
+		int block_x = width > r->max_size ? width / r->max_size : 1;
+		int block_y = height > r->max_size ? height / r->max_size : 1;
+		unsigned char *resampled = (unsigned char *)malloc(channels * (width / block_x) * (height / block_y));
+		mipmap_image(img, width, height, channels, resampled, block_x, block_y);
+		free(img);
+		img = resampled;
+		width /= block_x;
+		height /= block_y;
+	}
+
+	static const GLenum formats[5] = { 0, GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
+	r->image.pixel_format = formats[channels];
+	if (r->compress) {
+		r->image.internal_format = (channels & 1) ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	else {
+		r->image.internal_format = formats[channels];
+	}
+
+	// Level L averages 2^L x 2^L blocks of the full image, like SOIL, rather than halving the level above.
+	int level_width = width, level_height = height;
+	unsigned char *resampled = NULL;
+	for (int level = 0; level == 0 || ((r->flags & SOIL_FLAG_MIPMAPS) && ((1 << level) <= width || (1 << level) <= height)); ++level) {
+		const unsigned char *pixels = img;
+		if (level > 0) {
+			if (!resampled) {
+				resampled = (unsigned char *)malloc(channels * ((width + 1) / 2) * ((height + 1) / 2));
+			}
+			mipmap_image(img, width, height, channels, resampled, 1 << level, 1 << level);
+			pixels = resampled;
+		}
+
+		TextureLevel data;
+		data.width = level_width;
+		data.height = level_height;
+		if (r->compress) {
+			int size = 0;
+			unsigned char *blocks = (channels & 1) ?
+				convert_image_to_DXT1(pixels, level_width, level_height, channels, &size) :
+				convert_image_to_DXT5(pixels, level_width, level_height, channels, &size);
+			data.data.assign(blocks, blocks + size);
+			free(blocks);
+		}
+		else {
+			data.data.assign(pixels, pixels + channels * level_width * level_height);
+		}
+		r->image.levels.push_back(data);
+
+		level_width = (level_width + 1) / 2;
+		level_height = (level_height + 1) / 2;
+	}
+	free(resampled);
+	free(img);
+
+	if (r->compress) {
+		cache.write(cache_path, r->image);
+	}
+	r->ok = true;
+}
+
+// Every level goes through its own pixel buffer, so GL can copy from it after this returns.
+void TextureStreamer::upload(Request *r)
+{
+	PROFILE_GPU_ZONE("TextureStreamer::upload");
+
+	glBindTexture(GL_TEXTURE_2D, r->texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (vector<TextureLevel>::size_type i = 0; i < r->image.levels.size(); ++i) {
+		upload_level(r->image, (int)i);
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	// Filtering and wrapping as SOIL sets them.
+	bool mipmaps = r->image.levels.size() > 1;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)r->image.levels.size() - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	GLint wrap = (r->flags & SOIL_FLAG_TEXTURE_REPEATS) ? GL_REPEAT : GL_CLAMP;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TextureStreamer::upload_level(const TextureImage &image, int level)
+{
+	const TextureLevel &data = image.levels[level];
+	GLsizeiptr size = (GLsizeiptr)data.data.size();
+
+	int slot = next_pbo;
+	next_pbo = (next_pbo + 1) % TEXTURE_UPLOAD_RING_SIZE;
+
+	// Respecifying the store orphans whatever GL still reads from it instead of waiting for it.
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[slot]);
+	if (size > pbo_sizes[slot]) {
+		pbo_sizes[slot] = size;
+	}
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo_sizes[slot], NULL, GL_STREAM_DRAW);
+
+	void *mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+	const GLvoid *pixels = NULL; // An offset into the bound buffer.
+	if (mapped) {
+		memcpy(mapped, &data.data[0], size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+	else {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		pixels = &data.data[0];
+	}
+
+	if (image.is_compressed()) {
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, image.internal_format, data.width, data.height, 0, (GLsizei)size, pixels);
+	}
+	else {
+		glTexImage2D(GL_TEXTURE_2D, level, image.internal_format, data.width, data.height, 0, image.pixel_format, GL_UNSIGNED_BYTE, pixels);
+	}
+}
\ No newline at end of file
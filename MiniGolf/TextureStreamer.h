@@ -0,0 +1,80 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <mutex>
+#include <GL/glew.h>
+
+#include "TextureCache.h"
+#include "JobSystem.h"
+
+using namespace std;
+
+static const int TEXTURE_UPLOAD_RING_SIZE = 4; // Pixel buffers cycled through, so a new upload never waits on one still being read.
+static const size_t TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024; // Bytes handed to GL per update; the first texture always goes.
+
+// Loads textures without stalling the GL thread. request() hands back a texture name at once, holding a
+// transparent placeholder; workers read, decode (stbi + image_helper, as SOIL would) and compress the image,
+// and update() uploads whatever has finished through a ring of pixel buffer objects.
+// Understands SOIL_FLAG_POWER_OF_TWO, MIPMAPS, TEXTURE_REPEATS, MULTIPLY_ALPHA, INVERT_Y,
+// COMPRESS_TO_DXT and NTSC_SAFE_RGB. Compressed results share the on-disk TextureCache.
+// Each decode already has a worker to itself; main() caps stbi and DXT at one thread for the game.
+class TextureStreamer
+{
+public:
+	TextureStreamer(); // Needs a current GL context.
+
+	~TextureStreamer(); // Waits for outstanding decodes.
+
+	GLuint request(string path, unsigned int flags);
+
+	void update(); // Call once per frame on the GL thread.
+
+	bool is_ready(GLuint texture) const; // False while the placeholder is showing.
+
+	int get_pending_count() const;
+
+private:
+	struct Request {
+		GLuint texture;
+		string path;
+		unsigned int flags;
+		bool compress; // DXT was asked for and the driver has it.
+		int max_size;
+		bool ok;
+		bool from_cache;
+		TextureImage image;
+	};
+
+	TextureCache cache;
+	JobSystem *jobs;
+	TaskGroup decodes;
+
+	mutex finished_lock;
+	deque<Request*> finished;
+
+	set<GLuint> pending; // GL thread only.
+
+	GLuint pbos[TEXTURE_UPLOAD_RING_SIZE];
+	GLsizeiptr pbo_sizes[TEXTURE_UPLOAD_RING_SIZE];
+	int next_pbo;
+
+	bool can_compress;
+	GLint max_size;
+
+	TextureStreamer(const TextureStreamer &);
+
+	TextureStreamer &operator=(const TextureStreamer &);
+
+	void decode(Request *request) const; // Worker side.
+
+	void upload(Request *request);
+
+	void upload_level(const TextureImage &image, int level);
+};
+
+#endif
\ No newline at end of file
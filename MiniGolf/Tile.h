@@ -3,9 +3,9 @@
 
 #include <iostream>
 #include <vector>
-#include <gl\glew.h>
-#include <gl\freeglut.h>
-#include <glm\glm.hpp>
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <glm/glm.hpp>
 
 #include "Object3D.h"
 #include "Material.h"
@@ -21,17 +21,15 @@ class Tile : public Plane
 public:
 	Tile();
 
-	Tile(int id, int edge_count, vector<vec3> verticies, vector<int> neighbors);
+	Tile(int id, int edge_count, vector<vec3> verticies, vector<int> neighbors, Arena *arena);
 
-	~Tile();
-
-	virtual void draw(Camera *camera, Light *light);
+	virtual bool culls_back_faces() const; // The surface only; the level culls and draws the borders on their own.
 
 	float get_friction();
 
-	vector<Border*> get_borders();
+	const vector<Border*> &get_borders() const;
 
-	vector<int> get_neighbors();
+	const vector<int> &get_neighbors() const;
 
 	void print();
 
@@ -40,12 +38,8 @@ private:
 
 	int edge_count;
 
-	vector<vec3> vertices;
-
 	vector<int> neighbors;
 
-	void init_gl();
-
 	float friction;
 
 	void init_borders();
@@ -1,11 +1,15 @@
 #include <cstdlib>
 #include "Timer.h"
 
+#ifndef _WIN32
+#include <time.h>
+#endif
+
 Timer::Timer()
 {
-	QueryPerformanceFrequency(&frequency);
-	startCount.QuadPart = 0;
-	endCount.QuadPart = 0;
+	frequency = read_frequency();
+	startCount = 0;
+	endCount = 0;
 
 	stopped = 0;
 	start_time_in_micro_sec = 0;
@@ -15,23 +19,23 @@ Timer::Timer()
 void Timer::start()
 {
 	stopped = 0; // reset stop flag
-	QueryPerformanceCounter(&startCount);
+	startCount = read_counter();
 }
 
 void Timer::stop()
 {
 	stopped = 1; // set timer stopped flag
-	QueryPerformanceCounter(&endCount);
+	endCount = read_counter();
 }
 
 double Timer::get_elapsed_time_in_micro_sec()
 {
 	if (!stopped) {
-		QueryPerformanceCounter(&endCount);
+		endCount = read_counter();
 	}
 
-	start_time_in_micro_sec = startCount.QuadPart * (1000000.0 / frequency.QuadPart);
-	end_time_in_micro_sec = endCount.QuadPart * (1000000.0 / frequency.QuadPart);
+	start_time_in_micro_sec = startCount * (1000000.0 / frequency);
+	end_time_in_micro_sec = endCount * (1000000.0 / frequency);
 
 	return end_time_in_micro_sec - start_time_in_micro_sec;
 }
@@ -60,4 +64,29 @@ string Timer::get_time_stamp()
 	timeinfo = localtime(&rawtime);
 
 	return asctime(timeinfo);
+}
+
+// The performance counter on Windows; the monotonic clock, in nanoseconds, everywhere else.
+long long Timer::read_counter()
+{
+#ifdef _WIN32
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	return count.QuadPart;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000000000LL + t.tv_nsec;
+#endif
+}
+
+long long Timer::read_frequency()
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return frequency.QuadPart;
+#else
+	return 1000000000LL;
+#endif
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 
 #include <ctime>
 #include <iostream>
+#include <string>
+
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 using namespace std;
 
@@ -33,11 +37,15 @@ private:
 
 	int stopped;
 
-	LARGE_INTEGER frequency;
+	long long frequency; // Counts per second.
+
+	long long startCount;
+
+	long long endCount;
 
-	LARGE_INTEGER startCount;
+	static long long read_counter();
 
-	LARGE_INTEGER endCount;
+	static long long read_frequency();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "TrajectoryPredictor.h"
+#include "Game.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "GLState.h"
+
+TrajectoryPredictor::TrajectoryPredictor() : arena(4096)
+{
+	ball = arena.create<Ball>(0, vec3(0.0f), &arena);
+
+	stopping = false;
+	busy = false;
+	level = NULL;
+	generation = 0;
+	simulated = 0;
+	holed = false;
+	last_time_ms = 0.0;
+	uploaded = 0;
+	visible = false;
+
+	vbo = 0;
+	if (!Object3D::is_headless()) {
+		glGenBuffers(1, &vbo);
+	}
+
+	worker = thread(&TrajectoryPredictor::run, this);
+}
+
+TrajectoryPredictor::~TrajectoryPredictor()
+{
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+
+	if (vbo) {
+		glDeleteBuffers(1, &vbo);
+	}
+	arena.release();
+}
+
+void TrajectoryPredictor::predict(Level *level, vec3 start, vec3 force)
+{
+	visible = true;
+
+	lock_guard<mutex> guard(lock);
+	if (level == this->level && start == this->start && force == this->force) {
+		return;
+	}
+
+	this->level = level;
+	this->start = start;
+	this->force = force;
+	generation++;
+	wake.notify_one();
+}
+
+void TrajectoryPredictor::clear()
+{
+	visible = false;
+}
+
+void TrajectoryPredictor::wait_idle()
+{
+	unique_lock<mutex> guard(lock);
+	level = NULL; // Forces a fresh simulation on the next predict().
+	generation++;
+	idle.wait(guard, [this]() { return !busy; });
+}
+
+double TrajectoryPredictor::get_last_time_ms() const
+{
+	lock_guard<mutex> guard(lock);
+	return last_time_ms;
+}
+
+// Worker thread. The same steps Game::update takes, without touching the hole's own ball.
+void TrajectoryPredictor::run()
+{
+	vector<vec3> points;
+	Timer timer;
+
+	unique_lock<mutex> guard(lock);
+	while (true) {
+		wake.wait(guard, [this]() { return stopping || (level && simulated != generation); });
+		if (stopping) {
+			return;
+		}
+
+		Level *hole = level;
+		vec3 from = start, f = force;
+		unsigned int work = generation;
+		busy = true;
+		guard.unlock();
+
+		PROFILE_ZONE("TrajectoryPredictor::run");
+		timer.start();
+
+		ball->reset(from);
+		ball->add_force(f);
+		points.clear();
+		points.push_back(from);
+
+		bool in_cup = false;
+		for (unsigned int step = 1; step <= PREDICTION_MAX_STEPS; ++step) {
+			hole->step_ball(ball, PHYSICS_TIME_STEP);
+
+			in_cup = hole->ball_in_cup(ball);
+			if (in_cup || !ball->is_active()) {
+				points.push_back(ball->get_position());
+				break;
+			}
+			if (step % PREDICTION_POINT_STRIDE == 0) {
+				points.push_back(ball->get_position());
+			}
+		}
+
+		double ms = timer.get_elapsed_time_in_milli_sec();
+
+		guard.lock();
+		busy = false;
+		idle.notify_all();
+
+		if (work == generation) { // Otherwise the inputs moved on and this path is already stale.
+			path.swap(points);
+			holed = in_cup;
+			simulated = work;
+			last_time_ms = ms;
+		}
+	}
+}
+
+void TrajectoryPredictor::draw(Camera *camera)
+{
+	if (!visible || !vbo) {
+		return;
+	}
+
+	PROFILE_GPU_ZONE("TrajectoryPredictor::draw");
+
+	bool in_cup;
+	{
+		lock_guard<mutex> guard(lock);
+		if (simulated != uploaded) {
+			drawn = path;
+			uploaded = simulated;
+
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			if (!drawn.empty()) {
+				glBufferData(GL_ARRAY_BUFFER, drawn.size() * sizeof(vec3), &drawn[0], GL_DYNAMIC_DRAW);
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		in_cup = holed;
+	}
+	if (drawn.size() < 2) {
+		return;
+	}
+
+	GLState::use_program(0);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadMatrixf(&camera->get_projection()[0][0]);
+
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadMatrixf(&camera->get_view()[0][0]);
+	glTranslatef(0.0f, 0.05f, 0.0f); // Ride at the ball's centre, as the ball's model transform places it.
+
+	if (in_cup) {
+		glColor4f(0.2f, 1.0f, 0.2f, 1.0f);
+	}
+	else {
+		glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(vec3), ((GLubyte *)NULL + (0)));
+
+	glDrawArrays(GL_LINE_STRIP, 0, drawn.size());
+	FrameStats::count_draw_call();
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+}
\ No newline at end of file
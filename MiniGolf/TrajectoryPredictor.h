@@ -0,0 +1,77 @@
+#ifndef TRAJECTORY_PREDICTOR_H
+#define TRAJECTORY_PREDICTOR_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "Level.h"
+#include "Camera.h"
+#include "Arena.h"
+
+using namespace std;
+using namespace glm;
+
+static const unsigned int PREDICTION_MAX_STEPS = 60 * 20; // Twenty seconds of rolling at the physics rate.
+static const unsigned int PREDICTION_POINT_STRIDE = 2; // Steps between points of the drawn path.
+
+// Simulates the shot the player is lining up on a worker thread, with its own ball on the
+// current hole, and draws the resulting path. A new simulation starts only when the hole, the
+// ball's position or the force change; the frame just draws whichever path finished last.
+class TrajectoryPredictor
+{
+public:
+	TrajectoryPredictor();
+
+	~TrajectoryPredictor();
+
+	void predict(Level *level, vec3 start, vec3 force); // Cheap when nothing changed.
+
+	void clear(); // Hide the path, e.g. while the ball is rolling.
+
+	void wait_idle(); // Block until no simulation is reading a level; call before levels are rebuilt.
+
+	void draw(Camera *camera);
+
+	double get_last_time_ms() const; // Wall time of the last simulation.
+
+private:
+	Arena arena;
+	Ball *ball; // Never drawn; only stepped on the worker thread.
+
+	thread worker;
+	mutable mutex lock;
+	condition_variable wake;
+	condition_variable idle;
+	bool stopping;
+	bool busy;
+
+	// Inputs, guarded by lock. generation counts changes, so the worker can tell stale work.
+	Level *level;
+	vec3 start;
+	vec3 force;
+	unsigned int generation;
+	unsigned int simulated; // Generation the current path belongs to.
+
+	vector<vec3> path; // Guarded by lock.
+	bool holed;
+	double last_time_ms;
+
+	// Render thread only.
+	vector<vec3> drawn;
+	unsigned int uploaded;
+	GLuint vbo;
+	bool visible;
+
+	TrajectoryPredictor(const TrajectoryPredictor &);
+
+	TrajectoryPredictor &operator=(const TrajectoryPredictor &);
+
+	void run();
+};
+
+#endif
\ No newline at end of file
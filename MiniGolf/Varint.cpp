@@ -0,0 +1,67 @@
+#include "Varint.h"
+
+int encode_varint(unsigned int value, unsigned char *out)
+{
+	int n = 0;
+	while (value >= 0x80) {
+		out[n++] = (unsigned char)((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out[n++] = (unsigned char)value;
+	return n;
+}
+
+bool decode_varint(const unsigned char *in, size_t size, size_t &used, unsigned int &value)
+{
+	value = 0;
+	for (size_t i = 0; i < size && i < VARINT_MAX_BYTES; ++i) {
+		value |= (unsigned int)(in[i] & 0x7f) << (7 * i);
+		if (!(in[i] & 0x80)) {
+			used = i + 1;
+			return true;
+		}
+	}
+	return false;
+}
+
+void write_varint(ostream &out, unsigned int value)
+{
+	unsigned char bytes[VARINT_MAX_BYTES];
+	out.write((const char *)bytes, encode_varint(value, bytes));
+}
+
+void write_varint(string &out, unsigned int value)
+{
+	unsigned char bytes[VARINT_MAX_BYTES];
+	out.append((const char *)bytes, encode_varint(value, bytes));
+}
+
+// A stream can't be looked ahead in, so gather the bytes up to the last one first.
+bool read_varint(istream &in, unsigned int &value)
+{
+	unsigned char bytes[VARINT_MAX_BYTES];
+	size_t count = 0;
+	do {
+		int c = in.get();
+		if (c == EOF) {
+			return false;
+		}
+		bytes[count++] = (unsigned char)c;
+	} while ((bytes[count - 1] & 0x80) && count < VARINT_MAX_BYTES);
+
+	size_t used;
+	return decode_varint(bytes, count, used, value);
+}
+
+bool read_varint(const string &in, size_t &offset, unsigned int &value)
+{
+	if (offset > in.size()) {
+		return false;
+	}
+	size_t used;
+	if (!decode_varint((const unsigned char *)in.data() + offset, in.size() - offset, used, value)) {
+		return false;
+	}
+	offset += used;
+	return true;
+}
\ No newline at end of file
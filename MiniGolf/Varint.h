@@ -0,0 +1,27 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static const int VARINT_MAX_BYTES = 5; // Enough for any 32-bit value.
+
+// Unsigned LEB128: seven bits per byte, low bits first, the top bit set on every byte but the last.
+// Shared by the replay log and the network snapshots, so both agree on the format.
+
+int encode_varint(unsigned int value, unsigned char *out); // Bytes written to out, at most VARINT_MAX_BYTES.
+
+// False if the bytes run out first or the value would need more than VARINT_MAX_BYTES; used is then undefined.
+bool decode_varint(const unsigned char *in, size_t size, size_t &used, unsigned int &value);
+
+void write_varint(ostream &out, unsigned int value);
+
+void write_varint(string &out, unsigned int value);
+
+bool read_varint(istream &in, unsigned int &value);
+
+bool read_varint(const string &in, size_t &offset, unsigned int &value); // Advances offset past the value.
+
+#endif
\ No newline at end of file
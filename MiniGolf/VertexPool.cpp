@@ -0,0 +1,239 @@
+#include "VertexPool.h"
+#include "GLState.h"
+
+#include <cstddef>
+#include <cstring>
+
+VertexPool *VertexPool::shared = NULL;
+
+VertexAllocation::VertexAllocation()
+{
+	first_vertex = vertex_count = 0;
+	first_index = index_count = 0;
+}
+
+const GLvoid *VertexAllocation::get_index_offset() const
+{
+	return (GLubyte *)NULL + first_index * sizeof(GLuint);
+}
+
+VertexPool::VertexPool(int vertex_capacity, int index_capacity)
+{
+	this->vertex_capacity = vertex_capacity;
+	this->index_capacity = index_capacity;
+	vertices_used = indices_used = 0;
+
+	Range all = { 0, vertex_capacity };
+	free_vertices.push_back(all);
+	all.count = index_capacity;
+	free_indices.push_back(all);
+
+	glGenBuffers(1, &vertex_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, vertex_capacity * sizeof(Vertex), NULL, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &index_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, index_buffer);
+	glBufferData(GL_ARRAY_BUFFER, index_capacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenVertexArrays(1, &vao);
+	bind_buffers();
+}
+
+VertexPool::~VertexPool()
+{
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &vertex_buffer);
+	glDeleteBuffers(1, &index_buffer);
+}
+
+VertexPool *VertexPool::get_shared()
+{
+	if (!shared) {
+		shared = new VertexPool();
+	}
+	return shared;
+}
+
+vector<Vertex> VertexPool::interleave(const float *positions, const float *normals, const float *uvs, int count)
+{
+	vector<Vertex> vertices(count);
+	for (int i = 0; i < count; ++i) {
+		memcpy(vertices[i].position, positions + i * 3, 3 * sizeof(float));
+		memcpy(vertices[i].normal, normals + i * 3, 3 * sizeof(float));
+		memcpy(vertices[i].uv, uvs + i * 2, 2 * sizeof(float));
+	}
+	return vertices;
+}
+
+GLuint VertexPool::get_vao() const
+{
+	return vao;
+}
+
+void VertexPool::bind_buffers()
+{
+	GLState::bind_vertex_array(vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), ((GLubyte *)NULL + offsetof(Vertex, position)));
+	glEnableVertexAttribArray(0);  // Vertex position
+	glVertexAttribPointer((GLuint)1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), ((GLubyte *)NULL + offsetof(Vertex, normal)));
+	glEnableVertexAttribArray(1);  // Vertex normal
+	glVertexAttribPointer((GLuint)2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), ((GLubyte *)NULL + offsetof(Vertex, uv)));
+	glEnableVertexAttribArray(2);  // Texture coords
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+	GLState::bind_vertex_array(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+VertexAllocation VertexPool::allocate(const vector<Vertex> &vertices, const vector<GLuint> &indices)
+{
+	VertexAllocation allocation;
+	if (vertices.empty()) {
+		return allocation;
+	}
+
+	int first_vertex = take(free_vertices, (int)vertices.size());
+	while (first_vertex < 0) {
+		give(free_vertices, vertex_capacity, vertex_capacity);
+		vertex_buffer = grow(vertex_buffer, vertex_capacity * sizeof(Vertex), 2 * vertex_capacity * sizeof(Vertex));
+		vertex_capacity *= 2;
+		bind_buffers();
+		first_vertex = take(free_vertices, (int)vertices.size());
+	}
+
+	int first_index = 0;
+	if (!indices.empty()) {
+		first_index = take(free_indices, (int)indices.size());
+		while (first_index < 0) {
+			give(free_indices, index_capacity, index_capacity);
+			index_buffer = grow(index_buffer, index_capacity * sizeof(GLuint), 2 * index_capacity * sizeof(GLuint));
+			index_capacity *= 2;
+			bind_buffers();
+			first_index = take(free_indices, (int)indices.size());
+		}
+	}
+
+	allocation.first_vertex = first_vertex;
+	allocation.vertex_count = (int)vertices.size();
+	allocation.first_index = first_index;
+	allocation.index_count = (int)indices.size();
+
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, first_vertex * sizeof(Vertex), vertices.size() * sizeof(Vertex), &vertices[0]);
+
+	if (!indices.empty()) {
+		vector<GLuint> offset(indices.size());
+		for (vector<GLuint>::size_type i = 0; i < indices.size(); ++i) {
+			offset[i] = indices[i] + first_vertex;
+		}
+
+		// Through GL_ARRAY_BUFFER, so the element binding of whatever VAO is bound stays put.
+		glBindBuffer(GL_ARRAY_BUFFER, index_buffer);
+		glBufferSubData(GL_ARRAY_BUFFER, first_index * sizeof(GLuint), offset.size() * sizeof(GLuint), &offset[0]);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vertices_used += allocation.vertex_count;
+	indices_used += allocation.index_count;
+	return allocation;
+}
+
+void VertexPool::release(VertexAllocation &allocation)
+{
+	if (allocation.vertex_count > 0) {
+		give(free_vertices, allocation.first_vertex, allocation.vertex_count);
+		vertices_used -= allocation.vertex_count;
+	}
+	if (allocation.index_count > 0) {
+		give(free_indices, allocation.first_index, allocation.index_count);
+		indices_used -= allocation.index_count;
+	}
+	allocation = VertexAllocation();
+}
+
+void VertexPool::write_uvs(const VertexAllocation &allocation, const float *uvs)
+{
+	if (allocation.vertex_count == 0) {
+		return;
+	}
+
+	// Only the tex coords are written; GL keeps the rest of the mapped range as it was.
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+	Vertex *mapped = (Vertex *)glMapBufferRange(GL_ARRAY_BUFFER, allocation.first_vertex * sizeof(Vertex),
+		allocation.vertex_count * sizeof(Vertex), GL_MAP_WRITE_BIT);
+	if (mapped) {
+		for (int i = 0; i < allocation.vertex_count; ++i) {
+			mapped[i].uv[0] = uvs[i * 2];
+			mapped[i].uv[1] = uvs[i * 2 + 1];
+		}
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+int VertexPool::get_vertices_used() const
+{
+	return vertices_used;
+}
+
+int VertexPool::get_indices_used() const
+{
+	return indices_used;
+}
+
+int VertexPool::take(vector<Range> &free, int count)
+{
+	for (vector<Range>::size_type i = 0; i < free.size(); ++i) {
+		if (free[i].count >= count) {
+			int first = free[i].first;
+			free[i].first += count;
+			free[i].count -= count;
+			if (free[i].count == 0) {
+				free.erase(free.begin() + i);
+			}
+			return first;
+		}
+	}
+	return -1;
+}
+
+void VertexPool::give(vector<Range> &free, int first, int count)
+{
+	vector<Range>::size_type i = 0;
+	while (i < free.size() && free[i].first < first) {
+		++i;
+	}
+
+	Range range = { first, count };
+	free.insert(free.begin() + i, range);
+
+	if (i + 1 < free.size() && free[i].first + free[i].count == free[i + 1].first) {
+		free[i].count += free[i + 1].count;
+		free.erase(free.begin() + i + 1);
+	}
+	if (i > 0 && free[i - 1].first + free[i - 1].count == free[i].first) {
+		free[i - 1].count += free[i].count;
+		free.erase(free.begin() + i);
+	}
+}
+
+GLuint VertexPool::grow(GLuint buffer, int old_bytes, int new_bytes)
+{
+	GLuint larger;
+	glGenBuffers(1, &larger);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, larger);
+	glBufferData(GL_COPY_WRITE_BUFFER, new_bytes, NULL, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_bytes);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+	return larger;
+}
\ No newline at end of file
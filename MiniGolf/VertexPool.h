@@ -0,0 +1,83 @@
+#ifndef VERTEX_POOL_H
+#define VERTEX_POOL_H
+
+#include <iostream>
+#include <vector>
+#include <GL/glew.h>
+
+using namespace std;
+
+static const int VERTEX_POOL_VERTICES = 64 * 1024; // Starting capacities; a pool doubles when it runs out.
+static const int VERTEX_POOL_INDICES = 256 * 1024;
+
+// The one vertex layout every course object uploads: attribute 0 position, 1 normal, 2 tex coords.
+struct Vertex {
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+// Where an object's geometry sits in a VertexPool. Its indices are stored already offset to first_vertex.
+struct VertexAllocation {
+	int first_vertex, vertex_count;
+	int first_index, index_count; // 0 for geometry drawn with glDrawArrays.
+
+	VertexAllocation();
+
+	const GLvoid *get_index_offset() const; // For glDrawElements with the pool's VAO bound.
+};
+
+// One interleaved vertex buffer and one index buffer shared by many objects, behind a single VAO.
+// Objects take first-fit runs out of each and give them back when destroyed, so rebuilding a hole
+// reuses the space of the old one. Growing moves the data into larger buffers but keeps every
+// offset and the VAO, so nothing handed out goes stale. GL thread only.
+class VertexPool
+{
+public:
+	VertexPool(int vertex_capacity = VERTEX_POOL_VERTICES, int index_capacity = VERTEX_POOL_INDICES);
+
+	~VertexPool();
+
+	static VertexPool *get_shared(); // Created on first use and kept for the life of the GL context.
+
+	static vector<Vertex> interleave(const float *positions, const float *normals, const float *uvs, int count); // From separate xyz, xyz and st arrays.
+
+	GLuint get_vao() const;
+
+	VertexAllocation allocate(const vector<Vertex> &vertices, const vector<GLuint> &indices);
+
+	void release(VertexAllocation &allocation); // Leaves it empty. Releasing an empty one does nothing.
+
+	void write_uvs(const VertexAllocation &allocation, const float *uvs); // Replaces the tex coords, one (s, t) per vertex.
+
+	int get_vertices_used() const;
+
+	int get_indices_used() const;
+
+private:
+	struct Range {
+		int first, count;
+	};
+
+	GLuint vao;
+	GLuint vertex_buffer, index_buffer;
+	int vertex_capacity, index_capacity;
+	int vertices_used, indices_used;
+	vector<Range> free_vertices, free_indices; // Sorted by first, neighbours merged.
+
+	static VertexPool *shared;
+
+	VertexPool(const VertexPool &);
+
+	VertexPool &operator=(const VertexPool &);
+
+	static int take(vector<Range> &free, int count); // -1 when no run is long enough.
+
+	static void give(vector<Range> &free, int first, int count);
+
+	static GLuint grow(GLuint buffer, int old_bytes, int new_bytes); // Copies into a new buffer and deletes the old one.
+
+	void bind_buffers();
+};
+
+#endif
\ No newline at end of file
@@ -12,18 +12,21 @@ struct LightInfo {
 uniform LightInfo Light;
 
 struct MaterialInfo {
-    vec3 Ka;
-    vec3 Kd;
-    vec3 Ks;
-    float Shininess;
+    vec4 Ka;
+    vec4 Kd;
+    vec4 Ks; // w is the shininess.
 };
-uniform MaterialInfo Material;
+layout (std140) uniform MaterialBlock {
+    MaterialInfo Materials[256]; // MAX_MATERIALS
+};
+uniform int MaterialIndex;
 
 uniform mat4 ModelViewMatrix;
 uniform mat3 NormalMatrix;
 uniform mat4 MVP;
 
 void main() {
+	MaterialInfo Material = Materials[MaterialIndex];
 	vec3 tnorm = normalize(NormalMatrix * VertexNormal);
     vec4 eyeCoords = ModelViewMatrix * vec4(VertexPosition, 1.0);
     
@@ -32,12 +35,12 @@ void main() {
     vec3 r = reflect( -s, tnorm );
 
 	float sDotN = max( dot(s,tnorm), 0.0 );
-    vec3 ambient = Light.La * Material.Ka;
-    vec3 diffuse = Light.Ld * Material.Kd * sDotN;
+    vec3 ambient = Light.La * Material.Ka.xyz;
+    vec3 diffuse = Light.Ld * Material.Kd.xyz * sDotN;
 
 	vec3 spec = vec3(0.0);
     if( sDotN > 0.0 )
-        spec = Light.Ls * Material.Ks * pow( max( dot(r,v), 0.0 ), Material.Shininess );
+        spec = Light.Ls * Material.Ks.xyz * pow( max( dot(r,v), 0.0 ), Material.Ks.w );
     
 	LightIntensity = ambient + diffuse + spec;
     gl_Position = MVP * vec4(VertexPosition,1.0);